@@ -0,0 +1,507 @@
+// ===========================================================
+// aquarium_bench: CPU microbenchmarks (no GL context needed)
+// ===========================================================
+//
+//   aquarium_bench [--filter text] [--min-time seconds] [--json file] [--models dir]
+//
+// Prints a table to stderr and Google-Benchmark-style JSON to stdout (or to
+// --json), so runs can be diffed across commits.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "capture.h"
+#include "food.h"
+#include "ibl_reference.h"
+#include "jobs.h"
+#include "meshes.h"
+#include "obstacle_field.h"
+#include "particles.h"
+#include "poisson_disk.h"
+#include "school.h"
+#include "stalks.h"
+
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+    std::string name, label;
+    uint64_t iterations = 0;
+    double meanNs = 0.0, minNs = 0.0;
+    double items = 0.0, bytes = 0.0;   // per iteration, 0 = not reported
+};
+
+static std::vector<Result> results;
+static std::string filter;
+static double minTime = 0.5;
+
+// Runs fn until minTime has passed (at least once), in batches of roughly a
+// tenth of that; min is the fastest batch average.
+static Result* bench(const std::string& name, const std::function<void()>& fn, double items = 0.0, double bytes = 0.0) {
+    if (!filter.empty() && name.find(filter) == std::string::npos) return nullptr;
+    auto t0 = Clock::now();
+    fn();   // warm-up, also sizes the batches
+    double once = std::chrono::duration<double>(Clock::now() - t0).count();
+    uint64_t batch = std::max<uint64_t>(1, (uint64_t)(minTime * 0.1 / std::max(once, 1e-9)));
+    Result r; r.name = name; r.items = items; r.bytes = bytes;
+    double total = 0.0, best = 1e300;
+    do {
+        auto b0 = Clock::now();
+        for (uint64_t i = 0; i < batch; ++i) fn();
+        double s = std::chrono::duration<double>(Clock::now() - b0).count();
+        total += s; r.iterations += batch;
+        best = std::min(best, s / batch);
+    } while (total < minTime);
+    r.meanNs = total / r.iterations * 1e9;
+    r.minNs = best * 1e9;
+    std::cerr << std::left << std::setw(40) << name << std::right << std::fixed << std::setprecision(3)
+              << std::setw(14) << r.meanNs * 1e-6 << " ms" << std::setw(14) << r.minNs * 1e-6 << " ms min"
+              << std::setw(10) << r.iterations << " it";
+    if (items > 0.0) std::cerr << std::setprecision(2) << std::setw(12) << items / (r.meanNs * 1e-9) * 1e-6 << " M items/s";
+    std::cerr << std::endl;
+    results.push_back(r);
+    return &results.back();
+}
+
+static std::string jsonEscape(const std::string& s) {
+    std::string o;
+    for (char c : s) {
+        if (c == '"' || c == '\\') o += '\\';
+        o += c;
+    }
+    return o;
+}
+
+static void writeJSON(std::ostream& os) {
+    std::time_t now = std::time(nullptr);
+    char date[64]; std::strftime(date, sizeof date, "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+    os << "{\n  \"context\": {\n"
+       << "    \"date\": \"" << date << "\",\n"
+       << "    \"num_threads\": " << jobs::threadCount() << ",\n"
+#ifdef NDEBUG
+       << "    \"library_build_type\": \"release\",\n"
+#else
+       << "    \"library_build_type\": \"debug\",\n"
+#endif
+       << "    \"min_time_s\": " << minTime << "\n  },\n  \"benchmarks\": [\n";
+    os << std::setprecision(6);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        double sec = r.meanNs * 1e-9;
+        os << "    {\"name\": \"" << jsonEscape(r.name) << "\", \"iterations\": " << r.iterations
+           << ", \"real_time\": " << r.meanNs << ", \"min_time\": " << r.minNs << ", \"time_unit\": \"ns\"";
+        if (r.items > 0.0) os << ", \"items_per_second\": " << r.items / sec;
+        if (r.bytes > 0.0) os << ", \"bytes_per_second\": " << r.bytes / sec;
+        if (!r.label.empty()) os << ", \"label\": \"" << jsonEscape(r.label) << "\"";
+        os << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    os << "  ]\n}\n";
+}
+
+// ---------- fish ----------
+static const glm::vec3 kTankExtents(2.4f, 1.3f, 1.4f);
+
+static std::vector<FishInst> makeSchool(size_t n, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> u(-1.0f, 1.0f), u01(0.0f, 1.0f);
+    std::vector<FishInst> v(n);
+    for (auto& f : v) {
+        f.pos = glm::vec3(u(rng)*kTankExtents.x*0.7f, -0.8f + u01(rng)*1.2f, u(rng)*kTankExtents.z*0.7f);
+        f.vel = glm::vec3(u(rng), u(rng)*0.2f, u(rng)) * 0.3f;
+        f.phase = u01(rng)*6.28318f; f.scale = 1.0f;
+        f.stretch = glm::vec3(1.0f); f.color = glm::vec3(0.5f); f.species = 0.0f;
+    }
+    return v;
+}
+
+static void benchSchools() {
+    // The neighbour loop is O(n^2); big schools update a sample of fish (still
+    // against every other fish) and report the projected full step.
+    const double kPairBudget = 1 << 24;
+    for (size_t n : {100u, 1000u, 10000u, 100000u, 1000000u}) {
+        std::string name = "school/update/" + std::to_string(n);
+        if (!filter.empty() && name.find(filter) == std::string::npos) continue;
+        auto fish = makeSchool(n, 1);
+        size_t sample = std::min(n, std::max<size_t>(1, (size_t)(kPairBudget / n)));
+        SchoolParams p; p.extents = kTankExtents;
+        std::mt19937 rng(2);
+        Result* r = bench(name, [&]{ updateSchool(fish, p, 1.0f/60.0f, rng, 0, sample); }, (double)sample);
+        if (r && sample < n) {
+            std::ostringstream l;
+            l << "sampled " << sample << " of " << n << " fish; full step ~" << std::fixed << std::setprecision(1)
+              << r->meanNs * 1e-6 * n / sample << " ms";
+            r->label = l.str();
+        }
+    }
+}
+
+// Topological model: the k nearest through the grid, so cost per fish is flat.
+// 1M fish update a sample (the grid is still built over all of them).
+static void benchSchoolsKnn() {
+    const size_t kSampleMax = 1 << 17;
+    for (size_t n : {1000u, 10000u, 100000u, 1000000u}) {
+        std::string name = "school/knn7/" + std::to_string(n);
+        if (!filter.empty() && name.find(filter) == std::string::npos) continue;
+        auto fish = makeSchool(n, 1);
+        size_t sample = std::min(n, kSampleMax);
+        SchoolParams p; p.extents = kTankExtents; p.neighbors = 7;
+        std::mt19937 rng(2);
+        Result* r = bench(name, [&]{ updateSchool(fish, p, 1.0f/60.0f, rng, 0, sample); }, (double)sample);
+        if (r && sample < n) {
+            std::ostringstream l;
+            l << "sampled " << sample << " of " << n << " fish; full step ~" << std::fixed << std::setprecision(1)
+              << r->meanNs * 1e-6 * n / sample << " ms";
+            r->label = l.str();
+        }
+    }
+}
+
+// Metric model with Verlet lists: whole steps (the lists cover the school),
+// so compare per-fish time with school/update. The label gives how often the
+// lists had to be rebuilt.
+static void benchSchoolsVerlet() {
+    for (size_t n : {1000u, 10000u}) {
+        std::string name = "school/verlet/" + std::to_string(n);
+        if (!filter.empty() && name.find(filter) == std::string::npos) continue;
+        auto fish = makeSchool(n, 1);
+        SchoolNeighborCache cache;
+        SchoolParams p; p.extents = kTankExtents; p.cache = &cache;
+        std::mt19937 rng(2);
+        Result* r = bench(name, [&]{ updateSchool(fish, p, 1.0f/60.0f, rng); }, (double)n);
+        if (r && cache.rebuilds) {
+            std::ostringstream l;
+            l << "rebuilt every " << std::fixed << std::setprecision(1) << (double)cache.steps / cache.rebuilds
+              << " steps; " << cache.items.size() / n << " listed per fish";
+            r->label = l.str();
+        }
+    }
+}
+
+// Obstacle avoidance: baking the field, and per-fish lookups in it against
+// testing every shape (the default scene has ~50 solid decorations).
+static void benchObstacles() {
+    std::mt19937 rng(4);
+    std::uniform_real_distribution<float> u(-1.0f, 1.0f), u01(0.0f, 1.0f);
+    std::vector<ObstacleShape> shapes(49);
+    for (size_t i = 0; i < shapes.size(); ++i) {
+        ObstacleShape& s = shapes[i];
+        s.kind = (ObstacleShape::Kind)(i % 3);
+        s.a = glm::vec3(u(rng) * 1.7f, -1.3f, u(rng) * 1.0f);
+        s.b = i % 3 == 1 ? s.a + glm::vec3(0.0f, 0.3f, 0.0f) : glm::vec3(0.1f, 0.08f, 0.07f);
+        s.radius = 0.03f + 0.1f * u01(rng) * (i % 3 != 2);
+        s.yaw = u01(rng) * 6.28f;
+    }
+    auto walls = [](glm::vec3 p) {
+        return std::min(std::min(kTankExtents.x - std::abs(p.x), kTankExtents.z - std::abs(p.z)), p.y + kTankExtents.y);
+    };
+    const glm::vec3 lo = -kTankExtents, hi(kTankExtents.x, 0.6f, kTankExtents.z);
+    ObstacleField field;
+    for (float cell : {0.06f, 0.03f}) {
+        std::ostringstream name;
+        name << "obstacles/bake/" << cell;
+        if (!filter.empty() && name.str().find(filter) == std::string::npos) continue;
+        Result* r = bench(name.str(), [&]{ field.bake(lo, hi, cell, walls, shapes); });
+        if (r) {
+            glm::ivec3 d = field.dims();
+            r->label = std::to_string(d.x) + "x" + std::to_string(d.y) + "x" + std::to_string(d.z) + ", "
+                     + std::to_string(field.memoryBytes() / 1024) + " KB";
+        }
+    }
+
+    const size_t n = 100000;
+    std::vector<glm::vec3> pts(n);
+    for (auto& q : pts) q = glm::vec3(u(rng) * kTankExtents.x, -1.3f + u01(rng) * 1.9f, u(rng) * kTankExtents.z);
+    std::vector<float> out(n);
+    if (filter.empty() || std::string("obstacles/field").find(filter) != std::string::npos) {
+        field.bake(lo, hi, 0.06f, walls, shapes);
+        bench("obstacles/field", [&]{
+            for (size_t i = 0; i < n; ++i) { glm::vec3 g; out[i] = field.sample(pts[i], &g) + g.x; }
+        }, (double)n);
+    }
+    if (filter.empty() || std::string("obstacles/per-shape").find(filter) != std::string::npos) {
+        bench("obstacles/per-shape", [&]{
+            for (size_t i = 0; i < n; ++i) {
+                float d = walls(pts[i]);
+                for (const auto& s : shapes) d = std::min(d, obstacleDistance(s, pts[i]));
+                out[i] = d;
+            }
+        }, (double)n);
+    }
+}
+
+// Feeding: every fish looking for its nearest pellet. Grid queries against a
+// scan of all pellets (sampled, projected), then whole school steps with the
+// pellets sinking and being eaten (topped up so the count stays near 50k).
+static void benchFeeding() {
+    const size_t nFish = 10000;
+    const int nFood = 50000;
+    auto fish = makeSchool(nFish, 1);
+    FoodSystem food;
+    food.init(nFood, -kTankExtents.y, 0.6f, 5);
+    auto refill = [&]{
+        while (food.count() < nFood) food.drop(nFood - food.count(), 1.0f, glm::vec2(kTankExtents.x, kTankExtents.z) * 0.7f);
+    };
+    refill();
+    for (int i = 0; i < 120; ++i) food.update(1.0f / 60.0f);   // spread them down the water column
+    refill();
+    std::vector<int> hit(nFish);
+    const float sense = 0.9f;
+    if (Result* r = bench("feeding/query/10000x50000", [&]{
+            jobs::parallelFor(nFish, 256, [&](size_t b, size_t e) {
+                for (size_t i = b; i < e; ++i) hit[i] = food.nearest(fish[i].pos, sense);
+            });
+        }, (double)nFish)) {
+        size_t found = std::count_if(hit.begin(), hit.end(), [](int k){ return k >= 0; });
+        r->label = std::to_string(found) + " fish with a pellet in range";
+    }
+    const size_t sample = 500;
+    if (Result* r = bench("feeding/brute/10000x50000", [&]{
+            jobs::parallelFor(sample, 16, [&](size_t b, size_t e) {
+                for (size_t i = b; i < e; ++i) {
+                    float best = sense * sense; int k = -1;
+                    for (int j = 0; j < food.count(); ++j) {
+                        glm::vec3 d = glm::vec3(food.px[j], food.py[j], food.pz[j]) - fish[i].pos;
+                        float d2 = glm::dot(d, d);
+                        if (d2 < best) { best = d2; k = j; }
+                    }
+                    hit[i] = k;
+                }
+            });
+        }, (double)sample)) {
+        std::ostringstream l;
+        l << "sampled " << sample << " of " << nFish << " fish; full scan ~" << std::fixed << std::setprecision(1)
+          << r->meanNs * 1e-6 * nFish / sample << " ms";
+        r->label = l.str();
+    }
+    SchoolNeighborCache cache;
+    SchoolParams p; p.extents = kTankExtents; p.cache = &cache; p.food = &food;
+    std::mt19937 rng(2);
+    uint64_t eaten0 = food.eatenTotal();
+    int steps = 0;
+    if (Result* r = bench("feeding/step/10000x50000", [&]{
+            food.update(1.0f / 60.0f);
+            refill();
+            updateSchool(fish, p, 1.0f / 60.0f, rng);
+            ++steps;
+        }, (double)nFish)) {
+        std::ostringstream l;
+        l << std::fixed << std::setprecision(1) << (double)(food.eatenTotal() - eaten0) / std::max(steps, 1)
+          << " pellets eaten per step; frame " << r->meanNs * 1e-6 << " ms of 16.7";
+        r->label = l.str();
+    }
+}
+
+// Plant and kelp stalks: whole steps of a bed of stalks over the tank floor
+// with 10k fish pushing through it, then the same bed under a budget of a
+// quarter of the stalks per step.
+static void benchStalks() {
+    std::mt19937 rng(6);
+    std::uniform_real_distribution<float> u(-1.0f, 1.0f), u01(0.0f, 1.0f);
+    auto fish = makeSchool(10000, 1);
+    std::vector<glm::vec4> colliders;
+    for (const FishInst& f : fish) colliders.emplace_back(f.pos, 0.06f * f.scale);
+    for (int n : {1000, 10000}) {
+        for (int budget : {-1, n / 4}) {
+            std::string name = "plants/stalks/" + std::to_string(n) + (budget < 0 ? "" : "/budget" + std::to_string(budget));
+            if (!filter.empty() && name.find(filter) == std::string::npos) continue;
+            std::vector<StalkSpec> specs(n);
+            for (StalkSpec& s : specs) {
+                s.base = glm::vec3(u(rng) * kTankExtents.x, -kTankExtents.y, u(rng) * kTankExtents.z);
+                s.height = 0.35f + 0.65f * u01(rng); s.phase = u01(rng) * 6.28f;
+                s.stiffness = 3.0f; s.buoyancy = 1.0f;
+            }
+            StalkSystem stalks;
+            stalks.init(specs);
+            bench(name, [&]{ stalks.step(1.0f / 60.0f, colliders, budget); }, (double)(budget < 0 ? n : budget));
+        }
+    }
+}
+
+// Decoration placement: one Poisson-disk scatter of n mixed-size pieces over
+// a floor grown with n, so the packing density stays that of a full tank.
+static void benchDecorScatter() {
+    for (int n : {1000, 10000, 50000}) {
+        std::string name = "decor/poisson/" + std::to_string(n);
+        if (!filter.empty() && name.find(filter) == std::string::npos) continue;
+        const glm::vec2 half(std::sqrt((float)n / 400.0f));
+        ScatterSpec spec;
+        spec.regions = { { -half, half } };
+        spec.count = n;
+        spec.sizeMin = 0.05f; spec.sizeMax = 0.3f;
+        spec.footprint = 0.12f;
+        std::vector<glm::vec3> out;
+        int placed = 0;
+        if (Result* r = bench(name, [&]{
+            std::mt19937 rng(7);
+            PoissonDisk sampler(-half, half, spec.footprint * spec.sizeMax);
+            out.clear();
+            placed = sampler.scatter(spec, rng, out);
+        }, (double)n)) {
+            r->label = std::to_string(placed) + " placed";
+        }
+    }
+}
+
+static void benchFishPacking() {
+    for (size_t n : {1000u, 100000u, 1000000u}) {
+        std::string name = "fish/pack/" + std::to_string(n);
+        if (!filter.empty() && name.find(filter) == std::string::npos) continue;
+        auto fish = makeSchool(n, 3);
+        std::vector<float> out(n * FISH_INSTANCE_FLOATS);
+        bench(name, [&]{ packFishInstances(fish, out.data()); }, (double)n, (double)out.size() * sizeof(float));
+    }
+}
+
+// ---------- bubbles ----------
+static void benchBubbles() {
+    for (int cap : {16384, 262144, 1048576}) {
+        std::string up = "bubbles/update/" + std::to_string(cap), pk = "bubbles/pack/" + std::to_string(cap);
+        if (!filter.empty() && up.find(filter) == std::string::npos && pk.find(filter) == std::string::npos) continue;
+        BubbleSystem b;
+        b.init(cap, -1.3f, 0.6f, 7u);
+        b.budgetMs = 0.0f;
+        // Emission sized so the pool runs nearly full once the first bubbles surface
+        const BubbleEmitter def;
+        float rise = 1.9f / (0.5f * (def.riseMin + def.riseMax));
+        for (float x : {-1.3f, 1.2f}) {
+            BubbleEmitter e; e.pos = glm::vec3(x, -1.3f, -0.6f); e.rate = 0.45f * cap / rise;
+            b.addEmitter(e);
+        }
+        for (int i = 0; i < (int)(rise * 60.0f) + 60; ++i) b.update(1.0f/60.0f);
+        bench(up, [&]{ b.update(1.0f/60.0f); }, (double)b.alive());
+        std::vector<float> out((size_t)cap * 4);
+        bench(pk, [&]{ b.pack(out.data()); }, (double)b.used(), (double)b.used() * 4 * sizeof(float));
+    }
+}
+
+// ---------- capture ----------
+// Encoder-thread cost of a captured frame; it must stay under the frame time
+// (16.7 ms at 60 fps) or the capture drops frames.
+static void benchCapture() {
+    for (int h : {720, 1080, 2160}) {
+        std::string name = "capture/yuv420/" + std::to_string(h) + "p";
+        if (!filter.empty() && name.find(filter) == std::string::npos) continue;
+        int w = h * 16 / 9;
+        std::vector<uint8_t> rgba((size_t)w * h * 4);
+        std::mt19937 rng(5);
+        for (auto& c : rgba) c = (uint8_t)rng();
+        std::vector<uint8_t> yuv((size_t)w * h * 3 / 2);
+        bench(name, [&]{ rgbaToYUV420(rgba.data(), w, h, yuv.data(), yuv.data() + (size_t)w*h, yuv.data() + (size_t)w*h*5/4); },
+              (double)w * h, (double)rgba.size());
+    }
+}
+
+// ---------- meshes ----------
+static void benchMeshes(const std::string& modelsDir) {
+    std::vector<std::filesystem::path> objs;
+    std::error_code ec;
+    for (const auto& e : std::filesystem::directory_iterator(modelsDir, ec))
+        if (e.path().extension() == ".obj") objs.push_back(e.path());
+    if (ec) std::cerr << "No models in " << modelsDir << ": " << ec.message() << std::endl;
+    std::sort(objs.begin(), objs.end());
+    for (const auto& path : objs) {
+        // The loader logs every load; keep the table readable
+        std::streambuf* out = std::cout.rdbuf(nullptr);
+        size_t verts = loadOBJModel(path.string()).v.size();
+        Result* r = bench("obj/" + path.filename().string(), [&]{ loadOBJModel(path.string()); },
+                          0.0, (double)std::filesystem::file_size(path, ec));
+        std::cout.rdbuf(out); std::cout.clear();
+        if (r) r->label = std::to_string(verts) + " vertices";
+    }
+
+    struct Gen { const char* name; std::function<MeshData()> fn; };
+    const Gen gens[] = {
+        {"createFishMesh",    []{ return createFishMesh(); }},
+        {"makeBox",           []{ return makeBox(1.0f, 1.0f, 1.0f); }},
+        {"makeGlassTank",     []{ return makeGlassTank(5.0f, 2.8f, 3.0f, 0.08f); }},
+        {"makeWaterVolume",   []{ return makeWaterVolume(5.0f, 2.8f, 3.0f, 0.85f); }},
+        {"makeTankBase",      []{ return makeTankBase(5.0f, 2.8f, 3.0f); }},
+        {"makeFloor",         []{ return makeFloor(4.5f, 2.7f, -1.3f); }},
+        {"makePlantStrip",    []{ return makePlantStrip(); }},
+        {"makeRockDome",      []{ return makeRockDome(); }},
+        {"makeCoral",         []{ return makeCoral(); }},
+        {"makeShell",         []{ return makeShell(); }},
+        {"makeDriftwood",     []{ return makeDriftwood(); }},
+        {"makeAnemone",       []{ return makeAnemone(); }},
+        {"makeStarfish",      []{ return makeStarfish(); }},
+        {"makeKelp",          []{ return makeKelp(); }},
+        {"makeTreasureChest", []{ return makeTreasureChest(); }},
+    };
+    for (const auto& g : gens) {
+        size_t verts = g.fn().v.size();
+        Result* r = bench(std::string("mesh/") + g.name, [&]{ g.fn(); }, (double)verts);
+        if (r) r->label = std::to_string(verts) + " vertices";
+    }
+}
+
+// ---------- IBL ----------
+// Same sizes and sample counts as the startup passes in main.cpp
+static void benchIBL() {
+    std::vector<float> face;
+    bench("ibl/irradiance/32", [&]{
+        face.resize(32*32*3);
+        for (int f = 0; f < 6; ++f) iblref::irradianceFace(f, 32, 128, face.data());
+    }, 6.0*32*32);
+    const int prefilterSize = 128, maxMip = 7;
+    bench("ibl/prefilter/128", [&]{
+        for (int mip = 0; mip <= maxMip; ++mip) {
+            int s = prefilterSize >> mip;
+            face.resize((size_t)s*s*3);
+            for (int f = 0; f < 6; ++f) iblref::prefilterFace(f, s, (float)mip / maxMip, 256, face.data());
+        }
+    }, 6.0*(128*128 + 64*64 + 32*32 + 16*16 + 8*8 + 4*4 + 2*2 + 1));
+    std::vector<float> lut(256*256*2);
+    bench("ibl/brdf_lut/256", [&]{ iblref::brdfLUT(256, 512, lut.data()); }, 256.0*256);
+}
+
+#ifndef AQUARIUM_MODELS_DIR
+#define AQUARIUM_MODELS_DIR "models"
+#endif
+
+int main(int argc, char** argv) {
+    std::string jsonPath, modelsDir = AQUARIUM_MODELS_DIR;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if      (a == "--filter"   && hasValue) filter = argv[++i];
+        else if (a == "--min-time" && hasValue) minTime = std::max(0.0, std::atof(argv[++i]));
+        else if (a == "--json"     && hasValue) jsonPath = argv[++i];
+        else if (a == "--models"   && hasValue) modelsDir = argv[++i];
+        else {
+            std::cerr << "Unknown or incomplete option: " << a << "\n"
+                      << "Usage: aquarium_bench [--filter text] [--min-time seconds] [--json file] [--models dir]\n";
+            return 1;
+        }
+    }
+    std::cerr << "aquarium_bench: " << jobs::threadCount() << " threads, min time " << minTime << " s" << std::endl;
+
+    benchSchools();
+    benchSchoolsKnn();
+    benchSchoolsVerlet();
+    benchObstacles();
+    benchFeeding();
+    benchStalks();
+    benchDecorScatter();
+    benchFishPacking();
+    benchBubbles();
+    benchCapture();
+    benchMeshes(modelsDir);
+    benchIBL();
+
+    if (jsonPath.empty()) { writeJSON(std::cout); return 0; }
+    std::ofstream f(jsonPath);
+    if (!f) { std::cerr << "Cannot write " << jsonPath << std::endl; return 1; }
+    writeJSON(f);
+    std::cerr << "Wrote " << jsonPath << std::endl;
+    return 0;
+}
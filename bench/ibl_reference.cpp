@@ -0,0 +1,134 @@
+#include "ibl_reference.h"
+#include "jobs.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace iblref {
+
+static const float kPi = 3.14159265f;
+
+static float smooth(float e0, float e1, float x) {
+    float t = std::clamp((x - e0) / (e1 - e0), 0.0f, 1.0f);
+    return t * t * (3.0f - 2.0f * t);
+}
+
+glm::vec3 envColor(const glm::vec3& d) {
+    float up = std::clamp(d.y*0.5f + 0.5f, 0.0f, 1.0f);
+    glm::vec3 top(0.35f,0.75f,1.0f), middle(0.10f,0.25f,0.45f), bottom(0.02f,0.05f,0.08f);
+    glm::vec3 sky = glm::mix(bottom, glm::mix(middle, top, smooth(0.2f,0.9f,up)), smooth(0.0f,1.0f,up));
+    glm::vec3 sunDir = glm::normalize(glm::vec3(-0.2f, 0.9f, 0.1f));
+    float sun = std::pow(std::max(glm::dot(d, sunDir), 0.0f), 900.0f) * 8.0f;
+    return sky + glm::vec3(sun);
+}
+
+glm::vec3 dirFromFaceUV(int face, float u, float v) {
+    switch (face) {
+        case 0:  return glm::normalize(glm::vec3( 1.0f, v, -u));
+        case 1:  return glm::normalize(glm::vec3(-1.0f, v,  u));
+        case 2:  return glm::normalize(glm::vec3( u,  1.0f, -v));
+        case 3:  return glm::normalize(glm::vec3( u, -1.0f,  v));
+        case 4:  return glm::normalize(glm::vec3( u,  v,  1.0f));
+        default: return glm::normalize(glm::vec3(-u,  v, -1.0f));
+    }
+}
+
+glm::vec2 hammersley(uint32_t i, uint32_t n) {
+    uint32_t bits = i;
+    bits = (bits << 16u) | (bits >> 16u);
+    bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+    bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+    bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+    bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+    return glm::vec2((float)i / (float)n, (float)bits * 2.3283064365386963e-10f);
+}
+
+static glm::vec3 toWorld(const glm::vec3& h, const glm::vec3& n) {
+    glm::vec3 up = std::fabs(n.y) < 0.999f ? glm::vec3(0,1,0) : glm::vec3(1,0,0);
+    glm::vec3 t = glm::normalize(glm::cross(up, n));
+    glm::vec3 b = glm::cross(n, t);
+    return glm::normalize(t*h.x + b*h.y + n*h.z);
+}
+
+static glm::vec3 sampleHemisphere(const glm::vec3& n, glm::vec2 xi) {
+    float phi = 2.0f*kPi*xi.x;
+    float cosT = std::sqrt(1.0f - xi.y), sinT = std::sqrt(1.0f - cosT*cosT);
+    return toWorld(glm::vec3(std::cos(phi)*sinT, std::sin(phi)*sinT, cosT), n);
+}
+
+static glm::vec3 importanceSampleGGX(glm::vec2 xi, float rough, const glm::vec3& n) {
+    float a = rough*rough;
+    float phi = 2.0f*kPi*xi.x;
+    float cosT = std::sqrt((1.0f - xi.y) / (1.0f + (a*a - 1.0f) * xi.y));
+    float sinT = std::sqrt(1.0f - cosT*cosT);
+    return toWorld(glm::vec3(std::cos(phi)*sinT, std::sin(phi)*sinT, cosT), n);
+}
+
+// Texel centres, as gl_FragCoord gives them
+template<typename Fn>
+static void forEachTexel(int size, Fn fn) {
+    jobs::parallelFor((size_t)size, 1, [&](size_t y0, size_t y1) {
+        for (size_t y = y0; y < y1; ++y)
+            for (int x = 0; x < size; ++x)
+                fn(x, (int)y, ((float)x + 0.5f) / size, ((float)y + 0.5f) / size);
+    });
+}
+
+void irradianceFace(int face, int size, uint32_t samples, float* out) {
+    forEachTexel(size, [&](int x, int y, float u, float v) {
+        glm::vec3 n = dirFromFaceUV(face, u*2.0f - 1.0f, v*2.0f - 1.0f);
+        glm::vec3 col(0.0f);
+        for (uint32_t i = 0; i < samples; ++i) {
+            glm::vec3 l = sampleHemisphere(n, hammersley(i, samples));
+            col += envColor(l) * std::max(glm::dot(n, l), 0.0f);
+        }
+        col = col * (1.0f / (float)samples) * (1.0f / kPi);
+        float* o = out + ((size_t)y*size + x)*3;
+        o[0] = col.x; o[1] = col.y; o[2] = col.z;
+    });
+}
+
+void prefilterFace(int face, int size, float roughness, uint32_t samples, float* out) {
+    forEachTexel(size, [&](int x, int y, float u, float v) {
+        glm::vec3 n = dirFromFaceUV(face, u*2.0f - 1.0f, v*2.0f - 1.0f), view = n;
+        glm::vec3 sum(0.0f); float weight = 0.0f;
+        for (uint32_t i = 0; i < samples; ++i) {
+            glm::vec3 h = importanceSampleGGX(hammersley(i, samples), roughness, n);
+            glm::vec3 l = glm::normalize(h * (2.0f * glm::dot(view, h)) - view);
+            float ndl = std::max(glm::dot(n, l), 0.0f);
+            if (ndl > 0.0f) { sum += envColor(l) * ndl; weight += ndl; }
+        }
+        sum = sum / std::max(weight, 1e-4f);
+        float* o = out + ((size_t)y*size + x)*3;
+        o[0] = sum.x; o[1] = sum.y; o[2] = sum.z;
+    });
+}
+
+static float gSchlickGGX(float ndv, float rough) {
+    float r = rough + 1.0f, k = (r*r) / 8.0f;
+    return ndv / (ndv*(1.0f - k) + k);
+}
+
+void brdfLUT(int size, uint32_t samples, float* out) {
+    forEachTexel(size, [&](int x, int y, float ndv, float rough) {
+        rough = std::max(rough, 0.04f);
+        glm::vec3 view(std::sqrt(1.0f - ndv*ndv), 0.0f, ndv), n(0.0f, 0.0f, 1.0f);
+        float a = 0.0f, b = 0.0f;
+        for (uint32_t i = 0; i < samples; ++i) {
+            glm::vec3 h = importanceSampleGGX(hammersley(i, samples), rough, n);
+            glm::vec3 l = glm::normalize(h * (2.0f * glm::dot(view, h)) - view);
+            float ndl = std::max(l.z, 0.0f), ndh = std::max(h.z, 0.0f), vdh = std::max(glm::dot(view, h), 0.0f);
+            if (ndl > 0.0f) {
+                float g = gSchlickGGX(ndl, rough) * gSchlickGGX(ndv, rough);
+                float gVis = (g * vdh) / std::max(ndh * ndv, 1e-5f);
+                float fc = std::pow(1.0f - vdh, 5.0f);
+                a += (1.0f - fc) * gVis;
+                b += fc * gVis;
+            }
+        }
+        float* o = out + ((size_t)y*size + x)*2;
+        o[0] = a / (float)samples; o[1] = b / (float)samples;
+    });
+}
+
+} // namespace iblref
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+// ===========================================================
+// CPU reference of the IBL precomputation shaders
+// ===========================================================
+//
+// Same math as ibl_cubegen/ibl_diffuse/ibl_specular/ibl_brdf_lut.frag, except
+// the environment is evaluated analytically instead of sampled from a cube map.
+namespace iblref {
+
+glm::vec3 envColor(const glm::vec3& d);
+glm::vec3 dirFromFaceUV(int face, float u, float v);   // u,v in [-1,1]
+glm::vec2 hammersley(uint32_t i, uint32_t n);
+
+// RGB floats, size*size texels of one cube face
+void irradianceFace(int face, int size, uint32_t samples, float* out);
+void prefilterFace(int face, int size, float roughness, uint32_t samples, float* out);
+// RG floats, size*size texels (x = N.V, y = roughness)
+void brdfLUT(int size, uint32_t samples, float* out);
+
+} // namespace iblref
@@ -1,15 +1,22 @@
 #version 410 core
 in vec3 vWorldPos;
+in vec3 vTankPos;     // for the water surface and caustics, shared by every tank
 in vec3 vNormal;
+in vec3 vBaseColor;
 
 uniform vec3 uLightDir;
 uniform vec3 uViewPos;
-uniform vec3 uBaseColor;
 uniform vec3 uFogColor;
 uniform float uFogNear, uFogFar;
 uniform float uTime;
 
 uniform int   uApplyCaustics;
+uniform sampler2D uWaterTex;   // height, dh/dx, dh/dz, dh/dt
+uniform vec4  uWaterRect;      // xy = min corner (x,z), zw = 1/size
+uniform float uWaterY;
+uniform sampler2DArray uCaustics;   // baked ambient caustics, one layer per loop frame
+uniform float uCausticScale;        // tiles per world unit
+uniform vec3  uCausticLayers;       // layer a, layer b, blend
 uniform float uAlpha;
 uniform int   uMaterialType;  // 0=sand/glass, 1=rock
 
@@ -28,13 +35,25 @@ float sat(float x){ return clamp(x,0.0,1.0); }
 
 vec3 F_Schlick(float cosTheta, vec3 F0){ return F0 + (1.0 - F0) * pow(1.0 - cosTheta, 5.0); }
 float n3(vec3 p){ return fract(sin(dot(p, vec3(12.9898,78.233,37.719))) * 43758.5453); }
+// Ambient caustics come from the baked array. Ripples from the heightfield add
+// focus where its slope field converges: follow the refracted ray up to the
+// surface, then use the divergence of the slope (the Laplacian) scaled by depth.
 float caustic(vec3 p){
-    float t = uTime * 0.8;
-    float v = 0.0;
-    v += sin(dot(p.xz, vec2( 4.2, 3.6)) + t*1.8);
-    v += sin(dot(p.xz, vec2(-3.4, 2.7)) - t*1.2);
-    v = v*0.5 + 0.5;
-    return smoothstep(0.75, 0.95, v);
+    float depth = max(uWaterY - p.y, 0.0);
+    vec2 uv = (p.xz - uWaterRect.xy) * uWaterRect.zw;
+    vec2 shift = texture(uWaterTex, uv).yz * depth * 0.25;
+    uv -= shift * uWaterRect.zw;
+
+    vec2 tuv = (p.xz - shift) * uCausticScale;
+    float ambient = mix(texture(uCaustics, vec3(tuv, uCausticLayers.x)).r,
+                        texture(uCaustics, vec3(tuv, uCausticLayers.y)).r, uCausticLayers.z);
+
+    vec2 e = 1.0 / vec2(textureSize(uWaterTex, 0));
+    float dsx = texture(uWaterTex, uv + vec2(e.x, 0.0)).y - texture(uWaterTex, uv - vec2(e.x, 0.0)).y;
+    float dsz = texture(uWaterTex, uv + vec2(0.0, e.y)).z - texture(uWaterTex, uv - vec2(0.0, e.y)).z;
+    float lap = dsx * uWaterRect.z / (2.0*e.x) + dsz * uWaterRect.w / (2.0*e.y);
+    float ripple = smoothstep(0.1, 1.0, -lap * depth * 0.04);
+    return clamp(ambient * smoothstep(0.0, 0.3, depth) + ripple, 0.0, 1.0);
 }
 
 void main(){
@@ -47,7 +66,7 @@ void main(){
 
     float metallic  = 0.0;
     float roughness = 0.80;
-    vec3  base = uBaseColor;
+    vec3  base = vBaseColor;
 
     if (uMaterialType==1){ // Rock
         float speck = smoothstep(0.82, 1.0, n3(vWorldPos*18.0)) * 0.25;
@@ -68,7 +87,7 @@ void main(){
         base = mix(base*0.7, base*1.3, wood);
         roughness = 0.9;
     } else {
-        if (uApplyCaustics==1) base += 0.12 * caustic(vWorldPos);
+        if (uApplyCaustics==1) base += 0.12 * caustic(vTankPos);
     }
 
     vec3 F0 = mix(vec3(0.04), base, metallic);
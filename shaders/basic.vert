@@ -2,14 +2,25 @@
 layout(location=0) in vec3 aPos;
 layout(location=1) in vec3 aNormal;
 
-uniform mat4 uProj, uView, uModel;
+// instance data (every basic draw is instanced, see buildTankInstances)
+layout(location=3) in vec4 iPosScale;    // world position, uniform scale
+layout(location=4) in vec4 iRotColor;    // rotation about +y (radians), base color
+layout(location=5) in vec3 iTankOrigin;  // caustics are looked up tank-local
+
+uniform mat4 uProj, uView;
 
 out vec3 vWorldPos;
+out vec3 vTankPos;
 out vec3 vNormal;
+out vec3 vBaseColor;
 
 void main(){
-    vec4 w = uModel * vec4(aPos,1.0);
-    vWorldPos = w.xyz;
-    vNormal = normalize(mat3(uModel) * aNormal);
-    gl_Position = uProj * uView * w;
+    float c = cos(iRotColor.x), s = sin(iRotColor.x);
+    mat3 R = mat3(c, 0.0, -s,  0.0, 1.0, 0.0,  s, 0.0, c);
+    vec3 w = R * (aPos * iPosScale.w) + iPosScale.xyz;
+    vWorldPos = w;
+    vTankPos = w - iTankOrigin;
+    vNormal = normalize(R * aNormal);
+    vBaseColor = iRotColor.yzw;
+    gl_Position = uProj * uView * vec4(w, 1.0);
 }
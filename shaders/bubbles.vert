@@ -1,7 +1,62 @@
 #version 410 core
 layout(location=0) in vec3 aPos;
+layout(location=1) in float aSize;   // point size at ~1.5 units; 0 marks a free pool slot
 uniform mat4 uProj, uView;
+uniform float uPointScale;         // render resolution / window resolution
+
+// Stateless mode: no vertex buffer, each bubble is evaluated from gl_VertexID
+uniform int   uStateless;
+uniform float uTime;
+const int MAX_EMITTERS = 64;       // GPU_BUBBLE_EMITTERS, over all tanks
+uniform int   uEmitterCount;
+uniform vec4  uEmitters[MAX_EMITTERS];       // xyz base + spawn radius
+uniform vec4  uEmitterSpawn[MAX_EMITTERS];   // cumulative share of the total rate, size min/max, drift
+uniform vec4  uEmitterRise[MAX_EMITTERS];    // min/max rise speed, water level of its tank (world y)
+
+uint hashu(uint x){ x ^= x >> 16; x *= 0x7feb352du; x ^= x >> 15; x *= 0x846ca68bu; x ^= x >> 16; return x; }
+float h01(uint x){ return float(hashu(x) & 0x00ffffffu) / 16777216.0; }
+
+// Mirrors BubbleSystem: constant rise, sinusoidal wobble, Boyle's-law growth,
+// respawn at an emitter once the bubble reaches the surface (wrap by modulo).
+vec4 statelessBubble(int id){
+    uint s = uint(id) * 8u;
+
+    // Emitters get bubbles in proportion to their rate: binary search of the
+    // cumulative shares
+    float pick = h01(s + 2u);
+    int eIdx = 0, last = max(uEmitterCount, 1) - 1;
+    while (eIdx < last) {
+        int mid = (eIdx + last) / 2;
+        if (pick < uEmitterSpawn[mid].x) last = mid; else eIdx = mid + 1;
+    }
+    vec4 e = uEmitters[eIdx];
+    vec4 spawn = uEmitterSpawn[eIdx];
+    vec4 riseRange = uEmitterRise[eIdx];
+    float waterY = riseRange.z;
+    float rise = mix(riseRange.x, riseRange.y, h01(s));
+    float offset = h01(s + 1u);
+    float span = max(waterY - 0.02 - e.y, 0.01);
+    float period = span / rise;
+    float t = uTime + offset * period;
+    float cycle = floor(t / period);
+    float age = t - cycle * period;
+
+    uint c = hashu(s + 3u + uint(cycle) * 0x9e3779b9u);   // new spawn point per cycle
+    vec2 jitter = (vec2(h01(c), h01(c + 1u)) * 2.0 - 1.0) * e.w;
+    float a = h01(c + 2u) * 6.28318, ph = h01(c + 3u) * 6.28318;
+    vec2 drift = vec2(cos(a), sin(a)) * spawn.w * (0.6 + 0.4 * h01(c + 4u));
+    vec2 wob = drift / 2.2 * (cos(ph) - cos(2.2 * age + ph));
+
+    vec3 p = vec3(e.x + jitter.x + wob.x, e.y + rise * age, e.z + jitter.y + wob.y);
+    float pFloor = 1.0 + 0.5 * (waterY - e.y);
+    float size = mix(spawn.y, spawn.z, h01(c + 5u)) * pow(pFloor / (1.0 + 0.5 * (waterY - p.y)), 1.0/3.0);
+    return vec4(p, size);
+}
+
 void main(){
-    gl_Position = uProj * uView * vec4(aPos,1.0);
-    gl_PointSize = 3.5;
+    vec4 b = (uStateless == 1) ? statelessBubble(gl_VertexID) : vec4(aPos, aSize);
+    if (b.w <= 0.0) { gl_Position = vec4(2.0, 2.0, 2.0, 1.0); gl_PointSize = 1.0; return; }
+    vec4 v = uView * vec4(b.xyz,1.0);
+    gl_Position = uProj * v;
+    gl_PointSize = clamp(b.w * 1.5 * uPointScale / max(-v.z, 0.25), 1.0, 32.0);
 }
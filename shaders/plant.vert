@@ -2,34 +2,39 @@
 layout(location=0) in vec3 aPos;
 layout(location=1) in vec3 aNormal;
 
-// instance data
-layout(location=8)  in vec3 iPos;           // base position (at floor)
-layout(location=9)  in vec2 iHeightPhase;   // height, sway phase
+// instance data (the stalk itself comes from uNodes)
 layout(location=10) in vec3 iColor;         // base color
 
 uniform mat4 uProj, uView;
-uniform float uTime;
+uniform samplerBuffer uNodes;   // NODES chain nodes per stalk, world space, root first
+uniform int uStalkBase;         // stalk of instance 0 in this draw
+uniform float uMeshHeight;      // mesh y at the tip; y = 0 is the root
 
 out vec3 vWorldPos;
 out vec3 vNormal;
 out vec3 vColor;
 
-void main(){
-    float H = iHeightPhase.x;
-    float phase = iHeightPhase.y;
+const int NODES = 8;   // STALK_NODES
+
+// Rotates v by the shortest rotation taking +y to the unit vector t
+vec3 alignUp(vec3 v, vec3 t){
+    vec3 axis = vec3(t.z, 0.0, -t.x);   // cross(+y, t)
+    return v*t.y + cross(axis, v) + axis*(dot(axis, v) / (1.0 + t.y));
+}
 
-    // bend by height along XZ using sine
-    float t = clamp(aPos.y / max(H, 0.001), 0.0, 1.0);
-    float sway = sin(uTime*0.9 + phase + aPos.y*2.2) * (0.15 + 0.2*t);
-    vec3 p = aPos;
-    p.x += sway * (0.35 + 0.3*t);
+void main(){
+    // Position along the chain, then the mesh's cross-section turned to follow it
+    float f = clamp(aPos.y / uMeshHeight, 0.0, 1.0) * float(NODES - 1);
+    int k = min(int(f), NODES - 2);
+    int base = (uStalkBase + gl_InstanceID) * NODES;
+    vec3 a = texelFetch(uNodes, base + k).xyz;
+    vec3 b = texelFetch(uNodes, base + k + 1).xyz;
+    vec3 t = normalize(b - a + vec3(0.0, 1e-5, 0.0));
 
-    // scale to height and move to base position
-    p.y = p.y; // already in [0..H] in the mesh build
-    vec3 world = iPos + vec3(p.x, p.y, p.z);
+    vec3 world = mix(a, b, f - float(k)) + alignUp(vec3(aPos.x, 0.0, aPos.z), t);
 
     vWorldPos = world;
-    vNormal   = normalize(vec3(0.0, 0.0, 1.0)); // faux; strip is facing camera-ish
+    vNormal   = alignUp(aNormal, t);
     vColor    = iColor;
 
     gl_Position = uProj * uView * vec4(world,1.0);
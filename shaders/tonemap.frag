@@ -2,14 +2,28 @@
 in vec2 vUV; out vec4 FragColor;
 uniform sampler2D uHDR;
 uniform float uExposure;
+uniform vec2 uUVScale;   // rendered region of uHDR
+uniform vec2 uTexel;     // 1 / storage size of uHDR
+uniform float uSharpen;  // 0 at native resolution
 
 vec3 ACESFilm(vec3 x){
     const float a=2.51, b=0.03, c=2.43, d=0.59, e=0.14;
     return clamp((x*(a*x+b))/(x*(c*x+d)+e), 0.0, 1.0);
 }
 
+vec3 fetch(vec2 uv){ return texture(uHDR, clamp(uv, 0.5*uTexel, uUVScale - 0.5*uTexel)).rgb; }
+
 void main(){
-    vec3 hdr = texture(uHDR, vUV).rgb;
+    // Bilinear upscale from the rendered region, then an unsharp mask limited
+    // to the local min/max so edges don't ring
+    vec2 uv = vUV * uUVScale;
+    vec3 hdr = fetch(uv);
+    if (uSharpen > 0.0) {
+        vec3 n = fetch(uv + vec2(0.0, uTexel.y)), s = fetch(uv - vec2(0.0, uTexel.y));
+        vec3 e = fetch(uv + vec2(uTexel.x, 0.0)), w = fetch(uv - vec2(uTexel.x, 0.0));
+        vec3 lo = min(hdr, min(min(n, s), min(e, w))), hi = max(hdr, max(max(n, s), max(e, w)));
+        hdr = clamp(hdr + uSharpen * (hdr - 0.25*(n + s + e + w)), lo, hi);
+    }
     vec3 mapped = ACESFilm(hdr * uExposure);
     FragColor = vec4(mapped, 1.0);
 }
@@ -3,7 +3,8 @@ in vec3 vWorldPos;
 in vec3 vNormal;
 in vec2 vScreenUV;
 
-uniform sampler2D uSceneColor; // HDR opaque scene
+uniform sampler2D uSceneColor; // HDR opaque scene, downscaled
+uniform vec2 uSceneUVScale;    // written region of uSceneColor
 uniform vec3 uDeepColor;
 uniform vec3 uShallowColor;
 uniform vec3 uLightDir;
@@ -26,7 +27,7 @@ void main(){
     float distortAmt = 0.03;
     vec2 distort = N.xz * distortAmt;
 
-    vec3 refracted = texture(uSceneColor, vScreenUV + distort).rgb;
+    vec3 refracted = texture(uSceneColor, clamp(vScreenUV + distort, 0.0, 1.0) * uSceneUVScale).rgb;
 
     float depthTint = clamp((vWorldPos.y + 1.2) * 0.6, 0.0, 1.0);
     vec3 waterTint = mix(uDeepColor, uShallowColor, depthTint);
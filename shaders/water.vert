@@ -1,41 +1,45 @@
 #version 410 core
-layout(location=0) in vec3 aPos;
-layout(location=2) in vec2 aUV;
+layout(location=2) in vec2 aUV;   // grid position across the surface's screen rectangle
 
-uniform mat4 uProj, uView, uModel;
-uniform float uTime;
+uniform mat4 uProj, uView;
+uniform mat4 uInvViewProj;
+uniform vec4 uGridNDC;     // xy = min, zw = max
+
+// Heightfield from the CPU simulation: height, dh/dx, dh/dz, dh/dt
+uniform sampler2D uWaterTex;
+uniform vec4 uWaterRect;   // xy = min corner (x,z), zw = 1/size
+uniform float uWaterY;
 
 out vec3 vWorldPos;
 out vec3 vNormal;
 out vec2 vScreenUV;
 
-float waveFn(vec2 p, float t){
-    float w = 0.0;
-    w += 0.010 * sin(dot(p, vec2( 1.8,  1.1)) * 6.0 + t * 1.4);
-    w += 0.006 * sin(dot(p, vec2(-1.2,  2.3)) * 3.8 - t * 0.9);
-    return w;
-}
+void main(){
+    // Cast the grid point's view ray onto the rest plane
+    vec2 ndc = mix(uGridNDC.xy, uGridNDC.zw, aUV);
+    vec4 n = uInvViewProj * vec4(ndc, -1.0, 1.0); n /= n.w;
+    vec4 f = uInvViewProj * vec4(ndc,  1.0, 1.0); f /= f.w;
+    // The grid only spans where the surface is in view (see waterScreenBounds),
+    // so a miss is a ray grazing the horizon: send it to the far point, which
+    // is where the horizon is, rather than back to the camera
+    float dy = f.y - n.y;
+    float t = abs(dy) > 1e-6 ? (uWaterY - n.y) / dy : -1.0;
+    if (!(t >= 0.0)) t = 1.0;
+    vec3 p = mix(n.xyz, f.xyz, min(t, 1.0));
 
-vec3 surfaceNormal(vec3 pos, float t){
-    float eps = 0.02;
-    float h  = waveFn(pos.xz, t);
-    float hx = waveFn(pos.xz + vec2(eps,0.0), t);
-    float hz = waveFn(pos.xz + vec2(0.0,eps), t);
-    float dhdx = (hx - h)/eps;
-    float dhdz = (hz - h)/eps;
-    return normalize(vec3(-dhdx, 1.0, -dhdz));
-}
+    // Rays past the edge of the heightfield collapse onto it
+    vec2 lo = uWaterRect.xy, hi = uWaterRect.xy + 1.0 / uWaterRect.zw;
+    p.xz = clamp(p.xz, lo, hi);
+    p.y = uWaterY;
 
-void main(){
-    float t = uTime;
-    vec3 p = aPos;
-    p.y += waveFn(p.xy, t);
+    vec2 uv = (p.xz - lo) * uWaterRect.zw;
+    vec4 s = textureLod(uWaterTex, uv, 0.0);
+    p.y += s.x;
 
-    vec4 world = uModel * vec4(p, 1.0);
-    vWorldPos = world.xyz;
-    vNormal   = surfaceNormal(p, t);
+    vWorldPos = p;
+    vNormal   = normalize(vec3(-s.y, 1.0, -s.z));
 
-    vec4 clip = uProj * uView * world;
+    vec4 clip = uProj * uView * vec4(p, 1.0);
     vScreenUV = clip.xy/clip.w * 0.5 + 0.5;
     gl_Position = clip;
 }
@@ -0,0 +1,58 @@
+#include "alloc_stats.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<uint64_t> gCount{0}, gBytes{0};
+
+void* countedAlloc(size_t n) {
+    gCount.fetch_add(1, std::memory_order_relaxed);
+    gBytes.fetch_add(n, std::memory_order_relaxed);
+    return std::malloc(n ? n : 1);
+}
+
+void* countedAlignedAlloc(size_t n, size_t align) {
+    gCount.fetch_add(1, std::memory_order_relaxed);
+    gBytes.fetch_add(n, std::memory_order_relaxed);
+    void* p = nullptr;
+    if (align < sizeof(void*)) align = sizeof(void*);
+    return posix_memalign(&p, align, n ? n : 1) == 0 ? p : nullptr;
+}
+
+} // namespace
+
+namespace allocstats {
+uint64_t count() { return gCount.load(std::memory_order_relaxed); }
+uint64_t bytes() { return gBytes.load(std::memory_order_relaxed); }
+} // namespace allocstats
+
+void* operator new(size_t n) {
+    if (void* p = countedAlloc(n)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t n) {
+    if (void* p = countedAlloc(n)) return p;
+    throw std::bad_alloc();
+}
+void* operator new(size_t n, const std::nothrow_t&) noexcept { return countedAlloc(n); }
+void* operator new[](size_t n, const std::nothrow_t&) noexcept { return countedAlloc(n); }
+void* operator new(size_t n, std::align_val_t a) {
+    if (void* p = countedAlignedAlloc(n, (size_t)a)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t n, std::align_val_t a) {
+    if (void* p = countedAlignedAlloc(n, (size_t)a)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { std::free(p); }
@@ -0,0 +1,17 @@
+#pragma once
+#include <cstdint>
+
+// ===========================================================
+// Heap allocation counters
+// ===========================================================
+//
+// alloc_stats.cpp replaces the global operator new/delete with counting
+// versions over malloc/free, so every C++ heap allocation in the program (all
+// threads, including the standard library's) is counted. Allocations made
+// directly with malloc, e.g. inside the GL driver or GLFW, are not.
+namespace allocstats {
+
+uint64_t count();   // operator new calls since startup
+uint64_t bytes();   // bytes requested by them
+
+} // namespace allocstats
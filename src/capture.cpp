@@ -0,0 +1,151 @@
+#include "capture.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+void rgbaToYUV420(const uint8_t* rgba, int w, int h, uint8_t* y, uint8_t* u, uint8_t* v) {
+    const int cw = (w + 1) / 2, ch = (h + 1) / 2;
+    const size_t stride = (size_t)w * 4;
+    for (int row = 0; row < h; ++row) {
+        const uint8_t* src = rgba + (size_t)(h - 1 - row) * stride;
+        uint8_t* dst = y + (size_t)row * w;
+        for (int x = 0; x < w; ++x, src += 4)
+            dst[x] = (uint8_t)((77 * src[0] + 150 * src[1] + 29 * src[2] + 128) >> 8);
+    }
+    for (int cy = 0; cy < ch; ++cy) {
+        // Source rows of this 2x2 block, flipped; the last row/column repeat for odd sizes
+        const uint8_t* r0 = rgba + (size_t)(h - 1 - 2 * cy) * stride;
+        const uint8_t* r1 = rgba + (size_t)(h - 1 - std::min(2 * cy + 1, h - 1)) * stride;
+        for (int cx = 0; cx < cw; ++cx) {
+            int x0 = 2 * cx * 4, x1 = std::min(2 * cx + 1, w - 1) * 4;
+            int r = r0[x0] + r0[x1] + r1[x0] + r1[x1];
+            int g = r0[x0+1] + r0[x1+1] + r1[x0+1] + r1[x1+1];
+            int b = r0[x0+2] + r0[x1+2] + r1[x0+2] + r1[x1+2];
+            // Sums of four pixels: >> 10 is the 2x2 average and the >> 8 of the fixed-point weights
+            u[(size_t)cy * cw + cx] = (uint8_t)std::clamp(((-43 * r - 85 * g + 128 * b + 512) >> 10) + 128, 0, 255);
+            v[(size_t)cy * cw + cx] = (uint8_t)std::clamp(((128 * r - 107 * g - 21 * b + 512) >> 10) + 128, 0, 255);
+        }
+    }
+}
+
+bool FrameEncoder::open(const std::string& path, int framesPerSecond) {
+    close();
+    target = path;
+    fps = std::max(1, framesPerSecond);
+    fmt = path.size() > 4 && path.compare(path.size() - 4, 4, ".y4m") == 0 ? Y4M : PPM;
+    if (fmt == Y4M) {
+        file = fopen(path.c_str(), "wb");
+        if (!file) { std::cerr << "Capture: cannot write " << path << "\n"; return false; }
+    }
+    streamW = streamH = 0;
+    st = CaptureStats();
+    freeFrames.clear();
+    for (auto& f : pool) freeFrames.push_back(&f);
+    queue.clear();
+    quit = false;
+    worker = std::thread([this]{ run(); });
+    return true;
+}
+
+void FrameEncoder::close() {
+    if (!worker.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    cv.notify_one();
+    worker.join();
+    if (file) { fclose(file); file = nullptr; }
+}
+
+CaptureFrame* FrameEncoder::acquire(int w, int h) {
+    CaptureFrame* f = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (freeFrames.empty()) return nullptr;
+        f = freeFrames.back();
+        freeFrames.pop_back();
+    }
+    f->width = w; f->height = h;
+    f->rgba.resize((size_t)w * h * 4);   // only grows: the pool keeps its capacity
+    return f;
+}
+
+void FrameEncoder::submit(CaptureFrame* f) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(f);
+    }
+    cv.notify_one();
+}
+
+CaptureStats FrameEncoder::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return st;
+}
+
+size_t FrameEncoder::memoryBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t n = scratch.capacity();
+    for (const auto& f : pool) n += f.rgba.capacity();
+    return n;
+}
+
+void FrameEncoder::run() {
+    for (;;) {
+        CaptureFrame* f = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [this]{ return quit || !queue.empty(); });
+            if (queue.empty()) return;   // quit, and everything queued is written
+            f = queue.front();
+            queue.pop_front();
+        }
+        encode(*f);
+        std::lock_guard<std::mutex> lock(mutex);
+        freeFrames.push_back(f);
+    }
+}
+
+void FrameEncoder::encode(const CaptureFrame& f) {
+    auto t0 = std::chrono::steady_clock::now();
+    const int w = f.width, h = f.height;
+    if (!streamW) { streamW = w; streamH = h; }
+    size_t bytes = 0;
+    bool skip = false;
+    if (fmt == Y4M) {
+        if (w != streamW || h != streamH) {
+            skip = true;   // Y4M streams have a single frame size
+        } else {
+            if (st.written == 0) bytes += (size_t)fprintf(file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", w, h, fps);
+            size_t ySize = (size_t)w * h, cSize = (size_t)((w + 1) / 2) * ((h + 1) / 2);
+            scratch.resize(ySize + 2 * cSize);
+            rgbaToYUV420(f.rgba.data(), w, h, scratch.data(), scratch.data() + ySize, scratch.data() + ySize + cSize);
+            bytes += fwrite("FRAME\n", 1, 6, file);
+            bytes += fwrite(scratch.data(), 1, scratch.size(), file);
+        }
+    } else {
+        char name[32];
+        snprintf(name, sizeof name, "_%06llu.ppm", (unsigned long long)st.written);
+        FILE* out = fopen((target + name).c_str(), "wb");
+        if (out) {
+            scratch.resize((size_t)w * h * 3);
+            uint8_t* dst = scratch.data();
+            for (int row = h - 1; row >= 0; --row) {
+                const uint8_t* src = f.rgba.data() + (size_t)row * w * 4;
+                for (int x = 0; x < w; ++x, src += 4, dst += 3) { dst[0] = src[0]; dst[1] = src[1]; dst[2] = src[2]; }
+            }
+            bytes += (size_t)fprintf(out, "P6\n%d %d\n255\n", w, h);
+            bytes += fwrite(scratch.data(), 1, scratch.size(), out);
+            fclose(out);
+        } else {
+            skip = true;
+        }
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (skip) ++st.skipped; else ++st.written;
+    st.encodeMs += ms;
+    st.bytes += bytes;
+}
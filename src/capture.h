@@ -0,0 +1,82 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ===========================================================
+// Video capture: background frame encoder
+// ===========================================================
+//
+// The renderer reads frames back asynchronously (PBO ring in main.cpp) and
+// hands the pixels over here; a dedicated thread converts and writes them so
+// file I/O never lands on the render thread. Frames are recycled through a
+// small pool: once it is warm nothing allocates, and if the encoder falls
+// behind acquire() returns nullptr and the renderer drops that frame instead
+// of waiting.
+
+// Pixels as read back by glReadPixels: RGBA8, bottom row first
+struct CaptureFrame {
+    std::vector<uint8_t> rgba;
+    int width = 0, height = 0;
+};
+
+struct CaptureStats {
+    uint64_t written = 0;      // frames on disk
+    uint64_t skipped = 0;      // frames whose size differed from the first (Y4M needs one size)
+    double encodeMs = 0.0;     // total conversion + write time on the encoder thread
+    uint64_t bytes = 0;
+};
+
+// Full-range BT.601 4:2:0, matching Y4M's C420jpeg. Flips the bottom-up
+// readback so y/u/v are top row first. y is w*h; u and v are ceil(w/2)*ceil(h/2).
+void rgbaToYUV420(const uint8_t* rgba, int w, int h, uint8_t* y, uint8_t* u, uint8_t* v);
+
+class FrameEncoder {
+public:
+    enum Format { Y4M, PPM };
+    static const int POOL_FRAMES = 4;
+
+    ~FrameEncoder() { close(); }
+    // "name.y4m" writes one YUV4MPEG2 stream; anything else is a PPM sequence
+    // name_000000.ppm, name_000001.ppm, ...
+    bool open(const std::string& path, int fps);
+    // Encodes everything still queued, then stops the thread
+    void close();
+    bool isOpen() const { return worker.joinable(); }
+    Format format() const { return fmt; }
+    const std::string& path() const { return target; }
+
+    // Render thread: a free frame sized for w x h, or nullptr when the pool is
+    // all queued. Every acquired frame must be submit()ted.
+    CaptureFrame* acquire(int w, int h);
+    void submit(CaptureFrame* f);
+
+    CaptureStats stats() const;
+    size_t memoryBytes() const;
+
+private:
+    void run();
+    void encode(const CaptureFrame& f);
+
+    std::string target;
+    Format fmt = Y4M;
+    int fps = 60;
+    FILE* file = nullptr;
+    int streamW = 0, streamH = 0;   // set by the first frame
+    std::vector<uint8_t> scratch;   // converted frame, encoder thread only
+
+    CaptureFrame pool[POOL_FRAMES];
+    std::vector<CaptureFrame*> freeFrames;
+    std::deque<CaptureFrame*> queue;
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    bool quit = false;
+    std::thread worker;
+    CaptureStats st;   // guarded by mutex
+};
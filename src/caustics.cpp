@@ -0,0 +1,129 @@
+#include "caustics.h"
+#include "jobs.h"
+#include "snapshot.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+
+namespace {
+
+// Integer wave numbers (cycles per tile) and loop frequencies (cycles per period)
+struct Wave { int kx, kz, cycles; float amp, phase; };
+const Wave kWaves[] = {
+    { 3,  2,  1, 0.0036f, 0.0f },
+    {-2,  4, -1, 0.0027f, 1.7f },
+    { 5, -1,  2, 0.0018f, 4.1f },
+    { 1, -6, -2, 0.0013f, 2.6f },
+    {-7, -3,  3, 0.0007f, 5.3f },
+};
+const int kWaveCount = (int)(sizeof(kWaves) / sizeof(kWaves[0]));
+const float kEta = 1.0f / 1.33f;      // air -> water
+const int kOversample = 2;            // photons per texel side
+
+} // namespace
+
+CausticsBake bakeCaustics(int size, int frames, float tileSize, float period, float depth) {
+    auto t0 = std::chrono::steady_clock::now();
+    CausticsBake b;
+    b.size = size; b.frames = frames; b.tileSize = tileSize; b.period = period;
+    b.texels.assign((size_t)frames * size * size, 0);
+
+    const float twoPi = 6.28318530718f;
+    const int photons = size * kOversample;
+    const float texPerWorld = (float)size / tileSize;
+    const float dx = tileSize / photons;
+    float waveK[kWaveCount][3];   // amplitude, angular wave numbers
+    for (int w = 0; w < kWaveCount; ++w) {
+        waveK[w][0] = kWaves[w].amp;
+        waveK[w][1] = twoPi * kWaves[w].kx / tileSize;
+        waveK[w][2] = twoPi * kWaves[w].kz / tileSize;
+    }
+
+    jobs::parallelFor((size_t)frames, 1, [&](size_t f0, size_t f1) {
+        std::vector<float> accum((size_t)size * size);
+        for (size_t f = f0; f < f1; ++f) {
+            std::fill(accum.begin(), accum.end(), 0.0f);
+            const float t = (float)f / (float)frames;
+            for (int j = 0; j < photons; ++j) {
+                const float z = ((float)j + 0.5f) * dx;
+                // Each wave's phase advances by a constant step along the row,
+                // so rotate a phasor instead of calling cos() per photon.
+                float pc[kWaveCount], ps[kWaveCount], rc[kWaveCount], rs[kWaveCount];
+                for (int w = 0; w < kWaveCount; ++w) {
+                    float kx = waveK[w][1], kz = waveK[w][2];
+                    float a0 = kx * 0.5f * dx + kz * z - twoPi * kWaves[w].cycles * t + kWaves[w].phase;
+                    pc[w] = std::cos(a0); ps[w] = std::sin(a0);
+                    rc[w] = std::cos(kx * dx); rs[w] = std::sin(kx * dx);
+                }
+                for (int i = 0; i < photons; ++i) {
+                    const float x = ((float)i + 0.5f) * dx;
+                    // Analytic surface gradient
+                    float gx = 0.0f, gz = 0.0f;
+                    for (int w = 0; w < kWaveCount; ++w) {
+                        float c = waveK[w][0] * pc[w];
+                        gx += c * waveK[w][1]; gz += c * waveK[w][2];
+                        float nc = pc[w] * rc[w] - ps[w] * rs[w];
+                        ps[w] = ps[w] * rc[w] + pc[w] * rs[w]; pc[w] = nc;
+                    }
+                    // Refract a vertical ray through the normal (-gx, 1, -gz)
+                    float inv = 1.0f / std::sqrt(gx * gx + 1.0f + gz * gz);
+                    float nx = -gx * inv, ny = inv, nz = -gz * inv;
+                    float cosi = ny;   // dot(-I, N) with I = (0,-1,0)
+                    float k = 1.0f - kEta * kEta * (1.0f - cosi * cosi);
+                    float s = kEta * cosi - std::sqrt(std::max(k, 0.0f));
+                    float rx = s * nx, ry = -kEta + s * ny, rz = s * nz;
+                    float hitX = x + rx / -ry * depth, hitZ = z + rz / -ry * depth;
+
+                    // Bilinear splat with wrap-around so the tile stays seamless
+                    float u = hitX * texPerWorld - 0.5f, v = hitZ * texPerWorld - 0.5f;
+                    float fu = std::floor(u), fv = std::floor(v);
+                    float au = u - fu, av = v - fv;
+                    int iu = ((int)fu % size + size) % size, iv = ((int)fv % size + size) % size;
+                    int iu1 = (iu + 1) % size, iv1 = (iv + 1) % size;
+                    accum[(size_t)iv  * size + iu ] += (1 - au) * (1 - av);
+                    accum[(size_t)iv  * size + iu1] += au * (1 - av);
+                    accum[(size_t)iv1 * size + iu ] += (1 - au) * av;
+                    accum[(size_t)iv1 * size + iu1] += au * av;
+                }
+            }
+            // Mean density is kOversample^2; keep only the focused part
+            const float mean = (float)(kOversample * kOversample);
+            uint8_t* out = b.texels.data() + f * size * size;
+            for (size_t p = 0; p < accum.size(); ++p) {
+                float c = std::clamp((accum[p] / mean - 0.8f) * 0.35f, 0.0f, 1.0f);
+                out[p] = (uint8_t)(c * 255.0f + 0.5f);
+            }
+        }
+    });
+
+    b.bakeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    return b;
+}
+
+CausticsBake loadOrBakeCaustics(const std::string& cachePath, int size, int frames,
+                                float tileSize, float period, float depth) {
+    // The wave set is part of the key so editing it invalidates old caches
+    uint64_t waves = hashBytes(kWaves, sizeof(kWaves));
+    float params[4] = { (float)size, (float)frames, tileSize, depth };
+    {
+        SnapshotReader r;
+        float cp[4]; uint64_t cw = 0;
+        CausticsBake b;
+        if (std::ifstream(cachePath).good() && r.open(cachePath) && r.readValue("caustics.params", cp) && r.readValue("caustics.waves", cw)
+            && std::equal(cp, cp + 4, params) && cw == waves && r.readVector("caustics.texels", b.texels)
+            && b.texels.size() == (size_t)frames * size * size) {
+            b.size = size; b.frames = frames; b.tileSize = tileSize; b.period = period;
+            b.fromCache = true;
+            return b;
+        }
+    }
+    CausticsBake b = bakeCaustics(size, frames, tileSize, period, depth);
+    SnapshotWriter w;
+    w.addValue("caustics.params", params);
+    w.addValue("caustics.waves", waves);
+    w.addVector("caustics.texels", b.texels);
+    w.save(cachePath);
+    return b;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ===========================================================
+// Caustics baker (CPU photon splatting, tiling + looping)
+// ===========================================================
+//
+// Traces sunlight straight down through a periodic wave surface, refracts it
+// and accumulates where it lands on a plane `depth` below. Wave vectors are
+// integer multiples of the tile and frequencies integer multiples of the loop,
+// so the result tiles in x/z and loops in time without seams.
+
+struct CausticsBake {
+    int size = 0, frames = 0;
+    float tileSize = 1.0f;    // world units covered by one tile
+    float period = 8.0f;      // seconds per loop
+    std::vector<uint8_t> texels;   // frames * size * size, R8, layer-major
+    double bakeMs = 0.0;
+    bool fromCache = false;
+};
+
+CausticsBake bakeCaustics(int size, int frames, float tileSize, float period, float depth);
+
+// Reuses `cachePath` if it was baked with the same parameters, otherwise
+// bakes and rewrites it. An unwritable cache only costs the bake next time.
+CausticsBake loadOrBakeCaustics(const std::string& cachePath, int size, int frames,
+                                float tileSize, float period, float depth);
@@ -0,0 +1,115 @@
+#include "fish_shm.h"
+
+#include <cstring>
+#include <iostream>
+#include <new>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+size_t fishShmBytes(uint32_t capacity) {
+    return sizeof(FishShmHeader) + 2 * (size_t)capacity * sizeof(FishShmRecord);
+}
+
+bool FishShmWriter::open(const std::string& name, uint32_t capacity) {
+    close();
+    capacity = std::max(capacity, 1u);
+    shm_unlink(name.c_str());   // a segment left behind by a crashed run
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) { std::cerr << "Shared memory: cannot create " << name << ": " << std::strerror(errno) << "\n"; return false; }
+    size_t bytes = fishShmBytes(capacity);
+    if (ftruncate(fd, (off_t)bytes) != 0) {
+        std::cerr << "Shared memory: cannot size " << name << ": " << std::strerror(errno) << "\n";
+        ::close(fd); shm_unlink(name.c_str()); return false;
+    }
+    void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) { std::cerr << "Shared memory: mmap failed for " << name << "\n"; shm_unlink(name.c_str()); return false; }
+
+    hdr = new (p) FishShmHeader();
+    hdr->version = FISH_SHM_VERSION;
+    hdr->capacity = capacity;
+    hdr->recordSize = sizeof(FishShmRecord);
+    hdr->closed.store(0, std::memory_order_relaxed);
+    hdr->frame.store(0, std::memory_order_relaxed);
+    hdr->magic.store(FISH_SHM_MAGIC, std::memory_order_release);   // readers may attach from here on
+    segName = name;
+    mapped = bytes;
+    writing = 0;
+    return true;
+}
+
+void FishShmWriter::close() {
+    if (!hdr) return;
+    hdr->closed.store(1, std::memory_order_release);
+    munmap(hdr, mapped);
+    shm_unlink(segName.c_str());
+    hdr = nullptr; mapped = 0;
+}
+
+bool FishShmWriter::reserve(uint32_t records) {
+    if (!hdr || records <= hdr->capacity) return hdr != nullptr;
+    std::string name = segName;
+    uint64_t frame = hdr->frame.load(std::memory_order_relaxed);
+    if (!open(name, records + records / 2)) return false;
+    hdr->frame.store(frame, std::memory_order_release);   // keep frame numbers increasing for readers
+    return true;
+}
+
+FishShmRecord* FishShmWriter::begin() {
+    writing = hdr->frame.load(std::memory_order_relaxed) + 1;
+    FishShmBuffer& b = hdr->buffers[writing & 1];
+    b.seq.store(b.seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    uint8_t* base = reinterpret_cast<uint8_t*>(hdr) + sizeof(FishShmHeader);
+    return reinterpret_cast<FishShmRecord*>(base) + (writing & 1) * hdr->capacity;
+}
+
+void FishShmWriter::commit(uint32_t count, uint32_t tanks, double simTime) {
+    FishShmBuffer& b = hdr->buffers[writing & 1];
+    b.count = std::min(count, hdr->capacity);
+    b.tanks = tanks;
+    b.simTime = simTime;
+    b.seq.store(b.seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    hdr->frame.store(writing, std::memory_order_release);
+}
+
+bool FishShmReader::open(const std::string& name) {
+    close();
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(FishShmHeader)) { ::close(fd); return false; }
+    void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+    hdr = static_cast<const FishShmHeader*>(p);
+    mapped = (size_t)st.st_size;
+    uint32_t magic = hdr->magic.load(std::memory_order_acquire);
+    if (magic == 0) { close(); return false; }   // the writer is still setting it up
+    if (magic != FISH_SHM_MAGIC || hdr->version != FISH_SHM_VERSION
+        || hdr->recordSize != sizeof(FishShmRecord) || fishShmBytes(hdr->capacity) > mapped) {
+        std::cerr << "Shared memory: " << name << " is not a fish segment of version " << FISH_SHM_VERSION << "\n";
+        close(); return false;
+    }
+    return true;
+}
+
+void FishShmReader::close() {
+    if (!hdr) return;
+    munmap(const_cast<FishShmHeader*>(hdr), mapped);
+    hdr = nullptr; mapped = 0;
+}
+
+FishShmReader::Status FishShmReader::copy(std::vector<FishShmRecord>& out, FishShmFrame& info, int attempts) const {
+    Status st = Torn;
+    for (int i = 0; i < attempts && st == Torn; ++i) {
+        st = read([&](const FishShmRecord* r, const FishShmFrame& f) {
+            out.assign(r, r + f.count);
+            info = f;
+        });
+    }
+    return st;
+}
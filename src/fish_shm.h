@@ -0,0 +1,138 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ===========================================================
+// Live fish state in POSIX shared memory
+// ===========================================================
+//
+// The app (--shm-export name) publishes every fish after each simulation step
+// into a named shared-memory segment; other local processes map it and read
+// the records in place, with no serialization. The segment is a header and two
+// record buffers. Frame f is written into buffer f & 1 under that buffer's
+// sequence lock (odd while the writer is inside), then `frame` is advanced, so
+// readers always find the newest complete frame and the writer never waits.
+//
+// Layout and the reader only depend on this header, so external tools can
+// build against fish_shm.h/.cpp alone.
+
+static const uint32_t FISH_SHM_MAGIC   = 0x48534641;   // "AFSH"
+static const uint32_t FISH_SHM_VERSION = 1;
+
+// One fish, world-space (tank origin included)
+struct FishShmRecord {
+    float pos[3];
+    float vel[3];
+    uint32_t species;   // Species index, see school.h
+    uint32_t tank;      // index of the owning tank
+};
+
+struct FishShmBuffer {
+    std::atomic<uint64_t> seq;   // odd while being written
+    uint32_t count;              // records in this buffer
+    uint32_t tanks;
+    double simTime;              // seconds of simulated time at this frame
+};
+
+struct FishShmHeader {
+    std::atomic<uint32_t> magic;   // published last: the other fields are valid once it is set
+    uint32_t version;
+    uint32_t capacity;             // records per buffer
+    uint32_t recordSize;           // sizeof(FishShmRecord)
+    std::atomic<uint32_t> closed;  // writer exited or replaced the segment
+    uint32_t reserved;
+    std::atomic<uint64_t> frame;   // newest complete frame (0 = none); lives in buffers[frame & 1]
+    FishShmBuffer buffers[2];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "shared-memory atomics must be lock-free to work across processes");
+
+size_t fishShmBytes(uint32_t capacity);
+
+// Writer side, owned by the simulation. Not thread-safe: one thread publishes.
+class FishShmWriter {
+public:
+    FishShmWriter() = default;
+    FishShmWriter(const FishShmWriter&) = delete;
+    FishShmWriter& operator=(const FishShmWriter&) = delete;
+    ~FishShmWriter() { close(); }
+
+    // Creates (replacing any stale segment of that name) and maps the segment.
+    // POSIX names start with '/', e.g. "/aquarium".
+    bool open(const std::string& name, uint32_t capacity);
+    // Marks the segment closed for readers, unmaps and unlinks it
+    void close();
+    bool isOpen() const { return hdr != nullptr; }
+    uint32_t capacity() const { return hdr ? hdr->capacity : 0; }
+    size_t bytes() const { return mapped; }
+
+    // Grows the segment if needed: readers see `closed` and reopen by name
+    bool reserve(uint32_t records);
+
+    // Opens the next frame's buffer for writing; fill up to capacity() records
+    FishShmRecord* begin();
+    void commit(uint32_t count, uint32_t tanks, double simTime);
+
+private:
+    std::string segName;
+    FishShmHeader* hdr = nullptr;
+    size_t mapped = 0;
+    uint64_t writing = 0;   // frame between begin() and commit()
+};
+
+struct FishShmFrame {
+    uint64_t frame = 0;
+    uint32_t count = 0, tanks = 0;
+    double simTime = 0.0;
+};
+
+// Reader side: maps the segment read-only and visits the newest frame in place.
+class FishShmReader {
+public:
+    enum Status { Ok, NoData, Torn, Closed };
+
+    FishShmReader() = default;
+    FishShmReader(const FishShmReader&) = delete;
+    FishShmReader& operator=(const FishShmReader&) = delete;
+    ~FishShmReader() { close(); }
+
+    bool open(const std::string& name);
+    void close();
+    bool isOpen() const { return hdr != nullptr; }
+
+    // Calls fn(const FishShmRecord* records, const FishShmFrame& info) on the
+    // newest frame without copying. The records may be overwritten while fn
+    // runs; only trust what fn computed if this returns Ok (Torn: call again).
+    template<typename Fn> Status read(Fn&& fn) const {
+        if (hdr->closed.load(std::memory_order_acquire)) return Closed;
+        uint64_t f = hdr->frame.load(std::memory_order_acquire);
+        if (f == 0) return NoData;
+        const FishShmBuffer& b = hdr->buffers[f & 1];
+        uint64_t s = b.seq.load(std::memory_order_acquire);
+        if (s & 1) return Torn;
+        FishShmFrame info;
+        info.frame = f;
+        info.count = std::min(b.count, hdr->capacity);
+        info.tanks = b.tanks;
+        info.simTime = b.simTime;
+        fn(records(f & 1), info);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return b.seq.load(std::memory_order_relaxed) == s ? Ok : Torn;
+    }
+    // Copying convenience: retries torn reads up to `attempts` times
+    Status copy(std::vector<FishShmRecord>& out, FishShmFrame& info, int attempts = 16) const;
+
+private:
+    const FishShmRecord* records(uint64_t buffer) const {
+        const uint8_t* base = reinterpret_cast<const uint8_t*>(hdr) + sizeof(FishShmHeader);
+        return reinterpret_cast<const FishShmRecord*>(base) + buffer * hdr->capacity;
+    }
+
+    const FishShmHeader* hdr = nullptr;
+    size_t mapped = 0;
+};
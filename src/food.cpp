@@ -0,0 +1,257 @@
+#include "food.h"
+#include "snapshot.h"
+
+#include <algorithm>
+#include <cmath>
+
+void FoodSystem::init(int capacity, float floor, float surface, uint32_t seed) {
+    cap = std::max(capacity, 0);
+    floorY = floor; surfaceY = surface;
+    rng.seed(seed);
+    for (auto* v : { &px, &py, &pz, &sink, &phase, &age }) { v->clear(); v->reserve(cap); }
+    eaten.clear(); eaten.reserve(cap);
+    items.clear(); items.reserve(cap);
+    cellStart.assign(2, 0);
+    blockCount.assign(1, 0);
+    blockSum.assign(8, 0);
+    eatenCount = 0;
+}
+
+int FoodSystem::drop(int n, float spread, glm::vec2 area) {
+    n = std::min(n, cap - count());
+    if (n <= 0) return 0;
+    std::uniform_real_distribution<float> u(-1.0f, 1.0f), u01(0.0f, 1.0f);
+    glm::vec2 c(u(rng) * area.x, u(rng) * area.y);
+    for (int i = 0; i < n; ++i) {
+        // Uniform over the disc, clipped to the area
+        float a = u01(rng) * 6.28318f, r = spread * std::sqrt(u01(rng));
+        px.push_back(std::clamp(c.x + r * std::cos(a), -area.x, area.x));
+        py.push_back(surfaceY - 0.01f * u01(rng));
+        pz.push_back(std::clamp(c.y + r * std::sin(a), -area.y, area.y));
+        sink.push_back(0.05f + 0.07f * u01(rng));
+        phase.push_back(u01(rng) * 6.28318f);
+        age.push_back(0.0f);
+        eaten.push_back(0);
+    }
+    buildGrid();   // findable before the next update
+    return n;
+}
+
+void FoodSystem::update(float dt) {
+    // Sink with a slow sideways drift, rest on the sand; drop eaten and dissolved pellets in place
+    const float rest = floorY + 0.005f;
+    size_t w = 0;
+    for (size_t i = 0; i < px.size(); ++i) {
+        float a = age[i] + dt;
+        if (eaten[i] || a > lifetime) continue;
+        float x = px[i], y = py[i], z = pz[i];
+        if (y > rest) {
+            x += 0.02f * std::sin(a * 1.7f + phase[i]) * dt;
+            z += 0.02f * std::cos(a * 1.3f + phase[i]) * dt;
+            y = std::max(y - sink[i] * dt, rest);
+        }
+        px[w] = x; py[w] = y; pz[w] = z;
+        sink[w] = sink[i]; phase[w] = phase[i]; age[w] = a; eaten[w] = 0;
+        ++w;
+    }
+    for (auto* v : { &px, &py, &pz, &sink, &phase, &age }) v->resize(w);
+    eaten.resize(w);
+    buildGrid();
+}
+
+void FoodSystem::buildGrid() {
+    const size_t n = px.size();
+    items.resize(n);
+    if (n == 0) {
+        dim = blockDim = glm::ivec3(1); cellStart.assign(2, 0); blockCount.assign(1, 0); blockSum.assign(8, 0);
+        return;
+    }
+    glm::vec3 bmin(1e30f), bmax(-1e30f);
+    for (size_t i = 0; i < n; ++i) {
+        glm::vec3 p(px[i], py[i], pz[i]);
+        bmin = glm::min(bmin, p); bmax = glm::max(bmax, p);
+    }
+    // About two pellets per cell, at most 64 cells per axis
+    glm::vec3 size = glm::max(bmax - bmin, glm::vec3(1e-3f));
+    cell = std::cbrt(size.x * size.y * size.z * 2.0f / (float)n);
+    cell = std::max(cell, std::max(0.01f, std::max(size.x, std::max(size.y, size.z)) / 64.0f));
+    invCell = 1.0f / cell;
+    lo = bmin; hi = bmax;
+    dim = glm::clamp(glm::ivec3(glm::ceil(size * invCell)), glm::ivec3(1), glm::ivec3(64));
+    blockDim = (dim + (BLOCK - 1)) / BLOCK;
+    auto index = [&](glm::vec3 p) {
+        glm::ivec3 c = glm::clamp(glm::ivec3((p - lo) * invCell), glm::ivec3(0), dim - 1);
+        return (c.z * dim.y + c.y) * dim.x + c.x;
+    };
+    size_t cells = (size_t)dim.x * dim.y * dim.z;
+    cellStart.assign(cells + 1, 0);
+    for (size_t i = 0; i < n; ++i) ++cellStart[index(glm::vec3(px[i], py[i], pz[i]))];
+    blockCount.assign((size_t)blockDim.x * blockDim.y * blockDim.z, 0);
+    for (int z = 0; z < dim.z; ++z)
+        for (int y = 0; y < dim.y; ++y)
+            for (int x = 0; x < dim.x; ++x) {
+                glm::ivec3 b = glm::ivec3(x, y, z) / BLOCK;
+                blockCount[(b.z * blockDim.y + b.y) * blockDim.x + b.x] += cellStart[(z * dim.y + y) * dim.x + x];
+            }
+    // Summed-volume table, one row/column/slice of zeros in front of each axis
+    const glm::ivec3 sd = blockDim + 1;
+    blockSum.assign((size_t)sd.x * sd.y * sd.z, 0);
+    for (int z = 1; z < sd.z; ++z)
+        for (int y = 1; y < sd.y; ++y)
+            for (int x = 1; x < sd.x; ++x) {
+                auto at = [&](int i, int j, int k) { return blockSum[((size_t)k * sd.y + j) * sd.x + i]; };
+                blockSum[((size_t)z * sd.y + y) * sd.x + x] =
+                    blockCount[((z - 1) * blockDim.y + (y - 1)) * blockDim.x + (x - 1)]
+                    + at(x - 1, y, z) + at(x, y - 1, z) + at(x, y, z - 1)
+                    - at(x - 1, y - 1, z) - at(x - 1, y, z - 1) - at(x, y - 1, z - 1)
+                    + at(x - 1, y - 1, z - 1);
+            }
+    for (size_t c = 1; c <= cells; ++c) cellStart[c] += cellStart[c - 1];
+    for (size_t i = n; i-- > 0;) {
+        glm::vec3 p(px[i], py[i], pz[i]);
+        items[--cellStart[index(p)]] = { p, (uint32_t)i };
+    }
+}
+
+// Squared distance from v to the interval [a, b]
+static float gap2(float v, float a, float b) {
+    float g = std::max(std::max(a - v, v - b), 0.0f);
+    return g * g;
+}
+
+// Squared distance from p to the box [a, b]
+static float boxDistance2(glm::vec3 p, glm::vec3 a, glm::vec3 b) {
+    return gap2(p.x, a.x, b.x) + gap2(p.y, a.y, b.y) + gap2(p.z, a.z, b.z);
+}
+
+uint32_t FoodSystem::pelletsInBlocks(glm::ivec3 b0, glm::ivec3 b1) const {
+    b0 = glm::max(b0, glm::ivec3(0));
+    b1 = glm::min(b1, blockDim - 1) + 1;
+    if (b0.x >= b1.x || b0.y >= b1.y || b0.z >= b1.z) return 0;
+    const glm::ivec3 sd = blockDim + 1;
+    auto at = [&](int x, int y, int z) { return blockSum[((size_t)z * sd.y + y) * sd.x + x]; };
+    // Unsigned wraparound cancels out: the true sum is never negative
+    return at(b1.x, b1.y, b1.z) - at(b0.x, b1.y, b1.z) - at(b1.x, b0.y, b1.z) - at(b1.x, b1.y, b0.z)
+         + at(b0.x, b0.y, b1.z) + at(b0.x, b1.y, b0.z) + at(b1.x, b0.y, b0.z) - at(b0.x, b0.y, b0.z);
+}
+
+int FoodSystem::nearest(glm::vec3 p, float maxDist) const {
+    if (items.empty()) return -1;
+    float best2 = maxDist * maxDist;
+    if (boxDistance2(p, lo, hi) > best2) return -1;
+
+    // Shells of blocks around p's (unclamped) block, clipped to the grid. Every
+    // block of shell r is at least (r-1) blocks away, which bounds the search;
+    // occupied blocks and cells closer than the best so far are scanned.
+    const float blockSize = cell * BLOCK;
+    const glm::ivec3 c(glm::floor((p - lo) * (invCell / BLOCK)));
+    // Most fish are far from any pellet: one table lookup over the blocks the
+    // sense sphere's bounding box touches settles them without a search
+    const glm::ivec3 s0(glm::floor((p - maxDist - lo) * (invCell / BLOCK)));
+    const glm::ivec3 s1(glm::floor((p + maxDist - lo) * (invCell / BLOCK)));
+    if (pelletsInBlocks(s0, s1) == 0) return -1;
+    const glm::ivec3 top = blockDim - 1;
+    const glm::ivec3 before = glm::max(-c, glm::ivec3(0)), after = glm::max(c - top, glm::ivec3(0));
+    const glm::ivec3 toFar = glm::max(glm::abs(c), glm::abs(c - top));
+    const int r0 = std::max(std::max(before.x, after.x), std::max(std::max(before.y, after.y), std::max(before.z, after.z)));
+    const int r1 = std::max(toFar.x, std::max(toFar.y, toFar.z));
+    int best = -1;
+    auto scanCell = [&](int ci) {
+        for (uint32_t it = cellStart[ci]; it < cellStart[ci + 1]; ++it) {
+            const Item& o = items[it];
+            float dx = o.pos.x - p.x, dy = o.pos.y - p.y, dz = o.pos.z - p.z;
+            float d2 = dx * dx + dy * dy + dz * dz;
+            if (d2 < best2 && !eaten[o.pellet]) { best2 = d2; best = (int)o.pellet; }
+        }
+    };
+    // Seed the bound from the cell nearest p, so the shells below prune from the start
+    const glm::ivec3 near = glm::clamp(glm::ivec3(glm::floor((p - lo) * invCell)), glm::ivec3(0), dim - 1);
+    scanCell((near.z * dim.y + near.y) * dim.x + near.x);
+    auto visit = [&](int bx, int by, int bz) {
+        if (!blockCount[(bz * blockDim.y + by) * blockDim.x + bx]) return;
+        const glm::ivec3 c0 = glm::ivec3(bx, by, bz) * BLOCK, c1 = glm::min(c0 + BLOCK, dim);
+        glm::vec3 b0 = lo + glm::vec3(c0) * cell;
+        if (boxDistance2(p, b0, b0 + glm::vec3(blockSize)) >= best2) return;
+        // A cell's squared distance is the sum of its per-axis gaps squared
+        float gap[3][BLOCK];
+        for (int a = 0; a < 3; ++a)
+            for (int k = 0; k < BLOCK; ++k) {
+                float c = b0[a] + (float)k * cell;
+                gap[a][k] = gap2(p[a], c, c + cell);
+            }
+        for (int z = c0.z; z < c1.z; ++z) {
+            const float gz = gap[2][z - c0.z];
+            if (gz >= best2) continue;
+            for (int y = c0.y; y < c1.y; ++y) {
+                const float gzy = gz + gap[1][y - c0.y];
+                if (gzy >= best2) continue;
+                for (int x = c0.x; x < c1.x; ++x) {
+                    int ci = (z * dim.y + y) * dim.x + x;
+                    if (cellStart[ci] != cellStart[ci + 1] && gzy + gap[0][x - c0.x] < best2) scanCell(ci);
+                }
+            }
+        }
+    };
+    for (int r = r0; r <= r1; ++r) {
+        float reach = (float)(r - 1) * blockSize;
+        if (r > 0 && reach * reach >= best2) break;
+        // Shell r holds whatever box r has beyond box r-1; skip it when that is nothing
+        if (r > 0 && pelletsInBlocks(c - r, c + r) == pelletsInBlocks(c - (r - 1), c + (r - 1))) continue;
+        for (int z = std::max(c.z - r, 0); z <= std::min(c.z + r, top.z); ++z)
+        for (int y = std::max(c.y - r, 0); y <= std::min(c.y + r, top.y); ++y) {
+            if (std::abs(z - c.z) == r || std::abs(y - c.y) == r) {
+                for (int x = std::max(c.x - r, 0); x <= std::min(c.x + r, top.x); ++x) visit(x, y, z);
+            } else {
+                // Inside the shell's z/y range: only its two x walls
+                if (c.x - r >= 0) visit(c.x - r, y, z);
+                if (c.x + r <= top.x) visit(c.x + r, y, z);
+            }
+        }
+    }
+    return best;
+}
+
+bool FoodSystem::eat(int i) {
+    if (i < 0 || i >= count() || eaten[i]) return false;
+    eaten[i] = 1;
+    ++eatenCount;
+    return true;
+}
+
+size_t FoodSystem::memoryBytes() const {
+    return (px.capacity() + py.capacity() + pz.capacity() + sink.capacity() + phase.capacity() + age.capacity()) * sizeof(float)
+         + eaten.capacity() + (cellStart.capacity() + blockCount.capacity() + blockSum.capacity()) * sizeof(uint32_t) + items.capacity() * sizeof(Item);
+}
+
+void FoodSystem::save(SnapshotWriter& w) const {
+    float params[3] = { floorY, surfaceY, lifetime };
+    int32_t capacity = cap;
+    uint64_t total = eatenCount;
+    w.addValue("food.params", params);
+    w.addValue("food.capacity", capacity);
+    w.addValue("food.eaten_total", total);
+    w.addVector("food.px", px); w.addVector("food.py", py); w.addVector("food.pz", pz);
+    w.addVector("food.sink", sink); w.addVector("food.phase", phase); w.addVector("food.age", age);
+    w.addVector("food.eaten", eaten);
+    w.addRng("food.rng", rng);
+}
+
+bool FoodSystem::load(const SnapshotReader& r) {
+    float params[3]; int32_t capacity; uint64_t total;
+    if (!r.readValue("food.params", params) || !r.readValue("food.capacity", capacity)
+        || !r.readValue("food.eaten_total", total)) return false;
+    init(capacity, params[0], params[1], 0u);
+    lifetime = params[2];
+    bool ok = r.readVector("food.px", px) && r.readVector("food.py", py) && r.readVector("food.pz", pz)
+        && r.readVector("food.sink", sink) && r.readVector("food.phase", phase) && r.readVector("food.age", age)
+        && r.readVector("food.eaten", eaten) && r.readRng("food.rng", rng);
+    size_t n = px.size();
+    ok = ok && py.size() == n && pz.size() == n && sink.size() == n && phase.size() == n && age.size() == n
+            && eaten.size() == n && n <= (size_t)cap;
+    if (!ok) { init(cap, floorY, surfaceY, 0u); return false; }
+    for (auto* v : { &px, &py, &pz, &sink, &phase, &age }) v->reserve(cap);
+    eaten.reserve(cap);
+    eatenCount = total;
+    buildGrid();
+    return true;
+}
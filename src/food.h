@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class SnapshotWriter;
+class SnapshotReader;
+
+// ===========================================================
+// Fish food: sinking pellets and nearest-pellet queries
+// ===========================================================
+//
+// A feeding event scatters pellets over a patch of the surface; they sink with
+// a little sideways drift, settle on the sand and dissolve after a while
+// unless a fish eats them first. Pellets are stored densely (SoA). Every
+// update() removes the eaten ones and rebuilds a uniform grid over the rest, so
+// each fish finds its nearest pellet by searching a few cells instead of
+// scanning them all.
+
+class FoodSystem {
+public:
+    // Reserves room for `capacity` pellets; later drops that do not fit are cut short.
+    void init(int capacity, float floorY, float surfaceY, uint32_t seed);
+
+    // Feeding event: up to n pellets (whatever fits) over a disc of radius
+    // `spread` around a random point of the surface with |x|, |z| < area.
+    // Returns how many were added.
+    int drop(int n, float spread, glm::vec2 area);
+
+    // Sinks and ages the pellets, drops eaten and dissolved ones, rebuilds the grid
+    void update(float dt);
+
+    // Nearest pellet to p not eaten yet, within maxDist; -1 if none. Uses the
+    // grid as of the last update().
+    int nearest(glm::vec3 p, float maxDist) const;
+    // Marks pellet i eaten; false if something else got it first
+    bool eat(int i);
+
+    void save(SnapshotWriter& w) const;
+    bool load(const SnapshotReader& r);
+
+    int count() const { return (int)px.size(); }
+    int capacity() const { return cap; }
+    uint64_t eatenTotal() const { return eatenCount; }
+    size_t memoryBytes() const;
+
+    float lifetime = 60.0f;   // seconds from the drop until a pellet dissolves
+
+    // SoA state, indexed by pellet
+    std::vector<float> px, py, pz;
+    std::vector<float> sink;      // fall speed
+    std::vector<float> phase;     // drift phase
+    std::vector<float> age;
+    std::vector<uint8_t> eaten;
+
+private:
+    void buildGrid();
+    // Pellets in blocks [b0, b1] (inclusive, clipped to the grid) as of the last buildGrid()
+    uint32_t pelletsInBlocks(glm::ivec3 b0, glm::ivec3 b1) const;
+
+    int cap = 0;
+    float floorY = -1.0f, surfaceY = 1.0f;
+    uint64_t eatenCount = 0;
+    std::mt19937 rng;
+
+    // Grid over the pellets' bounding box, filled with a counting sort. Blocks
+    // of BLOCK^3 cells keep a pellet count so searches skip empty water quickly,
+    // and a summed-volume table over those counts answers "any pellet in this
+    // box of blocks?" in O(1), so fish with nothing in range skip the search.
+    static constexpr int BLOCK = 4;
+    glm::vec3 lo{0.0f}, hi{0.0f};
+    float cell = 1.0f, invCell = 1.0f;
+    glm::ivec3 dim{1}, blockDim{1};
+    struct Item { glm::vec3 pos; uint32_t pellet; };
+    std::vector<uint32_t> cellStart;    // dim.x*dim.y*dim.z + 1 offsets into items
+    std::vector<uint32_t> blockCount;   // pellets per block
+    std::vector<uint32_t> blockSum;     // (blockDim+1)^3 table: pellets in blocks [0, b)
+    std::vector<Item> items;
+};
@@ -0,0 +1,38 @@
+#include "frame_arena.h"
+
+#include <algorithm>
+
+FrameArena::FrameArena(size_t bytes)
+    : block(new unsigned char[bytes]), cap(bytes) {}
+
+void* FrameArena::allocate(size_t bytes, size_t align) {
+    uintptr_t base = reinterpret_cast<uintptr_t>(block.get());
+    size_t start = ((base + offset + align - 1) & ~(uintptr_t)(align - 1)) - base;
+    if (start + bytes <= cap) {
+        offset = start + bytes;
+        return block.get() + start;
+    }
+    // Out of room this frame: fall back to the heap, remembered until reset()
+    spill.emplace_back(new unsigned char[bytes + align]);
+    spillBytes += bytes + align;
+    ++spillCount;
+    uintptr_t p = reinterpret_cast<uintptr_t>(spill.back().get());
+    return reinterpret_cast<void*>((p + align - 1) & ~(uintptr_t)(align - 1));
+}
+
+void FrameArena::deallocate(void* p, size_t bytes) {
+    unsigned char* c = static_cast<unsigned char*>(p);
+    if (c >= block.get() && c + bytes == block.get() + offset) offset = (size_t)(c - block.get());
+}
+
+void FrameArena::reset() {
+    peakBytes = std::max(peakBytes, used());
+    if (!spill.empty()) {
+        // Grow so a frame like this one fits in the block next time
+        cap = std::max(cap * 2, offset + spillBytes + spillBytes / 2);
+        block.reset(new unsigned char[cap]);
+        spill.clear();
+        spillBytes = 0;
+    }
+    offset = 0;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// ===========================================================
+// Per-frame bump allocator for transient CPU data
+// ===========================================================
+//
+// Everything allocated from the arena lives until the next reset(), which the
+// frame loop calls at the top of every iteration. Allocation is a pointer bump
+// and freeing is a no-op, so steady-state frames never reach the heap. A frame
+// that outgrows the block spills into separate heap blocks; the next reset()
+// replaces the block with one big enough for that frame.
+// Not thread-safe: each thread that wants one owns its own arena.
+class FrameArena {
+public:
+    explicit FrameArena(size_t bytes = 1 << 20);
+
+    void* allocate(size_t bytes, size_t align);
+    // Only the most recent allocation is actually given back (vector growth)
+    void deallocate(void* p, size_t bytes);
+    void reset();
+
+    size_t used() const { return offset + spillBytes; }
+    size_t capacity() const { return cap; }
+    size_t peak() const { return peakBytes; }   // largest frame so far
+    uint64_t spills() const { return spillCount; }
+
+private:
+    std::unique_ptr<unsigned char[]> block;
+    size_t cap = 0, offset = 0;
+    std::vector<std::unique_ptr<unsigned char[]>> spill;
+    size_t spillBytes = 0, peakBytes = 0;
+    uint64_t spillCount = 0;
+};
+
+// STL allocator over a FrameArena. Containers using it must not outlive the frame.
+template<typename T>
+class FrameAllocator {
+public:
+    using value_type = T;
+
+    explicit FrameAllocator(FrameArena& a) : arena(&a) {}
+    template<typename U> FrameAllocator(const FrameAllocator<U>& o) : arena(o.arena) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T* p, size_t n) { arena->deallocate(p, n * sizeof(T)); }
+
+    template<typename U> bool operator==(const FrameAllocator<U>& o) const { return arena == o.arena; }
+    template<typename U> bool operator!=(const FrameAllocator<U>& o) const { return arena != o.arena; }
+
+private:
+    template<typename U> friend class FrameAllocator;
+    FrameArena* arena;
+};
+
+template<typename T> using FrameVector = std::vector<T, FrameAllocator<T>>;
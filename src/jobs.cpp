@@ -0,0 +1,225 @@
+#include "jobs.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace jobs {
+namespace {
+
+thread_local bool tlsIsWorker = false;
+
+// Shared between the caller and helper tasks; helpers may outlive the call
+// (they wake up after the last chunk was taken), so it is reference counted.
+// Batches are recycled through a free list instead of being reallocated.
+struct Batch {
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> done{0};
+    std::atomic<int> refs{0};
+    size_t chunks = 0, count = 0, chunkSize = 0;
+    const RangeFn* fn = nullptr;
+    std::mutex m;
+    std::condition_variable cv;
+
+    void work() {
+        for (;;) {
+            size_t c = next.fetch_add(1);
+            if (c >= chunks) return;
+            size_t b = c * chunkSize, e = std::min(count, b + chunkSize);
+            (*fn)(b, e);
+            if (done.fetch_add(1) + 1 == chunks) {
+                std::lock_guard<std::mutex> lk(m);
+                cv.notify_all();
+            }
+        }
+    }
+};
+
+struct Pool {
+    std::vector<std::thread> threads;
+    // FIFO ring of pending tasks; unlike a deque it stops allocating once it
+    // has grown to the deepest queue seen
+    std::vector<std::function<void()>> queue;
+    size_t head = 0, queued = 0;
+    std::mutex m;
+    std::condition_variable cv;
+    bool quit = false;
+
+    std::vector<std::unique_ptr<Batch>> batches;
+    std::vector<Batch*> freeBatches;
+    std::mutex batchMutex;
+
+    Pool() {
+        unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned i = 1; i < hw; ++i) threads.emplace_back([this]{ run(); });
+    }
+    ~Pool() {
+        { std::lock_guard<std::mutex> lk(m); quit = true; }
+        cv.notify_all();
+        for (auto& t : threads) t.join();
+    }
+    void run() {
+        tlsIsWorker = true;
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lk(m);
+                cv.wait(lk, [&]{ return quit || queued > 0; });
+                if (quit && queued == 0) return;
+                task = std::move(queue[head]);
+                head = (head + 1) % queue.size(); --queued;
+            }
+            task();
+        }
+    }
+    void push(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lk(m);
+            if (queued == queue.size()) {
+                std::rotate(queue.begin(), queue.begin() + head, queue.end());
+                head = 0;
+                queue.resize(std::max<size_t>(16, queue.size() * 2));
+            }
+            queue[(head + queued) % queue.size()] = std::move(task);
+            ++queued;
+        }
+        cv.notify_one();
+    }
+};
+
+Pool& pool() { static Pool p; return p; }
+
+// The cache lives in the pool so it is destroyed only after the workers exit
+Batch* acquireBatch(int refs) {
+    Pool& p = pool();
+    Batch* b;
+    {
+        std::lock_guard<std::mutex> lk(p.batchMutex);
+        if (p.freeBatches.empty()) {
+            p.batches.push_back(std::make_unique<Batch>());
+            p.freeBatches.reserve(p.batches.size());
+            b = p.batches.back().get();
+        } else {
+            b = p.freeBatches.back(); p.freeBatches.pop_back();
+        }
+    }
+    b->next = 0; b->done = 0; b->refs = refs;
+    return b;
+}
+
+void releaseBatch(Batch* b) {
+    if (b->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+    Pool& p = pool();
+    std::lock_guard<std::mutex> lk(p.batchMutex);
+    p.freeBatches.push_back(b);
+}
+
+} // namespace
+
+unsigned threadCount() { return (unsigned)pool().threads.size() + 1; }
+
+void parallelFor(size_t count, size_t grain, RangeFn fn) {
+    if (count == 0) return;
+    grain = std::max<size_t>(grain, 1);
+    unsigned threads = threadCount();
+    if (tlsIsWorker || threads == 1 || count <= grain) { fn(0, count); return; }
+
+    size_t chunks = std::min<size_t>((count + grain - 1) / grain, (size_t)threads * 4);
+    size_t chunkSize = (count + chunks - 1) / chunks;
+    chunks = (count + chunkSize - 1) / chunkSize;
+    size_t helpers = std::min<size_t>(chunks - 1, threads - 1);
+
+    Batch* batch = acquireBatch((int)helpers + 1);
+    batch->count = count;
+    batch->chunkSize = chunkSize;
+    batch->chunks = chunks;
+    batch->fn = &fn;
+
+    for (size_t i = 0; i < helpers; ++i) pool().push([batch]{ batch->work(); releaseBatch(batch); });
+    batch->work();
+
+    {
+        std::unique_lock<std::mutex> lk(batch->m);
+        batch->cv.wait(lk, [&]{ return batch->done.load() == batch->chunks; });
+    }
+    releaseBatch(batch);
+}
+
+int TaskGraph::add(std::string name, std::function<void()> fn, std::vector<int> deps, Where where) {
+    int id = (int)tasks.size();
+    Task t; t.name = std::move(name); t.fn = std::move(fn); t.where = where;
+    t.pending = (int)deps.size();
+    tasks.push_back(std::move(t));
+    for (int d : deps) tasks[d].dependents.push_back(id);
+    return id;
+}
+
+// Called with m held
+void TaskGraph::start(int id) {
+    Task& t = tasks[id];
+    // With no pool threads everything runs on the caller
+    if (t.where == Main || threadCount() == 1) { mainReady.push_back(id); cv.notify_one(); return; }
+    pool().push([this, id] {
+        Task& t = tasks[id];
+        // Graph tasks are long and few; let their parallelFor calls fan out
+        bool wasWorker = tlsIsWorker;
+        tlsIsWorker = false;
+        t.startMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        t.fn();
+        t.endMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        tlsIsWorker = wasWorker;
+        finished(id);
+    });
+}
+
+void TaskGraph::finished(int id) {
+    std::lock_guard<std::mutex> lk(m);
+    for (int d : tasks[id].dependents)
+        if (--tasks[d].pending == 0) start(d);
+    if (--remaining == 0) cv.notify_all();
+}
+
+void TaskGraph::run() {
+    t0 = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lk(m);
+    remaining = (int)tasks.size();
+    for (int i = 0; i < (int)tasks.size(); ++i)
+        if (tasks[i].pending == 0) start(i);
+    while (remaining > 0) {
+        cv.wait(lk, [&]{ return remaining == 0 || !mainReady.empty(); });
+        if (mainReady.empty()) break;
+        int id = mainReady.front(); mainReady.pop_front();
+        lk.unlock();
+        Task& t = tasks[id];
+        t.startMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        t.fn();
+        t.endMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        finished(id);
+        lk.lock();
+    }
+    wall = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+void TaskGraph::printTimeline(std::ostream& os) const {
+    std::vector<const Task*> order;
+    for (const auto& t : tasks) order.push_back(&t);
+    std::sort(order.begin(), order.end(), [](const Task* a, const Task* b){ return a->startMs < b->startMs; });
+    const int cols = 40;
+    double scale = wall > 0.0 ? cols / wall : 0.0;
+    auto flags = os.flags(); auto prec = os.precision();
+    os << std::fixed << std::setprecision(1);
+    for (const Task* t : order) {
+        int b = std::min(cols - 1, (int)(t->startMs * scale)), e = std::max(b + 1, std::min(cols, (int)(t->endMs * scale + 0.5)));
+        os << "  " << std::setw(7) << t->startMs << " -" << std::setw(7) << t->endMs << " ms  "
+           << (t->where == Main || threadCount() == 1 ? "main  " : "worker") << " |"
+           << std::string(b, ' ') << std::string(e - b, '#') << std::string(cols - e, ' ') << "| " << t->name << "\n";
+    }
+    os.flags(flags); os.precision(prec);
+}
+
+} // namespace jobs
@@ -0,0 +1,73 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// ===========================================================
+// Tiny persistent worker pool for data-parallel loops
+// ===========================================================
+namespace jobs {
+
+// Number of threads that take part in a parallelFor (workers + caller).
+unsigned threadCount();
+
+// Non-owning reference to a fn(begin, end) callable. parallelFor runs every
+// frame, and wrapping a capturing lambda in std::function can allocate.
+class RangeFn {
+public:
+    template<typename F, typename = std::enable_if_t<!std::is_same<std::decay_t<F>, RangeFn>::value>>
+    RangeFn(const F& f) : obj(&f), call([](const void* o, size_t b, size_t e) { (*static_cast<const F*>(o))(b, e); }) {}
+    void operator()(size_t b, size_t e) const { call(obj, b, e); }
+
+private:
+    const void* obj;
+    void (*call)(const void*, size_t, size_t);
+};
+
+// Splits [0,count) into chunks of at least `grain` items and runs fn(begin,end)
+// on the pool; the caller participates and returns once every chunk is done.
+// Small ranges and calls made from inside a worker run inline. Does not
+// allocate once the pool has warmed up.
+void parallelFor(size_t count, size_t grain, RangeFn fn);
+
+// One-shot dependency graph. Worker tasks go to the pool as soon as their
+// dependencies finish; Main tasks (anything touching GL) run on the thread
+// that calls run(), interleaved with the workers. Tasks may use parallelFor.
+class TaskGraph {
+public:
+    enum Where { Worker, Main };
+    int add(std::string name, std::function<void()> fn, std::vector<int> deps = {}, Where where = Worker);
+    void run();
+    // Start/end of every task relative to run(), in start order
+    void printTimeline(std::ostream& os) const;
+    double wallMs() const { return wall; }
+
+private:
+    struct Task {
+        std::string name;
+        std::function<void()> fn;
+        std::vector<int> dependents;
+        int pending = 0;
+        Where where = Worker;
+        double startMs = 0.0, endMs = 0.0;
+    };
+    void finished(int id);
+    void start(int id);
+
+    std::vector<Task> tasks;
+    std::deque<int> mainReady;
+    int remaining = 0;
+    std::mutex m;
+    std::condition_variable cv;
+    std::chrono::steady_clock::time_point t0;
+    double wall = 0.0;
+};
+
+} // namespace jobs
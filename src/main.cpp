@@ -3,8 +3,15 @@
 #include <random>
 #include <cmath>
 #include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <fstream>
+#include <iterator>
+#include <map>
 #include <sstream>
+#include <chrono>
+#include <cstdlib>
+#include <string>
 
 #ifdef __APPLE__
   #define GL_SILENCE_DEPRECATION
@@ -18,6 +25,22 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "alloc_stats.h"
+#include "capture.h"
+#include "caustics.h"
+#include "fish_shm.h"
+#include "frame_arena.h"
+#include "jobs.h"
+#include "mem_registry.h"
+#include "meshes.h"
+#include "particles.h"
+#include "scene_config.h"
+#include "school.h"
+#include "sim_thread.h"
+#include "snapshot.h"
+#include "tank.h"
+#include "water_sim.h"
+
 // ===========================================================
 // Window/camera/controls
 // ===========================================================
@@ -39,44 +62,290 @@ static glm::vec3 orbitCenter(0.0f, 0.0f, 0.0f);
 static bool paused = false;
 static float timeScale = 1.0f;
 
+// ===========================================================
+// Per-frame scratch memory
+// ===========================================================
+// Render-thread temporaries (fish instance staging) come from this
+// arena and are dropped by the reset at the top of each frame. The window
+// title reports the operator new calls that still happen per frame.
+static FrameArena frameArena(4 << 20);
+static const int ALLOC_WARMUP_FRAMES = 120;   // pools and caches fill up first
+
 // ===========================================================
 // HDR render targets & screen triangle
 // ===========================================================
 static GLuint hdrFBO = 0, hdrColorTex = 0, hdrDepthRBO = 0, opaqueCopyTex = 0;
 static GLuint screenVAO = 0;
 
-static void createOrResizeHDR() {
-    if (!hdrFBO) glGenFramebuffers(1, &hdrFBO);
-    if (!hdrColorTex) glGenTextures(1, &hdrColorTex);
-    if (!opaqueCopyTex) glGenTextures(1, &opaqueCopyTex);
-    if (!hdrDepthRBO) glGenRenderbuffers(1, &hdrDepthRBO);
+// GL_R11F_G11F_B10F halves the bytes of GL_RGBA16F; the HDR target's alpha is
+// never read (blending only uses source alpha). Refraction is low-frequency,
+// so water.frag samples a downscaled blit of the opaque scene instead of a
+// full-resolution copy.
+static GLenum hdrFormat = GL_R11F_G11F_B10F;
+static float refractionScale = 0.5f;
+static GLuint refractFBO = 0;
+static GLenum hdrAllocFormat = 0;
+static int hdrAllocW = 0, hdrAllocH = 0, refrAllocW = 0, refrAllocH = 0;
+static int refrW = 1, refrH = 1;   // region of opaqueCopyTex written each frame
+static int renderW = 1, renderH = 1; // region of hdrColorTex rendered each frame
+
+static int hdrBytesPerPixel(GLenum fmt) { return fmt == GL_RGBA16F ? 8 : 4; }
+
+// Sizes for the memory registry, from the formats the app allocates
+static size_t texelBytes(GLenum internal) {
+    switch (internal) {
+        case GL_RGBA32F: return 16;
+        case GL_RGBA16F: return 8;
+        case GL_R8:      return 1;
+        default:         return 4;   // R11F_G11F_B10F, RG16F, DEPTH24_STENCIL8
+    }
+}
+static size_t mipChainTexels(int w, int h) {
+    size_t n = 0;
+    for (;;) {
+        n += (size_t)w * h;
+        if (w == 1 && h == 1) return n;
+        w = std::max(1, w / 2); h = std::max(1, h / 2);
+    }
+}
 
-    glBindTexture(GL_TEXTURE_2D, hdrColorTex);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCR_W, SCR_H, 0, GL_RGBA, GL_HALF_FLOAT, nullptr);
+// Targets are sized for the window and only reallocated when they must grow,
+// shrink by more than half or change format; dynamic resolution renders into
+// the corner of the storage.
+static bool targetNeedsRealloc(int allocW, int allocH, int w, int h) {
+    return w > allocW || h > allocH || w*2 < allocW || h*2 < allocH;
+}
+static void allocColorTarget(GLuint tex, int w, int h) {
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexImage2D(GL_TEXTURE_2D, 0, hdrFormat, w, h, 0, hdrFormat == GL_RGBA16F ? GL_RGBA : GL_RGB, GL_HALF_FLOAT, nullptr);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+static void createOrResizeHDR() {
+    if (SCR_W <= 0 || SCR_H <= 0) return;   // minimized: keep what we have
+    if (!hdrFBO) glGenFramebuffers(1, &hdrFBO);
+    if (!refractFBO) glGenFramebuffers(1, &refractFBO);
+    if (!hdrColorTex) glGenTextures(1, &hdrColorTex);
+    if (!opaqueCopyTex) glGenTextures(1, &opaqueCopyTex);
+    if (!hdrDepthRBO) glGenRenderbuffers(1, &hdrDepthRBO);
+    bool formatChanged = hdrFormat != hdrAllocFormat;
+    hdrAllocFormat = hdrFormat;
 
-    glBindTexture(GL_TEXTURE_2D, opaqueCopyTex);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCR_W, SCR_H, 0, GL_RGBA, GL_HALF_FLOAT, nullptr);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    if (formatChanged || targetNeedsRealloc(hdrAllocW, hdrAllocH, SCR_W, SCR_H)) {
+        hdrAllocW = SCR_W; hdrAllocH = SCR_H;
+        allocColorTarget(hdrColorTex, hdrAllocW, hdrAllocH);
+        glBindRenderbuffer(GL_RENDERBUFFER, hdrDepthRBO);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, hdrAllocW, hdrAllocH);
+        memreg::track(memreg::GPU, "HDR targets", "scene color", (size_t)hdrAllocW*hdrAllocH*texelBytes(hdrFormat));
+        memreg::track(memreg::GPU, "HDR targets", "scene depth/stencil", (size_t)hdrAllocW*hdrAllocH*texelBytes(GL_DEPTH24_STENCIL8));
 
-    glBindRenderbuffer(GL_RENDERBUFFER, hdrDepthRBO);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, SCR_W, SCR_H);
+        glBindFramebuffer(GL_FRAMEBUFFER, hdrFBO);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, hdrColorTex, 0);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, hdrDepthRBO);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cerr << "HDR FBO incomplete!\n";
+        }
+    }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, hdrFBO);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, hdrColorTex, 0);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, hdrDepthRBO);
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-        std::cerr << "HDR FBO incomplete!\n";
+    int rw = std::max(1, (int)(SCR_W * refractionScale)), rh = std::max(1, (int)(SCR_H * refractionScale));
+    if (formatChanged || targetNeedsRealloc(refrAllocW, refrAllocH, rw, rh)) {
+        refrAllocW = rw; refrAllocH = rh;
+        allocColorTarget(opaqueCopyTex, refrAllocW, refrAllocH);
+        memreg::track(memreg::GPU, "HDR targets", "refraction copy", (size_t)refrAllocW*refrAllocH*texelBytes(hdrFormat));
+        glBindFramebuffer(GL_FRAMEBUFFER, refractFBO);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, opaqueCopyTex, 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cerr << "Refraction FBO incomplete!\n";
+        }
     }
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
+// ===========================================================
+// GPU frame timing & dynamic resolution
+// ===========================================================
+// GL_TIME_ELAPSED queries in a small ring are read back a few frames late
+// without stalling. Each result is tagged with the scale it was rendered at,
+// so the controller can predict the cost at another scale (cost ~ area).
+static const int GPU_TIMER_RING = 4;
+static const float RENDER_SCALE_MIN = 0.5f, RENDER_SCALE_STEP = 1.0f / 64.0f;
+static GLuint gpuTimers[GPU_TIMER_RING] = {};
+static bool gpuTimerPending[GPU_TIMER_RING] = {};
+static float gpuTimerScale[GPU_TIMER_RING] = {};
+static int gpuTimerSlot = 0;
+static bool gpuTimerActive = false;
+static double gpuFrameMs = 0.0;     // latest completed measurement
+static float gpuBudgetMs = 14.0f;   // 0 disables dynamic resolution
+static float renderScale = 1.0f;
+
+static void adjustRenderScale(double ms, float measuredAt) {
+    if (gpuBudgetMs <= 0.0f) { renderScale = 1.0f; return; }
+    float target = renderScale;
+    float predicted = (float)ms * (renderScale / measuredAt) * (renderScale / measuredAt);
+    if (ms > gpuBudgetMs)                  target = measuredAt * std::sqrt(gpuBudgetMs / (float)ms);  // drop at once
+    else if (predicted < 0.85f*gpuBudgetMs) target = renderScale + 2.0f*RENDER_SCALE_STEP;           // creep back up
+    target = std::clamp(std::round(target / RENDER_SCALE_STEP) * RENDER_SCALE_STEP, RENDER_SCALE_MIN, 1.0f);
+    renderScale = target;
+}
+// Reads finished queries oldest first (the ring is filled in order from
+// gpuTimerSlot), stopping at the first one still in flight
+static void pollGpuTimers() {
+    for (int k=0;k<GPU_TIMER_RING;++k) {
+        int i = (gpuTimerSlot + k) % GPU_TIMER_RING;
+        if (!gpuTimerPending[i]) continue;
+        GLuint avail = 0;
+        glGetQueryObjectuiv(gpuTimers[i], GL_QUERY_RESULT_AVAILABLE, &avail);
+        if (!avail) break;
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(gpuTimers[i], GL_QUERY_RESULT, &ns);
+        gpuTimerPending[i] = false;
+        gpuFrameMs = (double)ns * 1e-6;
+        adjustRenderScale(gpuFrameMs, gpuTimerScale[i]);
+    }
+}
+// Starts timing this frame unless the ring is full of unread queries
+static void beginGpuTimer() {
+    if (!gpuTimers[0]) glGenQueries(GPU_TIMER_RING, gpuTimers);
+    pollGpuTimers();
+    gpuTimerActive = !gpuTimerPending[gpuTimerSlot];
+    if (!gpuTimerActive) return;
+    gpuTimerScale[gpuTimerSlot] = renderScale;
+    glBeginQuery(GL_TIME_ELAPSED, gpuTimers[gpuTimerSlot]);
+}
+static void endGpuTimer() {
+    if (!gpuTimerActive) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    gpuTimerPending[gpuTimerSlot] = true;
+    gpuTimerSlot = (gpuTimerSlot + 1) % GPU_TIMER_RING;
+}
+
+// ===========================================================
+// Video capture
+// ===========================================================
+// F9 or --capture file. After the tonemap, glReadPixels copies the back buffer
+// into one of CAPTURE_RING pixel-pack buffers, which returns at once, and a
+// fence marks when the copy is done. Buffers are mapped only once their fence
+// has signalled (normally two frames later, so frame N is read back while N+2
+// renders); the render thread then just memcpy()s into an encoder frame and
+// the FrameEncoder thread converts and writes it. Nothing ever waits: a frame
+// is dropped if all buffers are still in flight or the encoder is behind.
+static const int CAPTURE_RING = 3;
+static GLuint capturePBO[CAPTURE_RING] = {};
+static GLsync captureFence[CAPTURE_RING] = {};
+static int captureW[CAPTURE_RING] = {}, captureH[CAPTURE_RING] = {};
+static int captureHead = 0, capturePending = 0;   // in-flight slots, oldest first
+static size_t capturePBOBytes = 0;
+static FrameEncoder captureEncoder;
+static std::string capturePath = "aquarium.y4m";
+static int captureFps = 60;
+
+struct CaptureMetrics {
+    uint64_t frames = 0;        // render frames while capturing
+    uint64_t read = 0;          // frames handed to the encoder
+    uint64_t gpuBehind = 0;     // dropped: every PBO still in flight
+    uint64_t encoderBehind = 0; // dropped: no free encoder frame
+    double cpuMs = 0.0, cpuMaxMs = 0.0;   // render-thread cost of captureFrame()
+    uint64_t slowFrames = 0;    // frame intervals over 1.5x the capture frame time
+};
+static CaptureMetrics captureMetrics;
+
+// Maps the oldest in-flight readback into an encoder frame. With wait = false
+// it returns false instead of blocking on an unfinished copy.
+static bool collectCapture(bool wait) {
+    int slot = captureHead;
+    GLenum r = glClientWaitSync(captureFence[slot], wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? GL_TIMEOUT_IGNORED : 0);
+    if (r == GL_TIMEOUT_EXPIRED) return false;
+    glDeleteSync(captureFence[slot]);
+    captureFence[slot] = nullptr;
+    captureHead = (captureHead + 1) % CAPTURE_RING;
+    --capturePending;
+    int w = captureW[slot], h = captureH[slot];
+    CaptureFrame* f = captureEncoder.acquire(w, h);
+    if (!f) { ++captureMetrics.encoderBehind; return true; }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, capturePBO[slot]);
+    if (const void* px = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)w*h*4, GL_MAP_READ_BIT)) {
+        std::memcpy(f->rgba.data(), px, (size_t)w*h*4);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    captureEncoder.submit(f);
+    ++captureMetrics.read;
+    return true;
+}
+
+// Render thread, after the final pass into the default framebuffer
+static void captureFrame(int w, int h) {
+    auto t0 = std::chrono::steady_clock::now();
+    ++captureMetrics.frames;
+    while (capturePending > 0 && collectCapture(false)) {}
+    if (capturePending == CAPTURE_RING) {
+        ++captureMetrics.gpuBehind;
+    } else {
+        size_t bytes = (size_t)w*h*4;
+        if (bytes > capturePBOBytes) {
+            // First frame or the window grew: a one-off wait for the frames in flight
+            while (capturePending > 0) collectCapture(true);
+            if (!capturePBO[0]) glGenBuffers(CAPTURE_RING, capturePBO);
+            for (GLuint pbo : capturePBO) {
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+                glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)bytes, nullptr, GL_STREAM_READ);
+            }
+            capturePBOBytes = bytes;
+            memreg::track(memreg::GPU, "Capture", "readback PBO ring", CAPTURE_RING * bytes);
+        }
+        int slot = (captureHead + capturePending) % CAPTURE_RING;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, capturePBO[slot]);
+        glReadBuffer(GL_BACK);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glReadPixels(0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        captureFence[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        captureW[slot] = w; captureH[slot] = h;
+        ++capturePending;
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    captureMetrics.cpuMs += ms;
+    captureMetrics.cpuMaxMs = std::max(captureMetrics.cpuMaxMs, ms);
+}
+
+static bool startCapture() {
+    if (!captureEncoder.open(capturePath, captureFps)) return false;
+    captureMetrics = CaptureMetrics();
+    std::cout << "Capturing to " << capturePath << (captureEncoder.format() == FrameEncoder::Y4M ? " (Y4M 4:2:0)" : "_NNNNNN.ppm")
+              << " at " << captureFps << " fps" << std::endl;
+    return true;
+}
+// Collects what is still in flight, lets the encoder finish and prints the metrics
+static void stopCapture() {
+    if (!captureEncoder.isOpen()) return;
+    while (capturePending > 0) collectCapture(true);
+    captureEncoder.close();
+    const CaptureMetrics& m = captureMetrics;
+    CaptureStats st = captureEncoder.stats();
+    uint64_t n = std::max<uint64_t>(m.frames, 1);
+    std::cout << "Capture: " << st.written << " of " << m.frames << " frames written to " << capturePath
+              << " (" << st.bytes / (1024*1024) << " MB); dropped " << m.gpuBehind << " (GPU behind) + "
+              << m.encoderBehind << " (encoder behind)" << (st.skipped ? ", " + std::to_string(st.skipped) + " resized" : "") << "\n"
+              << "  render thread: " << m.cpuMs / n << " ms/frame, " << m.cpuMaxMs << " ms max; "
+              << m.slowFrames << " frames over " << 1500.0 / captureFps << " ms; encoder "
+              << st.encodeMs / std::max<uint64_t>(st.written, 1) << " ms/frame" << std::endl;
+}
+
+// Target memory and per-frame traffic of the HDR path at 4K, against the
+// previous layout (two full-size RGBA16F targets and a full-size copy).
+static void printHDRBudget() {
+    const double px = 3840.0 * 2160.0, MB = 1024.0 * 1024.0;
+    const double c = hdrBytesPerPixel(hdrFormat), s2 = refractionScale * refractionScale;
+    double memOld = px * (8 + 8 + 4), memNew = px * (c + 4) + px * s2 * c;
+    // refraction copy read + write, plus the tonemap read
+    double bwOld = px * (8 + 8 + 8), bwNew = px * (c + c * s2 + c);
+    std::cout << "HDR targets at 4K: " << (int)(memNew / MB) << " MB (was " << (int)(memOld / MB) << " MB), "
+              << "copy+tonemap traffic " << (int)(bwNew / MB) << " MB/frame (was " << (int)(bwOld / MB) << " MB/frame)"
+              << std::endl;
+}
+
 // ===========================================================
 // Input
 // ===========================================================
@@ -100,6 +369,14 @@ static void mouse_callback(GLFWwindow*, double xpos, double ypos) {
     front.z = std::sin(glm::radians(camYaw)) * std::cos(glm::radians(camPitch));
     camFront = glm::normalize(front);
 }
+// Edge-triggered key check: true only on the frame the key goes down
+static bool keyPressed(GLFWwindow* win, int key) {
+    static bool down[GLFW_KEY_LAST + 1] = {};
+    bool now = glfwGetKey(win, key) == GLFW_PRESS;
+    bool hit = now && !down[key];
+    down[key] = now;
+    return hit;
+}
 static void process_input(GLFWwindow* win, float dt) {
     float speed = (glfwGetKey(win, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS) ? 6.0f : 3.0f;
     float vel = speed * dt;
@@ -150,958 +427,1037 @@ static std::string loadFile(const char* path) {
 // ===========================================================
 // Geometry
 // ===========================================================
-struct Mesh { GLuint vao=0, vbo=0, ebo=0; GLsizei idxCount=0; };
-
-// Create a proper fish mesh with good visibility
-static Mesh createFishMesh() {
-    struct V { glm::vec3 p,n; };
-    std::vector<V> v; std::vector<unsigned> idx;
-    auto push = [&](const glm::vec3& p, const glm::vec3& n){ v.push_back({p, glm::normalize(n)}); };
-
-    const int segX=24, segR=16;
-    const float rMax=0.08f, zFlatten=0.7f; // Larger and more visible
-    for (int i=0; i<=segX; ++i) {
-        float t = (float)i / (float)segX;
-        float r = rMax * std::pow(std::sin(3.14159f * std::clamp(t*1.02f, 0.0f, 1.0f)), 0.75f);
-        if (i == 0) r *= 0.5f; // Head
-        if (i > segX * 0.8f) r *= 0.6f; // Tail taper
-        for (int j=0; j<=segR; ++j) {
-            float a = (2.0f * 3.14159f) * (float)j / (float)segR;
-            float cy = std::cos(a), sy = std::sin(a);
-            glm::vec3 p = { t * 0.25f, r * cy, zFlatten * r * sy }; // Scale down length
-            glm::vec3 n = { 0.0f, cy, (1.0f / zFlatten) * sy };
-            push(p, n);
-        }
-    }
-    int ring = segR + 1;
-    for (int i=0; i<segX; ++i) for (int j=0; j<segR; ++j) {
-        unsigned a = i*ring + j, b=a+1, c=(i+1)*ring + j, d=c+1;
-        idx.insert(idx.end(), {a,c,b, b,c,d});
-    }
+// Every static mesh shares one vertex buffer and one index buffer (MeshVertex
+// layout); a Mesh is just its range in them, drawn with the BaseVertex calls so
+// indices stay mesh-local. Switching meshes then costs no buffer or VAO binds.
+struct Mesh { GLint baseVertex=0; GLsizei firstIndex=0, idxCount=0; };
+
+static struct {
+    GLuint vbo=0, ebo=0;
+    std::vector<MeshVertex> v;    // staged until uploadMeshArena(), then released
+    std::vector<unsigned> idx;
+} meshArena;
 
-    // Add nose cap
-    glm::vec3 nose = {0.0f, 0.0f, 0.0f};
-    unsigned baseCenter = (unsigned)v.size();
-    v.push_back({nose, glm::vec3(-1,0,0)});
-    for (int j=0; j<segR; ++j) { 
-        unsigned a=j, b=(j+1)%segR; 
-        idx.insert(idx.end(), {baseCenter, a, b}); 
+// Appends a mesh built by meshes.cpp to the staging buffers (main thread only).
+// Index-less meshes (raw OBJ triangle soup) get a sequential index range.
+static Mesh addToMeshArena(const char* name, const MeshData& d) {
+    Mesh m;
+    m.baseVertex = (GLint)meshArena.v.size();
+    m.firstIndex = (GLsizei)meshArena.idx.size();
+    meshArena.v.insert(meshArena.v.end(), d.v.begin(), d.v.end());
+    if (!d.idx.empty()) meshArena.idx.insert(meshArena.idx.end(), d.idx.begin(), d.idx.end());
+    else for (unsigned i=0;i<(unsigned)d.v.size();++i) meshArena.idx.push_back(i);
+    m.idxCount = (GLsizei)meshArena.idx.size() - m.firstIndex;
+    memreg::track(memreg::GPU, "Static meshes", name, d.v.size()*sizeof(MeshVertex) + (size_t)m.idxCount*sizeof(unsigned));
+    return m;
+}
+
+// Binds the arena's position/normal attributes (0, 1) and index buffer into the current VAO.
+static void bindMeshArenaAttribs() {
+    glBindBuffer(GL_ARRAY_BUFFER, meshArena.vbo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, meshArena.ebo);
+    glEnableVertexAttribArray(0); glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,sizeof(MeshVertex),(void*)0);
+    glEnableVertexAttribArray(1); glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,sizeof(MeshVertex),(void*)offsetof(MeshVertex,n));
+}
+
+static void uploadMeshArena() {
+    glGenBuffers(1,&meshArena.vbo); glBindBuffer(GL_ARRAY_BUFFER,meshArena.vbo);
+    glBufferData(GL_ARRAY_BUFFER, meshArena.v.size()*sizeof(MeshVertex), meshArena.v.data(), GL_STATIC_DRAW);
+    glGenBuffers(1,&meshArena.ebo); glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,meshArena.ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, meshArena.idx.size()*sizeof(unsigned), meshArena.idx.data(), GL_STATIC_DRAW);
+    std::cout << "Mesh arena: " << meshArena.v.size() << " vertices, " << meshArena.idx.size() << " indices ("
+              << (meshArena.v.size()*sizeof(MeshVertex) + meshArena.idx.size()*sizeof(unsigned)) / 1024 << " KB)" << std::endl;
+    meshArena.v = std::vector<MeshVertex>(); meshArena.idx = std::vector<unsigned>();
+}
+
+// Draw with whichever arena-backed instancing VAO is bound
+static int meshDrawCalls = 0;   // this frame, shown in the window title
+static void drawMeshInstanced(const Mesh& m, GLsizei instances) {
+    ++meshDrawCalls;
+    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, m.idxCount, GL_UNSIGNED_INT, (void*)(sizeof(unsigned)*m.firstIndex), instances, m.baseVertex);
+}
+
+// Screen-space grid for the water surface: only UVs, water.vert maps them
+// across the surface's screen rectangle and projects them onto the water plane.
+struct GridMesh { GLuint vao=0, vbo=0, ebo=0; GLsizei idxCount=0; };
+static GridMesh makeWaterGrid(int nx, int ny) {
+    std::vector<glm::vec2> v; v.reserve((nx+1)*(ny+1));
+    for (int y=0; y<=ny; ++y) for (int x=0; x<=nx; ++x) v.push_back(glm::vec2((float)x/nx, (float)y/ny));
+    std::vector<unsigned> idx; idx.reserve(nx*ny*6);
+    for (int y=0; y<ny; ++y) for (int x=0; x<nx; ++x) {
+        unsigned a = y*(nx+1)+x, b=a+1, c=a+(nx+1), d=c+1;
+        idx.insert(idx.end(), {a,b,c, b,d,c});
     }
-    
-    // Add tail fin
-    float x = 0.26f;
-    glm::vec3 tU = {x,  0.12f,  0.0f}, tD = {x, -0.12f,  0.0f};
-    glm::vec3 baseL = {0.22f,  0.03f,  0.02f}, baseR = {0.22f, -0.03f,  0.02f};
-    glm::vec3 baseL2= {0.22f,  0.03f, -0.02f}, baseR2= {0.22f, -0.03f, -0.02f};
-    unsigned s = (unsigned)v.size();
-    v.push_back({tU,{0,0, 1}}); v.push_back({tD,{0,0, 1}}); v.push_back({baseL,{0,0, 1}}); v.push_back({baseR,{0,0, 1}});
-    v.push_back({tU,{0,0,-1}}); v.push_back({tD,{0,0,-1}}); v.push_back({baseL2,{0,0,-1}}); v.push_back({baseR2,{0,0,-1}});
-    idx.insert(idx.end(), {s+2,s+0,s+1,  s+2,s+1,s+3});
-    idx.insert(idx.end(), {s+5,s+7,s+4,  s+5,s+6,s+7});
-
-    Mesh m; glGenVertexArrays(1,&m.vao); glBindVertexArray(m.vao);
+    GridMesh m; glGenVertexArrays(1,&m.vao); glBindVertexArray(m.vao);
     glGenBuffers(1,&m.vbo); glBindBuffer(GL_ARRAY_BUFFER,m.vbo);
-    glBufferData(GL_ARRAY_BUFFER, v.size()*sizeof(V), v.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, v.size()*sizeof(glm::vec2), v.data(), GL_STATIC_DRAW);
     glGenBuffers(1,&m.ebo); glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,m.ebo);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, idx.size()*sizeof(unsigned), idx.data(), GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0); glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,sizeof(V),(void*)0);
-    glEnableVertexAttribArray(1); glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,sizeof(V),(void*)offsetof(V,n));
-    
-    // Set up instancing attributes
-    glEnableVertexAttribArray(3); glVertexAttribPointer(3,3,GL_FLOAT,GL_FALSE,15*sizeof(float),(void*)0);                 glVertexAttribDivisor(3,1);
-    glEnableVertexAttribArray(4); glVertexAttribPointer(4,3,GL_FLOAT,GL_FALSE,15*sizeof(float),(void*)(3*sizeof(float)));  glVertexAttribDivisor(4,1);
-    glEnableVertexAttribArray(5); glVertexAttribPointer(5,2,GL_FLOAT,GL_FALSE,15*sizeof(float),(void*)(6*sizeof(float)));  glVertexAttribDivisor(5,1);
-    glEnableVertexAttribArray(6); glVertexAttribPointer(6,3,GL_FLOAT,GL_FALSE,15*sizeof(float),(void*)(8*sizeof(float)));  glVertexAttribDivisor(6,1);
-    glEnableVertexAttribArray(7); glVertexAttribPointer(7,3,GL_FLOAT,GL_FALSE,15*sizeof(float),(void*)(11*sizeof(float))); glVertexAttribDivisor(7,1);
-    glEnableVertexAttribArray(8); glVertexAttribPointer(8,1,GL_FLOAT,GL_FALSE,15*sizeof(float),(void*)(14*sizeof(float))); glVertexAttribDivisor(8,1);
-    
+    glEnableVertexAttribArray(2); glVertexAttribPointer(2,2,GL_FLOAT,GL_FALSE,sizeof(glm::vec2),(void*)0);
     m.idxCount=(GLsizei)idx.size();
+    memreg::track(memreg::GPU, "Water", "projected grid", v.size()*sizeof(glm::vec2) + idx.size()*sizeof(unsigned));
     glBindVertexArray(0); return m;
 }
 
-// Simple OBJ loader with better error reporting
-static Mesh loadOBJModel(const std::string& filename) {
-    std::cout << "Attempting to load: " << filename << std::endl;
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "ERROR: Failed to open OBJ file: " << filename << std::endl;
-        std::cerr << "Current working directory should contain: fish.obj, koi_fish.obj, bream_fish__dorade_royale.obj, fish_animated.obj" << std::endl;
-        std::cerr << "Using fallback procedural mesh instead." << std::endl;
-        return createFishMesh(); // Use our procedural fish mesh as fallback
+// ===========================================================
+// Tanks
+// ===========================================================
+// Every tank owns its population, decorations and bubbles (tank.h) and steps
+// as an independent shard. Rendering packs all tanks into the same instance
+// streams, offset by each tank's origin, so the draw calls per frame do not
+// grow with the tank count. The water surface and snapshots belong to tank 0;
+// the other tanks share its water texture for caustics.
+static std::vector<Tank> tanks(1);
+static const glm::vec2 TANK_SPACING(6.0f, 4.0f);   // tank box is 5.0 x 3.0, plus an aisle
+
+// Populations come from the scene file (see configureTanks)
+static SceneConfig scene = defaultSceneConfig();
+
+static void configureTanks(int count) {
+    tanks.assign(count, Tank());
+    for (int i=0;i<count;++i) {
+        Tank& t = tanks[i];
+        t.origin = tankGridOrigin(i, count, TANK_SPACING);
+        t.waterY = scene.waterY;
+        t.rng.seed(tankSeed(i));
     }
-    
-    std::vector<glm::vec3> positions;
-    std::vector<glm::vec3> normals;
-    std::vector<unsigned> indices;
-    
-    std::string line;
-    while (std::getline(file, line)) {
-        std::istringstream iss(line);
-        std::string type;
-        iss >> type;
-        
-        if (type == "v") {
-            float x, y, z;
-            iss >> x >> y >> z;
-            positions.push_back(glm::vec3(x, y, z));
-        } else if (type == "vn") {
-            float x, y, z;
-            iss >> x >> y >> z;
-            normals.push_back(glm::normalize(glm::vec3(x, y, z)));
-        } else if (type == "f") {
-            std::string vertex;
-            for (int i = 0; i < 3; ++i) {
-                iss >> vertex;
-                std::istringstream viss(vertex);
-                std::string index_str;
-                std::vector<int> indices_vertex;
-                
-                while (std::getline(viss, index_str, '/')) {
-                    if (index_str.empty()) {
-                        indices_vertex.push_back(0);
-                    } else {
-                        indices_vertex.push_back(std::stoi(index_str) - 1);
-                    }
-                }
-                
-                while (indices_vertex.size() < 3) {
-                    indices_vertex.push_back(0);
-                }
-                
-                indices.push_back(indices_vertex[0]);
-            }
+}
+
+// ===========================================================
+// Species/instances
+// ===========================================================
+static GLuint vboClown=0, vboNeon=0, vboDanio=0, vboAngelfish=0, vboGoldfish=0, vboBetta=0, vboGuppy=0, vboPlaty=0;
+static GLuint* const speciesVBOs[8] = { &vboClown, &vboNeon, &vboDanio, &vboAngelfish, &vboGoldfish, &vboBetta, &vboGuppy, &vboPlaty };
+static int fishDrawn[8] = {};   // instances in each VBO, set on upload
+
+static Mesh fishMesh, clownfishMesh, angelfishMesh, animatedFishMesh, plantMesh, glassTankMesh, tankBaseMesh, waterVolumeMesh, floorMesh, rockMesh, coralMesh, shellMesh, driftwoodMesh, anemoneMesh, starfishMesh, kelpMesh, treasureChestMesh, foodMesh;
+static const Mesh* const speciesMeshes[8] = {
+    &clownfishMesh,     // Koi model - orange/red
+    &fishMesh,          // Generic - blue
+    &fishMesh,          // Generic - yellow
+    &angelfishMesh,     // Bream model - silver
+    &animatedFishMesh,  // Animated - gold
+    &fishMesh,          // Generic - purple
+    &fishMesh,          // Generic - cyan
+    &fishMesh,          // Generic - pink
+};
+static GLuint speciesVAOs[8] = {};
+
+// Fish of species s across all tanks
+static int fishCount(int s) {
+    size_t n = 0;
+    for (const Tank& t : tanks) n += t.fish[s].size();
+    return (int)n;
+}
+// Tank after tank, each moved to its origin
+static void packFish(int s, float* out) {
+    for (const Tank& t : tanks) {
+        packFishInstances(t.fish[s], out, t.origin);
+        out += t.fish[s].size()*FISH_INSTANCE_FLOATS;
+    }
+}
+
+// One VAO per species: arena geometry plus that species' instance stream
+// (attribs 3-8). Species that share a model still need their own VAO, since
+// the instance buffer is part of the VAO state.
+static void setupFishInstancing(int s, int count) {
+    GLuint& instVBO = *speciesVBOs[s];
+    if (!instVBO) glGenBuffers(1, &instVBO);
+    if (!speciesVAOs[s]) glGenVertexArrays(1, &speciesVAOs[s]);
+    glBindVertexArray(speciesVAOs[s]);
+    bindMeshArenaAttribs();
+    glBindBuffer(GL_ARRAY_BUFFER, instVBO);
+    glBufferData(GL_ARRAY_BUFFER, count * (sizeof(float)*15), nullptr, GL_DYNAMIC_DRAW);
+    memreg::track(memreg::GPU, "Instance buffers", std::string("fish: ") + scene.species[s].name, (size_t)count*sizeof(float)*15);
+    glEnableVertexAttribArray(3); glVertexAttribPointer(3,3,GL_FLOAT,GL_FALSE,sizeof(float)*15,(void*)0);                 glVertexAttribDivisor(3,1);
+    glEnableVertexAttribArray(4); glVertexAttribPointer(4,3,GL_FLOAT,GL_FALSE,sizeof(float)*15,(void*)(sizeof(float)*3));  glVertexAttribDivisor(4,1);
+    glEnableVertexAttribArray(5); glVertexAttribPointer(5,2,GL_FLOAT,GL_FALSE,sizeof(float)*15,(void*)(sizeof(float)*6));  glVertexAttribDivisor(5,1);
+    glEnableVertexAttribArray(6); glVertexAttribPointer(6,3,GL_FLOAT,GL_FALSE,sizeof(float)*15,(void*)(sizeof(float)*8));  glVertexAttribDivisor(6,1);
+    glEnableVertexAttribArray(7); glVertexAttribPointer(7,3,GL_FLOAT,GL_FALSE,sizeof(float)*15,(void*)(sizeof(float)*11)); glVertexAttribDivisor(7,1);
+    glEnableVertexAttribArray(8); glVertexAttribPointer(8,1,GL_FLOAT,GL_FALSE,sizeof(float)*15,(void*)(sizeof(float)*14)); glVertexAttribDivisor(8,1);
+    glBindVertexArray(0);
+}
+
+static void setupAllFishInstancing() {
+    for (int s=0;s<SPECIES_COUNT;++s) setupFishInstancing(s, fishCount(s));
+    std::fill(std::begin(fishDrawn), std::end(fishDrawn), 0);
+}
+static void uploadFish(int s, const float* inst, int count) {
+    glBindBuffer(GL_ARRAY_BUFFER, *speciesVBOs[s]);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, (size_t)count*FISH_INSTANCE_FLOATS*sizeof(float), inst);
+    fishDrawn[s] = count;
+}
+
+// ===========================================================
+// Decorations, plants & tank pieces
+// ===========================================================
+// Static placements of every tank, built once (and again after a snapshot
+// load). basic.vert reads DECOR_INSTANCE_FLOATS per instance from decorVBO at
+// attribs 3-5; each batch is a contiguous range drawn with one instanced call.
+// GL 4.1 has no baseInstance, so the attribute pointers are re-aimed at a
+// batch's first instance before its draw.
+static const int DECOR_INSTANCE_FLOATS = 11;   // pos(3) scale, rotY color(3), tank origin(3)
+static const int PLANT_INSTANCE_FLOATS = 8;    // pos(3) height/phase(2) color(3); the shape comes from the stalk nodes
+
+struct DecorBatch { const Mesh* mesh = nullptr; int material = 0; bool caustics = false; GLint first = 0; GLsizei count = 0; };
+static DecorBatch tankBaseBatch, floorBatch, waterVolumeBatch, glassBatch;
+static DecorBatch decorBatches[DECOR_KINDS];   // KELP stays empty: kelp is drawn with the plants
+
+struct DecorStyle { DecorKind kind; const Mesh* mesh; int material; };
+static const DecorStyle decorStyles[] = {
+    {ROCKS,     &rockMesh,          1},
+    {CORALS,    &coralMesh,         2},
+    {SHELLS,    &shellMesh,         3},
+    {DRIFTWOOD, &driftwoodMesh,     4},
+    {ANEMONES,  &anemoneMesh,       8},
+    {STARFISH,  &starfishMesh,      9},
+    {CHESTS,    &treasureChestMesh, 10},
+};
+static glm::vec3 decorColor(DecorKind k, int i, int n) {
+    float f = (float)i / n;
+    switch (k) {
+        case ROCKS:     return glm::vec3(0.35f+0.12f*f, 0.30f, 0.26f);
+        case CORALS:    return glm::vec3(0.8f+0.2f*f, 0.3f+0.2f*f, 0.4f+0.3f*f);
+        case SHELLS:    return glm::vec3(0.9f+0.1f*f, 0.85f+0.1f*f, 0.7f+0.2f*f);
+        case DRIFTWOOD: return glm::vec3(0.4f+0.2f*f, 0.25f+0.1f*f, 0.15f+0.1f*f);
+        case ANEMONES:  return glm::vec3(0.8f + 0.2f*std::sin(f*6.28f), 0.4f + 0.3f*std::cos(f*4.0f), 0.6f + 0.4f*std::sin(f*8.0f));
+        case STARFISH:  return glm::vec3(0.9f + 0.1f*f, 0.5f + 0.3f*f, 0.3f + 0.2f*f);
+        default:        return glm::vec3(0.6f, 0.4f, 0.2f);   // Bronze/gold chests
+    }
+}
+
+static GLuint decorVBO=0, decorVAO=0;   // decorVAO: arena geometry + decoration instances (attribs 3-5)
+static GLuint plantVBO=0, plantVAO=0;   // plantVAO: arena geometry + plant instances (attribs 8-10)
+static GLsizei plantsDrawn = 0, kelpDrawn = 0;
+// Chain nodes of every stalk (StalkSystem) for plant.vert to skin against: a
+// texture buffer of STALK_NODES xyz texels per stalk, in plantVBO's instance
+// order (plants of every tank, then kelp of every tank). Streamed every step.
+static GLuint stalkBuffer=0, stalkTex=0;
+static size_t stalkBufferFloats = 0;
+static const float PLANT_MESH_HEIGHT = 0.6f, KELP_MESH_HEIGHT = 0.8f;   // makePlantStrip() / makeKelp() defaults
+
+static void buildTankInstances() {
+    std::vector<float> data;
+    auto begin = [&](DecorBatch& b, const Mesh& m, int material, bool caustics) {
+        b.mesh = &m; b.material = material; b.caustics = caustics;
+        b.first = (GLint)(data.size() / DECOR_INSTANCE_FLOATS);
+    };
+    auto push = [&](const Tank& t, glm::vec3 p, float scale, float rotY, glm::vec3 col) {
+        p += t.origin;
+        data.insert(data.end(), { p.x, p.y, p.z, scale, rotY, col.r, col.g, col.b, t.origin.x, t.origin.y, t.origin.z });
+    };
+    auto end = [&](DecorBatch& b) { b.count = (GLsizei)(data.size() / DECOR_INSTANCE_FLOATS) - b.first; };
+
+    begin(tankBaseBatch, tankBaseMesh, 6, false);   // Wood/base material
+    for (const Tank& t : tanks) push(t, glm::vec3(0.0f, -1.8f, 0.0f), 1.0f, 0.0f, glm::vec3(0.4f, 0.25f, 0.15f));
+    end(tankBaseBatch);
+    begin(floorBatch, floorMesh, 0, true);          // Sand
+    for (const Tank& t : tanks) push(t, glm::vec3(0.0f), 1.0f, 0.0f, glm::vec3(0.78f, 0.72f, 0.52f));
+    end(floorBatch);
+    for (const DecorStyle& st : decorStyles) {
+        DecorBatch& b = decorBatches[st.kind];
+        begin(b, *st.mesh, st.material, false);
+        for (const Tank& t : tanks) {
+            const auto& v = t.decor[st.kind];
+            for (size_t i=0;i<v.size();++i)
+                push(t, glm::vec3(v[i]), v[i].w, decorYaw(st.kind, (int)i), decorColor(st.kind, (int)i, (int)v.size()));
         }
+        end(b);
     }
-    
-    if (positions.empty()) {
-        std::cerr << "ERROR: No vertices found in OBJ file: " << filename << std::endl;
-        return createFishMesh();
+    begin(waterVolumeBatch, waterVolumeMesh, 7, true);   // Beautiful blue water
+    for (const Tank& t : tanks) push(t, glm::vec3(0.0f), 1.0f, 0.0f, glm::vec3(0.1f, 0.5f, 0.9f));
+    end(waterVolumeBatch);
+    begin(glassBatch, glassTankMesh, 5, false);          // Almost pure white glass
+    for (const Tank& t : tanks) push(t, glm::vec3(0.0f), 1.0f, 0.0f, glm::vec3(0.98f, 0.99f, 1.0f));
+    end(glassBatch);
+
+    glBindBuffer(GL_ARRAY_BUFFER, decorVBO);
+    glBufferData(GL_ARRAY_BUFFER, data.size()*sizeof(float), data.data(), GL_STATIC_DRAW);
+    memreg::track(memreg::GPU, "Instance buffers", "decorations & tank pieces", data.size()*sizeof(float));
+
+    // Plants of every tank, then kelp of every tank. Kelp colours and phases
+    // come from a fixed seed so they are stable from frame to frame.
+    std::vector<float> plants;
+    std::mt19937 kelpRng(11u);
+    std::uniform_real_distribution<float> u01(0.0f, 1.0f);
+    plantsDrawn = 0; kelpDrawn = 0;
+    for (const Tank& t : tanks) {
+        for (size_t i=0;i<t.plantPos.size();++i) {
+            glm::vec3 p = t.plantPos[i] + t.origin;
+            plants.insert(plants.end(), { p.x, p.y, p.z, t.plantHP[i].x, t.plantHP[i].y, t.plantColor[i].r, t.plantColor[i].g, t.plantColor[i].b });
+        }
+        plantsDrawn += (GLsizei)t.plantPos.size();
     }
-    
-    // Scale to appropriate size for aquarium - make them quite large and visible
-    float scale = 0.15f; // Larger scale for better visibility
-    
-    std::cout << "SUCCESS: Loaded " << filename << " with " << positions.size() << " vertices, " << indices.size() << " indices" << std::endl;
-    
-    struct V { glm::vec3 p, n; };
-    std::vector<V> vertices;
-    
-    for (size_t i = 0; i < positions.size(); ++i) {
-        V v;
-        v.p = positions[i] * scale;
-        v.n = (i < normals.size()) ? normals[i] : glm::vec3(0, 1, 0);
-        vertices.push_back(v);
+    for (const Tank& t : tanks) {
+        for (const glm::vec4& k : t.decor[KELP]) {
+            glm::vec3 p = glm::vec3(k) + t.origin;
+            float phase = u01(kelpRng)*6.28f;
+            float r = 0.1f + 0.15f*u01(kelpRng), g = 0.4f + 0.3f*u01(kelpRng);
+            plants.insert(plants.end(), { p.x, p.y, p.z, k.w, phase, r, g, 0.1f });   // height and phase, kelp colors
+        }
+        kelpDrawn += (GLsizei)t.decor[KELP].size();
     }
-    
-    Mesh m;
-    glGenVertexArrays(1, &m.vao);
-    glBindVertexArray(m.vao);
-    
-    glGenBuffers(1, &m.vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, m.vbo);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(V), vertices.data(), GL_STATIC_DRAW);
-    
-    if (!indices.empty()) {
-        glGenBuffers(1, &m.ebo);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m.ebo);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned), indices.data(), GL_STATIC_DRAW);
-        m.idxCount = (GLsizei)indices.size();
-    } else {
-        m.idxCount = (GLsizei)vertices.size();
+    glBindBuffer(GL_ARRAY_BUFFER, plantVBO);
+    glBufferData(GL_ARRAY_BUFFER, plants.size()*sizeof(float), plants.data(), GL_STATIC_DRAW);
+    memreg::track(memreg::GPU, "Instance buffers", "plants & kelp", plants.size()*sizeof(float));
+}
+
+static size_t stalkFloats() {
+    size_t n = 0;
+    for (const Tank& t : tanks) n += (size_t)t.stalks.count();
+    return n*STALK_NODES*3;
+}
+static void packStalks(float* out) {
+    for (const Tank& t : tanks) {
+        int n = (int)t.plantPos.size();
+        t.stalks.pack(out, 0, n, t.origin);
+        out += (size_t)n*STALK_NODES*3;
     }
-    
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(V), (void*)0);
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(V), (void*)offsetof(V, n));
-    
-    // Set up instancing attributes
-    glEnableVertexAttribArray(3); glVertexAttribPointer(3,3,GL_FLOAT,GL_FALSE,15*sizeof(float),(void*)0);                 glVertexAttribDivisor(3,1);
-    glEnableVertexAttribArray(4); glVertexAttribPointer(4,3,GL_FLOAT,GL_FALSE,15*sizeof(float),(void*)(3*sizeof(float)));  glVertexAttribDivisor(4,1);
-    glEnableVertexAttribArray(5); glVertexAttribPointer(5,2,GL_FLOAT,GL_FALSE,15*sizeof(float),(void*)(6*sizeof(float)));  glVertexAttribDivisor(5,1);
-    glEnableVertexAttribArray(6); glVertexAttribPointer(6,3,GL_FLOAT,GL_FALSE,15*sizeof(float),(void*)(8*sizeof(float)));  glVertexAttribDivisor(6,1);
-    glEnableVertexAttribArray(7); glVertexAttribPointer(7,3,GL_FLOAT,GL_FALSE,15*sizeof(float),(void*)(11*sizeof(float))); glVertexAttribDivisor(7,1);
-    glEnableVertexAttribArray(8); glVertexAttribPointer(8,1,GL_FLOAT,GL_FALSE,15*sizeof(float),(void*)(14*sizeof(float))); glVertexAttribDivisor(8,1);
-    
-    glBindVertexArray(0);
-    return m;
+    for (const Tank& t : tanks) {
+        int first = (int)t.plantPos.size(), n = (int)t.decor[KELP].size();
+        t.stalks.pack(out, first, n, t.origin);
+        out += (size_t)n*STALK_NODES*3;
+    }
+}
+static void uploadStalks(const float* data, size_t floats) {
+    if (floats == 0) return;
+    glBindBuffer(GL_TEXTURE_BUFFER, stalkBuffer);
+    if (floats > stalkBufferFloats) {
+        stalkBufferFloats = floats;
+        memreg::track(memreg::GPU, "Instance buffers", "plant & kelp nodes", stalkBufferFloats*sizeof(float));
+    }
+    // Orphan then fill; the texture follows the buffer's new storage
+    glBufferData(GL_TEXTURE_BUFFER, stalkBufferFloats*sizeof(float), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_TEXTURE_BUFFER, 0, floats*sizeof(float), data);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
 }
 
-static Mesh makeBox(float w, float h, float d) {
-    float x=w*0.5f, y=h*0.5f, z=d*0.5f;
-    struct V { glm::vec3 p,n; };
-    std::vector<V> v; std::vector<unsigned> i;
-    auto addQuad=[&](glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 d, glm::vec3 n){
-        size_t base=v.size();
-        v.push_back({a,n}); v.push_back({b,n}); v.push_back({c,n}); v.push_back({d,n});
-        i.insert(i.end(), { (unsigned)base,(unsigned)base+2,(unsigned)base+1,
-                            (unsigned)base,(unsigned)base+3,(unsigned)base+2 });
-    };
-    addQuad({-x,-y, z},{ x,-y, z},{ x, y, z},{-x, y, z}, { 0, 0,-1});
-    addQuad({ x,-y,-z},{-x,-y,-z},{-x, y,-z},{ x, y,-z}, { 0, 0, 1});
-    addQuad({-x,-y,-z},{-x,-y, z},{-x, y, z},{-x, y,-z}, { 1, 0, 0});
-    addQuad({ x,-y, z},{ x,-y,-z},{ x, y,-z},{ x, y, z}, {-1, 0, 0});
-    addQuad({-x, y, z},{ x, y, z},{ x, y,-z},{-x, y,-z}, { 0,-1, 0});
-    Mesh m; glGenVertexArrays(1,&m.vao); glBindVertexArray(m.vao);
-    glGenBuffers(1,&m.vbo); glBindBuffer(GL_ARRAY_BUFFER,m.vbo);
-    glBufferData(GL_ARRAY_BUFFER, v.size()*sizeof(V), v.data(), GL_STATIC_DRAW);
-    glGenBuffers(1,&m.ebo); glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,m.ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, i.size()*sizeof(unsigned), i.data(), GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0); glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,sizeof(V),(void*)0);
-    glEnableVertexAttribArray(1); glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,sizeof(V),(void*)offsetof(V,n));
-    m.idxCount=(GLsizei)i.size();
-    glBindVertexArray(0);
-    return m;
+// Points attribs 3-5 of decorVAO (bound) at instance `first`
+static void aimDecorInstances(GLint first) {
+    const GLsizei stride = sizeof(float)*DECOR_INSTANCE_FLOATS;
+    const size_t o = (size_t)first*stride;
+    glBindBuffer(GL_ARRAY_BUFFER, decorVBO);
+    glVertexAttribPointer(3,4,GL_FLOAT,GL_FALSE,stride,(void*)o);
+    glVertexAttribPointer(4,4,GL_FLOAT,GL_FALSE,stride,(void*)(o + sizeof(float)*4));
+    glVertexAttribPointer(5,3,GL_FLOAT,GL_FALSE,stride,(void*)(o + sizeof(float)*8));
+}
+// Points attribs 8-10 of plantVAO (bound) at instance `first`
+static void aimPlantInstances(GLint first) {
+    const GLsizei stride = sizeof(float)*PLANT_INSTANCE_FLOATS;
+    const size_t o = (size_t)first*stride;
+    glBindBuffer(GL_ARRAY_BUFFER, plantVBO);
+    glVertexAttribPointer(8,3,GL_FLOAT,GL_FALSE,stride,(void*)o);
+    glVertexAttribPointer(9,2,GL_FLOAT,GL_FALSE,stride,(void*)(o + sizeof(float)*3));
+    glVertexAttribPointer(10,3,GL_FLOAT,GL_FALSE,stride,(void*)(o + sizeof(float)*5));
 }
 
-static Mesh makeGlassTank(float w, float h, float d, float thickness = 0.05f) {
-    float x=w*0.5f, y=h*0.5f, z=d*0.5f;
-    float t=thickness;
-    struct V { glm::vec3 p,n; };
-    std::vector<V> v; std::vector<unsigned> i;
-    auto addQuad=[&](glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 d, glm::vec3 n){
-        size_t base=v.size();
-        v.push_back({a,n}); v.push_back({b,n}); v.push_back({c,n}); v.push_back({d,n});
-        i.insert(i.end(), { (unsigned)base,(unsigned)base+2,(unsigned)base+1,
-                            (unsigned)base,(unsigned)base+3,(unsigned)base+2 });
-    };
-    
-    // Bottom glass panel (exterior)
-    addQuad({-x,-y-t,-z},{ x,-y-t,-z},{ x,-y-t, z},{-x,-y-t, z}, { 0, 1, 0});
-    // Bottom glass panel (interior)  
-    addQuad({-x,-y,-z},{-x,-y, z},{ x,-y, z},{ x,-y,-z}, { 0,-1, 0});
-    
-    // Left wall (exterior)
-    addQuad({-x-t,-y-t,-z},{-x-t, y,-z},{-x-t, y, z},{-x-t,-y-t, z}, { 1, 0, 0});
-    // Left wall (interior)
-    addQuad({-x,-y,-z},{-x,-y, z},{-x, y, z},{-x, y,-z}, {-1, 0, 0});
-    
-    // Right wall (exterior)
-    addQuad({ x+t,-y-t, z},{ x+t, y, z},{ x+t, y,-z},{ x+t,-y-t,-z}, {-1, 0, 0});
-    // Right wall (interior)
-    addQuad({ x,-y, z},{ x, y, z},{ x, y,-z},{ x,-y,-z}, { 1, 0, 0});
-    
-    // Front wall (exterior)
-    addQuad({-x-t,-y-t, z-t},{ x+t,-y-t, z-t},{ x+t, y, z-t},{-x-t, y, z-t}, { 0, 0,-1});
-    // Front wall (interior)
-    addQuad({-x,-y, z},{ x,-y, z},{ x, y, z},{-x, y, z}, { 0, 0, 1});
-    
-    // Back wall (exterior)
-    addQuad({ x+t,-y-t,-z-t},{-x-t,-y-t,-z-t},{-x-t, y,-z-t},{ x+t, y,-z-t}, { 0, 0, 1});
-    // Back wall (interior)
-    addQuad({ x,-y,-z},{-x,-y,-z},{-x, y,-z},{ x, y,-z}, { 0, 0,-1});
-    
-    Mesh m; glGenVertexArrays(1,&m.vao); glBindVertexArray(m.vao);
-    glGenBuffers(1,&m.vbo); glBindBuffer(GL_ARRAY_BUFFER,m.vbo);
-    glBufferData(GL_ARRAY_BUFFER, v.size()*sizeof(V), v.data(), GL_STATIC_DRAW);
-    glGenBuffers(1,&m.ebo); glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,m.ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, i.size()*sizeof(unsigned), i.data(), GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0); glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,sizeof(V),(void*)0);
-    glEnableVertexAttribArray(1); glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,sizeof(V),(void*)offsetof(V,n));
-    m.idxCount=(GLsizei)i.size();
+static void setupTankInstancing() {
+    if (!decorVBO) glGenBuffers(1, &decorVBO);
+    if (!plantVBO) glGenBuffers(1, &plantVBO);
+    glGenVertexArrays(1, &decorVAO); glBindVertexArray(decorVAO);
+    bindMeshArenaAttribs();
+    for (int a=3;a<=5;++a) { glEnableVertexAttribArray(a); glVertexAttribDivisor(a,1); }
+    aimDecorInstances(0);
+    glGenVertexArrays(1, &plantVAO); glBindVertexArray(plantVAO);
+    bindMeshArenaAttribs();
+    for (int a=8;a<=10;++a) { glEnableVertexAttribArray(a); glVertexAttribDivisor(a,1); }
+    aimPlantInstances(0);
     glBindVertexArray(0);
-    return m;
+    buildTankInstances();
+
+    glGenBuffers(1, &stalkBuffer);
+    glGenTextures(1, &stalkTex);
+    std::vector<float> nodes(stalkFloats());
+    packStalks(nodes.data());
+    uploadStalks(nodes.data(), nodes.size());
+    glBindTexture(GL_TEXTURE_BUFFER, stalkTex);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGB32F, stalkBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
 }
 
-static Mesh makeWaterVolume(float w, float h, float d, float waterLevel = 0.9f) {
-    float x=w*0.5f*0.95f, y=h*waterLevel*0.5f, z=d*0.5f*0.95f; // Slightly smaller than tank interior
-    float bottom = -h*0.5f + 0.02f; // Just above tank bottom
-    struct V { glm::vec3 p,n; };
-    std::vector<V> v; std::vector<unsigned> i;
-    auto addQuad=[&](glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 d, glm::vec3 n){
-        size_t base=v.size();
-        v.push_back({a,n}); v.push_back({b,n}); v.push_back({c,n}); v.push_back({d,n});
-        i.insert(i.end(), { (unsigned)base,(unsigned)base+1,(unsigned)base+2,
-                            (unsigned)base,(unsigned)base+2,(unsigned)base+3 });
-    };
-    
-    // Water volume faces (all inward-facing normals for proper transparency)
-    addQuad({-x,bottom,-z},{ x,bottom,-z},{ x,bottom, z},{-x,bottom, z}, { 0, 1, 0}); // Bottom
-    addQuad({-x,bottom,-z},{-x, y,-z},{-x, y, z},{-x,bottom, z}, { 1, 0, 0}); // Left
-    addQuad({ x,bottom, z},{ x, y, z},{ x, y,-z},{ x,bottom,-z}, {-1, 0, 0}); // Right  
-    addQuad({-x,bottom, z},{-x, y, z},{ x, y, z},{ x,bottom, z}, { 0, 0,-1}); // Front
-    addQuad({ x,bottom,-z},{ x, y,-z},{-x, y,-z},{-x,bottom,-z}, { 0, 0, 1}); // Back
-    addQuad({-x, y, z},{ x, y, z},{ x, y,-z},{-x, y,-z}, { 0,-1, 0}); // Top (water surface)
-    
-    Mesh m; glGenVertexArrays(1,&m.vao); glBindVertexArray(m.vao);
-    glGenBuffers(1,&m.vbo); glBindBuffer(GL_ARRAY_BUFFER,m.vbo);
-    glBufferData(GL_ARRAY_BUFFER, v.size()*sizeof(V), v.data(), GL_STATIC_DRAW);
-    glGenBuffers(1,&m.ebo); glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,m.ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, i.size()*sizeof(unsigned), i.data(), GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0); glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,sizeof(V),(void*)0);
-    glEnableVertexAttribArray(1); glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,sizeof(V),(void*)offsetof(V,n));
-    m.idxCount=(GLsizei)i.size();
-    glBindVertexArray(0);
-    return m;
+// ===========================================================
+// Bubbles
+// ===========================================================
+// Each tank's pool (air stones plus a vent on each chest, see tank.h) is
+// packed into one stream, tank after tank.
+static std::vector<float> bubbleUpload;
+static GLuint bubbleVBO = 0, bubbleVAO = 0;
+
+static int bubblesDrawn = 0;
+
+// Stateless mode: bubbles.vert derives every bubble from gl_VertexID and time,
+// so there is no vertex buffer, no CPU update and no upload. The emitters of
+// every tank share one uniform array, so they are capped over all tanks.
+// Toggled by the render thread, read by the simulation thread.
+static std::atomic<bool> gpuBubbles{false};
+static const int GPU_BUBBLE_EMITTERS = 64;   // MAX_EMITTERS in bubbles.vert
+
+static int bubbleEmitterCount() {
+    int n = 0;
+    for (const Tank& t : tanks) n += (int)t.bubbles.emitters.size();
+    return n;
 }
+static GLuint gpuBubbleVAO = 0;   // no attributes, core profile still needs a VAO
 
-static Mesh makeTankBase(float w, float h, float d) {
-    float bw = w * 1.3f, bh = h * 0.15f, bd = d * 1.3f; // Base is wider and shorter
-    float x=bw*0.5f, y=bh*0.5f, z=bd*0.5f;
-    struct V { glm::vec3 p,n; };
-    std::vector<V> v; std::vector<unsigned> i;
-    auto addQuad=[&](glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 d, glm::vec3 n){
-        size_t base=v.size();
-        v.push_back({a,n}); v.push_back({b,n}); v.push_back({c,n}); v.push_back({d,n});
-        i.insert(i.end(), { (unsigned)base,(unsigned)base+2,(unsigned)base+1,
-                            (unsigned)base,(unsigned)base+3,(unsigned)base+2 });
-    };
-    
-    // All 6 faces of the base
-    addQuad({-x,-y, z},{ x,-y, z},{ x, y, z},{-x, y, z}, { 0, 0,-1}); // Front
-    addQuad({ x,-y,-z},{-x,-y,-z},{-x, y,-z},{ x, y,-z}, { 0, 0, 1}); // Back
-    addQuad({-x,-y,-z},{-x,-y, z},{-x, y, z},{-x, y,-z}, { 1, 0, 0}); // Left
-    addQuad({ x,-y, z},{ x,-y,-z},{ x, y,-z},{ x, y, z}, {-1, 0, 0}); // Right
-    addQuad({-x, y, z},{ x, y, z},{ x, y,-z},{-x, y,-z}, { 0,-1, 0}); // Top
-    addQuad({-x,-y,-z},{ x,-y,-z},{ x,-y, z},{-x,-y, z}, { 0, 1, 0}); // Bottom
-    
-    Mesh m; glGenVertexArrays(1,&m.vao); glBindVertexArray(m.vao);
-    glGenBuffers(1,&m.vbo); glBindBuffer(GL_ARRAY_BUFFER,m.vbo);
-    glBufferData(GL_ARRAY_BUFFER, v.size()*sizeof(V), v.data(), GL_STATIC_DRAW);
-    glGenBuffers(1,&m.ebo); glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,m.ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, i.size()*sizeof(unsigned), i.data(), GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0); glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,sizeof(V),(void*)0);
-    glEnableVertexAttribArray(1); glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,sizeof(V),(void*)offsetof(V,n));
-    m.idxCount=(GLsizei)i.size();
-    glBindVertexArray(0);
-    return m;
+// Slots across every tank's pool
+static size_t bubbleCapacity() {
+    size_t n = 0;
+    for (const Tank& t : tanks) n += t.bubbles.capacity();
+    return n;
 }
-static Mesh makeWaterPlane(int nx=120, int nz=120, float sx=3.2f, float sz=1.8f, float y=0.45f) {
-    struct V { glm::vec3 p; glm::vec2 uv; };
-    std::vector<V> v; v.reserve((nx+1)*(nz+1));
-    for (int z=0; z<=nz; ++z) for (int x=0; x<=nx; ++x) {
-        float u = (float)x/nx, w=(float)z/nz;
-        v.push_back({ glm::vec3((u-0.5f)*sx, y, (w-0.5f)*sz), glm::vec2(u,w) });
-    }
-    std::vector<unsigned> idx; idx.reserve(nx*nz*6);
-    for (int z=0; z<nz; ++z) for (int x=0; x<nx; ++x) {
-        unsigned a = z*(nx+1)+x, b=a+1, c=a+(nx+1), d=c+1;
-        idx.insert(idx.end(), {a,c,b, b,c,d});
+static size_t bubbleSlotsUsed() {
+    size_t n = 0;
+    for (const Tank& t : tanks) n += t.bubbles.used();
+    return n;
+}
+// Every tank's used slots back to back, moved to the tank's origin
+static void packBubbles(float* out) {
+    for (const Tank& t : tanks) {
+        t.bubbles.pack(out, t.origin);
+        out += (size_t)t.bubbles.used()*4;
     }
-    Mesh m; glGenVertexArrays(1,&m.vao); glBindVertexArray(m.vao);
-    glGenBuffers(1,&m.vbo); glBindBuffer(GL_ARRAY_BUFFER,m.vbo);
-    glBufferData(GL_ARRAY_BUFFER, v.size()*sizeof(V), v.data(), GL_STATIC_DRAW);
-    glGenBuffers(1,&m.ebo); glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,m.ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, idx.size()*sizeof(unsigned), idx.data(), GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0); glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,sizeof(V),(void*)0);
-    glEnableVertexAttribArray(2); glVertexAttribPointer(2,2,GL_FLOAT,GL_FALSE,sizeof(V),(void*)offsetof(V,uv));
-    m.idxCount=(GLsizei)idx.size();
-    glBindVertexArray(0); return m;
 }
-static Mesh makeFloor(float sx=3.2f, float sz=1.8f, float y=-0.9f) {
-    struct V { glm::vec3 p,n; };
-    std::vector<V> v = {
-        {{-sx*0.5f,y,-sz*0.5f},{0,1,0}},
-        {{ sx*0.5f,y,-sz*0.5f},{0,1,0}},
-        {{ sx*0.5f,y, sz*0.5f},{0,1,0}},
-        {{-sx*0.5f,y, sz*0.5f},{0,1,0}},
-    };
-    std::vector<unsigned> i = {0,1,2, 0,2,3};
-    Mesh m; glGenVertexArrays(1,&m.vao); glBindVertexArray(m.vao);
-    glGenBuffers(1,&m.vbo); glBindBuffer(GL_ARRAY_BUFFER,m.vbo);
-    glBufferData(GL_ARRAY_BUFFER, v.size()*sizeof(V), v.data(), GL_STATIC_DRAW);
-    glGenBuffers(1,&m.ebo); glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,m.ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, i.size()*sizeof(unsigned), i.data(), GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0); glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,sizeof(V),(void*)0);
-    glEnableVertexAttribArray(1); glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,sizeof(V),(void*)offsetof(V,n));
-    m.idxCount=(GLsizei)i.size();
-    glBindVertexArray(0); return m;
+
+static void initBubbles() {
+    for (size_t i=0;i<tanks.size();++i) initTankBubbles(tanks[i], scene, tankBubbleSeed((int)i));
+    bubbleUpload.resize(bubbleCapacity() * 4);
+
+    glGenVertexArrays(1,&bubbleVAO);
+    glBindVertexArray(bubbleVAO);
+    glGenBuffers(1,&bubbleVBO);
+    glBindBuffer(GL_ARRAY_BUFFER,bubbleVBO);
+    glBufferData(GL_ARRAY_BUFFER, bubbleUpload.size()*sizeof(float), nullptr, GL_STREAM_DRAW);
+    memreg::track(memreg::GPU, "Instance buffers", "bubbles", bubbleUpload.size()*sizeof(float));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,sizeof(float)*4,(void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1,1,GL_FLOAT,GL_FALSE,sizeof(float)*4,(void*)(sizeof(float)*3));
+    glBindVertexArray(0);
+
+    glGenVertexArrays(1,&gpuBubbleVAO);
+}
+static void uploadBubbles(const float* data, int n) {
+    bubblesDrawn = n;
+    if (n == 0) return;
+    // Orphan then fill only the slots in use
+    glBindBuffer(GL_ARRAY_BUFFER,bubbleVBO);
+    glBufferData(GL_ARRAY_BUFFER, bubbleUpload.size()*sizeof(float), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, (size_t)n*4*sizeof(float), data);
 }
 
-static Mesh makePlantStrip(int segments = 12, float height = 0.6f, float width = 0.027f) {
-    struct V { glm::vec3 p,n; };
-    std::vector<V> v;
-    std::vector<unsigned> idx;
-    
-    // Create 4 strips at different angles for 3D appearance
-    const int numStrips = 4;
-    for (int strip = 0; strip < numStrips; ++strip) {
-        float angle = (2.0f * 3.14159f) * (float)strip / (float)numStrips;
-        glm::vec3 stripDir = glm::vec3(std::cos(angle), 0.0f, std::sin(angle));
-        glm::vec3 stripNormal = glm::vec3(-std::sin(angle), 0.0f, std::cos(angle));
-        
-        int baseVertex = (int)v.size();
-        
-        for (int i=0;i<=segments;++i) {
-            float t = (float)i/segments;
-            float y = t * height;
-            float w = width * (0.7f + 0.3f * (1.0f - t));
-            float sway = 0.05f * std::sin(t * 6.0f) * t; // Natural plant sway
-            
-            glm::vec3 offset = stripDir * w * 0.5f;
-            glm::vec3 swayOffset = glm::vec3(sway, 0.0f, sway * 0.5f);
-            
-            v.push_back({glm::vec3(-offset.x + swayOffset.x, y, -offset.z + swayOffset.z), stripNormal});
-            v.push_back({glm::vec3( offset.x + swayOffset.x, y,  offset.z + swayOffset.z), stripNormal});
-            
-            if (i < segments) {
-                unsigned base = baseVertex + i*2;
-                idx.insert(idx.end(), {base, base+2, base+1,  base+1, base+2, base+3});
-                // Add back faces for proper 3D appearance
-                idx.insert(idx.end(), {base+1, base+2, base,  base+3, base+2, base+1});
-            }
-        }
-    }
-    
-    Mesh m; glGenVertexArrays(1,&m.vao); glBindVertexArray(m.vao);
-    glGenBuffers(1,&m.vbo); glBindBuffer(GL_ARRAY_BUFFER,m.vbo);
-    glBufferData(GL_ARRAY_BUFFER, v.size()*sizeof(V), v.data(), GL_STATIC_DRAW);
-    glGenBuffers(1,&m.ebo); glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,m.ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, idx.size()*sizeof(unsigned), idx.data(), GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0); glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,sizeof(V),(void*)0);
-    glEnableVertexAttribArray(1); glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,sizeof(V),(void*)offsetof(V,n));
-    m.idxCount=(GLsizei)idx.size();
-    glBindVertexArray(0); return m;
+// ===========================================================
+// Food
+// ===========================================================
+// F drops a feeding into every tank (FoodSystem, see food.h). Pellets are
+// drawn by basic.vert like the decorations, from their own stream:
+// DECOR_INSTANCE_FLOATS per pellet, tank after tank. Eaten pellets stay until
+// the next step removes them and are packed with scale 0.
+static std::atomic<int> feedRequests{0};   // set by the render thread, taken by the next step
+static GLuint foodVBO = 0, foodVAO = 0;
+static size_t foodVBOPellets = 0;
+static int foodDrawn = 0;   // pellets in foodVBO, set on upload
+
+static size_t foodCount() {
+    size_t n = 0;
+    for (const Tank& t : tanks) n += (size_t)t.food.count();
+    return n;
 }
-static Mesh makeRockDome(int rings=12, int sectors=18, float radius=0.22f) {
-    struct V { glm::vec3 p,n; };
-    std::vector<V> v; std::vector<unsigned> idx;
-    for (int r=0;r<=rings;++r) {
-        float vr = (float)r/rings;
-        float phi = (vr*0.5f)*3.14159f;
-        for (int s=0;s<=sectors;++s) {
-            float vs = (float)s/sectors;
-            float theta = vs*2.0f*3.14159f;
-            float x = radius*std::cos(theta)*std::sin(phi);
-            float y = radius*std::cos(phi);
-            float z = radius*std::sin(theta)*std::sin(phi);
-            glm::vec3 p(x,y,z), n = glm::normalize(glm::vec3(x, std::max(y, 1e-3f), z));
-            v.push_back({p,n});
+static void packFood(float* out) {
+    for (const Tank& t : tanks) {
+        const FoodSystem& f = t.food;
+        for (int i=0;i<f.count();++i) {
+            glm::vec3 p = glm::vec3(f.px[i], f.py[i], f.pz[i]) + t.origin;
+            float shade = 0.85f + 0.15f * std::sin(f.phase[i] * 3.0f);
+            *out++ = p.x; *out++ = p.y; *out++ = p.z; *out++ = f.eaten[i] ? 0.0f : 1.0f;
+            *out++ = f.phase[i]; *out++ = 0.75f * shade; *out++ = 0.42f * shade; *out++ = 0.18f * shade;
+            *out++ = t.origin.x; *out++ = t.origin.y; *out++ = t.origin.z;
         }
     }
-    int ring = sectors+1;
-    for (int r=0;r<rings;++r) for (int s=0;s<sectors;++s) {
-        unsigned a=r*ring+s, b=a+1, c=(r+1)*ring+s, d=c+1;
-        idx.insert(idx.end(), {a,c,b, b,c,d});
-    }
-    Mesh m; glGenVertexArrays(1,&m.vao); glBindVertexArray(m.vao);
-    glGenBuffers(1,&m.vbo); glBindBuffer(GL_ARRAY_BUFFER,m.vbo);
-    glBufferData(GL_ARRAY_BUFFER, v.size()*sizeof(V), v.data(), GL_STATIC_DRAW);
-    glGenBuffers(1,&m.ebo); glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,m.ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, idx.size()*sizeof(unsigned), idx.data(), GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0); glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,sizeof(V),(void*)0);
-    glEnableVertexAttribArray(1); glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,sizeof(V),(void*)offsetof(V,n));
-    m.idxCount=(GLsizei)idx.size();
-    glBindVertexArray(0); return m;
+}
+// Runs at the start of a step, on whichever thread steps the tanks
+static void feedTanks() {
+    for (int n = feedRequests.exchange(0); n > 0; --n)
+        for (Tank& t : tanks) feedTank(t, scene);
 }
 
-static Mesh makeCoral(int segments = 8, float height = 0.6f, float baseRadius = 0.15f) { // Increased height and radius
-    struct V { glm::vec3 p,n; };
-    std::vector<V> v; std::vector<unsigned> idx;
-    
-    for (int i=0; i<=segments; ++i) {
-        float t = (float)i/segments;
-        float y = t * height;
-        float radius = baseRadius * (1.0f - t * 0.2f) + 0.04f * std::sin(t * 8.0f); // Less taper, more visible
-        
-        for (int j=0; j<=12; ++j) { // More sides for rounder coral
-            float angle = (2.0f * 3.14159f) * (float)j / 12.0f;
-            float x = radius * std::cos(angle);
-            float z = radius * std::sin(angle);
-            
-            // Add some bumpy texture
-            float bumpiness = 1.0f + 0.2f * std::sin(angle * 4.0f) * std::cos(t * 6.0f);
-            x *= bumpiness;
-            z *= bumpiness;
-            
-            glm::vec3 p(x, y, z);
-            glm::vec3 n = glm::normalize(glm::vec3(x, 0.2f, z));
-            v.push_back({p, n});
-        }
-    }
-    
-    for (int i=0; i<segments; ++i) {
-        for (int j=0; j<12; ++j) {
-            unsigned a = i*13 + j, b = a+1, c = (i+1)*13 + j, d = c+1;
-            if (j == 11) { b = i*13; d = (i+1)*13; }
-            idx.insert(idx.end(), {a,c,b, b,c,d});
-        }
+static void initFood() {
+    for (size_t i=0;i<tanks.size();++i) initTankFood(tanks[i], scene, tankFoodSeed((int)i));
+    glGenBuffers(1, &foodVBO);
+    glGenVertexArrays(1, &foodVAO); glBindVertexArray(foodVAO);
+    bindMeshArenaAttribs();
+    const GLsizei stride = sizeof(float)*DECOR_INSTANCE_FLOATS;
+    glBindBuffer(GL_ARRAY_BUFFER, foodVBO);
+    for (int a=3;a<=5;++a) { glEnableVertexAttribArray(a); glVertexAttribDivisor(a,1); }
+    glVertexAttribPointer(3,4,GL_FLOAT,GL_FALSE,stride,(void*)0);
+    glVertexAttribPointer(4,4,GL_FLOAT,GL_FALSE,stride,(void*)(sizeof(float)*4));
+    glVertexAttribPointer(5,3,GL_FLOAT,GL_FALSE,stride,(void*)(sizeof(float)*8));
+    glBindVertexArray(0);
+}
+static void uploadFood(const float* data, int n) {
+    foodDrawn = n;
+    if (n == 0) return;
+    const size_t bytes = (size_t)n*DECOR_INSTANCE_FLOATS*sizeof(float);
+    glBindBuffer(GL_ARRAY_BUFFER, foodVBO);
+    if ((size_t)n > foodVBOPellets) {
+        foodVBOPellets = std::max((size_t)n, foodVBOPellets * 2);
+        memreg::track(memreg::GPU, "Instance buffers", "food", foodVBOPellets*DECOR_INSTANCE_FLOATS*sizeof(float));
     }
-    
-    Mesh m; glGenVertexArrays(1,&m.vao); glBindVertexArray(m.vao);
-    glGenBuffers(1,&m.vbo); glBindBuffer(GL_ARRAY_BUFFER,m.vbo);
-    glBufferData(GL_ARRAY_BUFFER, v.size()*sizeof(V), v.data(), GL_STATIC_DRAW);
-    glGenBuffers(1,&m.ebo); glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,m.ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, idx.size()*sizeof(unsigned), idx.data(), GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0); glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,sizeof(V),(void*)0);
-    glEnableVertexAttribArray(1); glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,sizeof(V),(void*)offsetof(V,n));
-    m.idxCount=(GLsizei)idx.size();
-    glBindVertexArray(0); return m;
+    // Orphan then fill only the pellets alive
+    glBufferData(GL_ARRAY_BUFFER, foodVBOPellets*DECOR_INSTANCE_FLOATS*sizeof(float), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, data);
 }
 
-static Mesh makeShell(float radius = 0.12f, float height = 0.08f) {
-    struct V { glm::vec3 p,n; };
-    std::vector<V> v; std::vector<unsigned> idx;
-    
-    const int rings = 6, sectors = 12;
-    for (int r=0; r<=rings; ++r) {
-        float vr = (float)r/rings;
-        float phi = vr * 3.14159f * 0.3f;
-        float r_radius = radius * (1.0f - vr * 0.3f);
-        
-        for (int s=0; s<=sectors; ++s) {
-            float vs = (float)s/sectors;
-            float theta = vs * 2.0f * 3.14159f;
-            float x = r_radius * std::cos(theta);
-            float y = height * std::sin(phi);
-            float z = r_radius * std::sin(theta);
-            
-            glm::vec3 p(x, y, z);
-            glm::vec3 n = glm::normalize(glm::vec3(x, 0.5f, z));
-            v.push_back({p, n});
-        }
+// ===========================================================
+// Water surface
+// ===========================================================
+// Heightfield over the water plane, disturbed by surfacing bubbles and by fish
+// swimming at the top. Streamed to waterTex for water.vert and the caustics in
+// basic.frag (texture unit WATER_TEX_UNIT, left bound for the whole frame).
+static WaterSim water;
+static GLuint waterTex = 0;
+static const int WATER_TEX_UNIT = 4;
+static const int CAUSTICS_TEX_UNIT = 5;
+static const float FISH_CONTACT_DEPTH = 0.15f;
+
+// Projected grid: one vertex every WATER_GRID_PX pixels over the surface's
+// screen rectangle, so the triangle count follows the resolution, not the tank.
+static const int WATER_GRID_PX = 8, WATER_GRID_MAX = 320;
+static GridMesh waterGrid;
+static int waterGridW = 0, waterGridH = 0;
+
+static void ensureWaterGrid() {
+    int w = std::clamp(SCR_W / WATER_GRID_PX, 16, WATER_GRID_MAX);
+    int h = std::clamp(SCR_H / WATER_GRID_PX, 16, WATER_GRID_MAX);
+    if (w == waterGridW && h == waterGridH) return;
+    if (waterGrid.vao) {
+        glDeleteVertexArrays(1,&waterGrid.vao);
+        glDeleteBuffers(1,&waterGrid.vbo); glDeleteBuffers(1,&waterGrid.ebo);
     }
-    
-    int ring = sectors+1;
-    for (int r=0; r<rings; ++r) {
-        for (int s=0; s<sectors; ++s) {
-            unsigned a = r*ring + s, b = a+1, c = (r+1)*ring + s, d = c+1;
-            idx.insert(idx.end(), {a,c,b, b,c,d});
+    waterGrid = makeWaterGrid(w, h);
+    waterGridW = w; waterGridH = h;
+}
+// NDC rectangle (min.xy, max.xy) covering the water surface; false if off-screen.
+// The surface rectangle is clipped to the near plane first, so the bounds only
+// cover where it is actually visible: every grid ray then hits the plane in
+// front of the camera instead of folding back over the horizon.
+static bool waterScreenBounds(const glm::mat4& viewProj, float eyeY, glm::vec4& ndc) {
+    glm::vec4 rc = water.rect();
+    glm::vec2 lo(rc.x, rc.y), hi = lo + glm::vec2(1.0f/rc.z, 1.0f/rc.w);
+    // Headroom for displaced crests, but never up to the eye's height: past it
+    // the band would reach over the horizon
+    const float swell = 0.05f, waterY = tanks[0].waterY;
+    float below = swell, above = swell;
+    if (eyeY < waterY) below = std::min(swell, 0.5f * (waterY - eyeY));
+    else               above = std::min(swell, 0.5f * (eyeY - waterY));
+    glm::vec2 mn(1e9f), mx(-1e9f);
+    for (float y : { waterY - below, waterY + above }) {
+        const glm::vec4 quad[4] = { viewProj * glm::vec4(lo.x, y, lo.y, 1.0f), viewProj * glm::vec4(hi.x, y, lo.y, 1.0f),
+                                    viewProj * glm::vec4(hi.x, y, hi.y, 1.0f), viewProj * glm::vec4(lo.x, y, hi.y, 1.0f) };
+        // Sutherland-Hodgman against z >= -w (in front of the near plane)
+        for (int i=0;i<4;++i) {
+            const glm::vec4& a = quad[i];
+            const glm::vec4& b = quad[(i+1)%4];
+            float da = a.z + a.w, db = b.z + b.w;
+            glm::vec4 pts[2]; int n = 0;
+            if (da >= 0.0f) pts[n++] = a;
+            if ((da >= 0.0f) != (db >= 0.0f)) pts[n++] = a + (b - a) * (da / (da - db));
+            for (int k=0;k<n;++k) {
+                glm::vec2 p = glm::vec2(pts[k].x, pts[k].y) / std::max(pts[k].w, 1e-6f);
+                mn = glm::min(mn, p); mx = glm::max(mx, p);
+            }
         }
     }
-    
-    Mesh m; glGenVertexArrays(1,&m.vao); glBindVertexArray(m.vao);
-    glGenBuffers(1,&m.vbo); glBindBuffer(GL_ARRAY_BUFFER,m.vbo);
-    glBufferData(GL_ARRAY_BUFFER, v.size()*sizeof(V), v.data(), GL_STATIC_DRAW);
-    glGenBuffers(1,&m.ebo); glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,m.ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, idx.size()*sizeof(unsigned), idx.data(), GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0); glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,sizeof(V),(void*)0);
-    glEnableVertexAttribArray(1); glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,sizeof(V),(void*)offsetof(V,n));
-    m.idxCount=(GLsizei)idx.size();
-    glBindVertexArray(0); return m;
+    mn = glm::max(mn, glm::vec2(-1.0f)); mx = glm::min(mx, glm::vec2(1.0f));
+    if (mn.x >= mx.x || mn.y >= mx.y) return false;
+    ndc = glm::vec4(mn.x, mn.y, mx.x, mx.y);
+    return true;
 }
 
-static Mesh makeDriftwood(int segments = 6, float length = 0.3f, float radius = 0.04f) {
-    struct V { glm::vec3 p,n; };
-    std::vector<V> v; std::vector<unsigned> idx;
-    
-    for (int i=0; i<=segments; ++i) {
-        float t = (float)i/segments;
-        float x = t * length;
-        float r = radius * (1.0f - t * 0.4f);
-        
-        for (int j=0; j<=8; ++j) {
-            float angle = (2.0f * 3.14159f) * (float)j / 8.0f;
-            float y = r * std::cos(angle);
-            float z = r * std::sin(angle);
-            
-            glm::vec3 p(x, y, z);
-            glm::vec3 n = glm::normalize(glm::vec3(0.1f, y, z));
-            v.push_back({p, n});
-        }
-    }
-    
-    for (int i=0; i<segments; ++i) {
-        for (int j=0; j<8; ++j) {
-            unsigned a = i*9 + j, b = a+1, c = (i+1)*9 + j, d = c+1;
-            if (j == 7) { b = i*9; d = (i+1)*9; }
-            idx.insert(idx.end(), {a,c,b, b,c,d});
-        }
-    }
-    
-    Mesh m; glGenVertexArrays(1,&m.vao); glBindVertexArray(m.vao);
-    glGenBuffers(1,&m.vbo); glBindBuffer(GL_ARRAY_BUFFER,m.vbo);
-    glBufferData(GL_ARRAY_BUFFER, v.size()*sizeof(V), v.data(), GL_STATIC_DRAW);
-    glGenBuffers(1,&m.ebo); glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,m.ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, idx.size()*sizeof(unsigned), idx.data(), GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0); glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,sizeof(V),(void*)0);
-    glEnableVertexAttribArray(1); glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,sizeof(V),(void*)offsetof(V,n));
-    m.idxCount=(GLsizei)idx.size();
-    glBindVertexArray(0); return m;
+static void uploadWater(const float* texels) {
+    int r = water.resolution();
+    glActiveTexture(GL_TEXTURE0 + WATER_TEX_UNIT);
+    glBindTexture(GL_TEXTURE_2D, waterTex);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, r, r, GL_RGBA, GL_FLOAT, texels);
+    glActiveTexture(GL_TEXTURE0);
+}
+static void initWater(float sx, float sz) {
+    water.init(scene.waterResolution, -sx*0.5f, -sz*0.5f, sx, sz);
+    int r = water.resolution();
+    glGenTextures(1,&waterTex);
+    glActiveTexture(GL_TEXTURE0 + WATER_TEX_UNIT);
+    glBindTexture(GL_TEXTURE_2D, waterTex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, r, r, 0, GL_RGBA, GL_FLOAT, water.texels());
+    memreg::track(memreg::GPU, "Water", "heightfield texture", (size_t)r*r*texelBytes(GL_RGBA32F));
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glActiveTexture(GL_TEXTURE0);
 }
 
-static Mesh makeAnemone(int segments = 16, float height = 0.25f, float baseRadius = 0.06f) {
-    struct V { glm::vec3 p,n; };
-    std::vector<V> v; std::vector<unsigned> idx;
-    
-    // Central body
-    for (int i=0; i<=segments; ++i) {
-        float t = (float)i/segments;
-        float y = t * height * 0.6f;
-        float radius = baseRadius * (1.0f - t * 0.2f);
-        
-        for (int j=0; j<=12; ++j) {
-            float angle = (2.0f * 3.14159f) * (float)j / 12.0f;
-            float x = radius * std::cos(angle);
-            float z = radius * std::sin(angle);
-            
-            glm::vec3 p(x, y, z);
-            glm::vec3 n = glm::normalize(glm::vec3(x, 0.2f, z));
-            v.push_back({p, n});
-        }
-    }
-    
-    // Tentacles
-    int bodyVerts = (int)v.size();
-    for (int t=0; t<8; ++t) {
-        float tentacleAngle = (2.0f * 3.14159f) * (float)t / 8.0f;
-        float baseX = baseRadius * 0.8f * std::cos(tentacleAngle);
-        float baseZ = baseRadius * 0.8f * std::sin(tentacleAngle);
-        
-        for (int i=0; i<=6; ++i) {
-            float s = (float)i / 6.0f;
-            float tentacleHeight = height * 0.6f + s * height * 0.4f;
-            float sway = 0.1f * std::sin(s * 6.0f) * std::cos(tentacleAngle * 2.0f);
-            
-            glm::vec3 p(baseX + sway, tentacleHeight, baseZ + sway);
-            glm::vec3 n = glm::normalize(glm::vec3(baseX, 1.0f, baseZ));
-            v.push_back({p, n});
-        }
+// Ambient caustics from a calm swell, baked once into a looping texture array
+// (cached on disk); the shaders blend two layers instead of evaluating waves.
+static const int CAUSTICS_SIZE = 256, CAUSTICS_FRAMES = 64;
+static const float CAUSTICS_TILE = 1.0f, CAUSTICS_PERIOD = 8.0f;
+static GLuint causticsTex = 0;
+
+static CausticsBake bakeAmbientCaustics() {
+    return loadOrBakeCaustics("caustics.cache", CAUSTICS_SIZE, CAUSTICS_FRAMES,
+                              CAUSTICS_TILE, CAUSTICS_PERIOD, tanks[0].waterY + TANK_HEIGHT);
+}
+static void uploadCaustics(const CausticsBake& b) {
+    glGenTextures(1,&causticsTex);
+    glActiveTexture(GL_TEXTURE0 + CAUSTICS_TEX_UNIT);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, causticsTex);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R8, b.size, b.size, b.frames, 0, GL_RED, GL_UNSIGNED_BYTE, b.texels.data());
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    glActiveTexture(GL_TEXTURE0);
+    memreg::track(memreg::GPU, "Caustics", "texture array + mips", mipChainTexels(b.size, b.size)*b.frames*texelBytes(GL_R8));
+    std::cout << "Caustics: " << b.frames << " x " << b.size << "x" << b.size
+              << (b.fromCache ? " loaded from caustics.cache" : " baked in " + std::to_string((int)b.bakeMs) + " ms")
+              << std::endl;
+}
+
+// Sampler units, surface rectangle, level (which a snapshot can change) and caustics frame.
+// The rectangle is in tank-local coordinates, so every tank's floor samples it.
+static void setWaterUniforms(GLuint prog, float time) {
+    glm::vec4 rc = water.rect();
+    float phase = std::fmod(time / CAUSTICS_PERIOD, 1.0f) * CAUSTICS_FRAMES;
+    float layer = std::floor(phase);
+    glUseProgram(prog);
+    glUniform1i(glGetUniformLocation(prog,"uWaterTex"), WATER_TEX_UNIT);
+    glUniform4f(glGetUniformLocation(prog,"uWaterRect"), rc.x, rc.y, rc.z, rc.w);
+    glUniform1f(glGetUniformLocation(prog,"uWaterY"), tanks[0].waterY);
+    glUniform1i(glGetUniformLocation(prog,"uCaustics"), CAUSTICS_TEX_UNIT);
+    glUniform1f(glGetUniformLocation(prog,"uCausticScale"), 1.0f / CAUSTICS_TILE);
+    glUniform3f(glGetUniformLocation(prog,"uCausticLayers"), layer, std::fmod(layer + 1.0f, (float)CAUSTICS_FRAMES), phase - layer);
+}
+static const float BUBBLE_SPLASH = 0.0015f;   // surface push per surfacing bubble
+
+// Driven by tank 0. Returns true if the surface changed and needs uploading
+static bool stepWater(float dt) {
+    const Tank& t = tanks[0];
+    const BubbleSystem& bubbles = t.bubbles;
+    if (gpuBubbles) {
+        // Stateless bubbles never surface on the CPU; force the surface above each
+        // emitter instead, with the energy its bubbles would bring this step
+        for (const auto& e : bubbles.emitters) water.splash(e.pos.x, e.pos.z, 0.03f, BUBBLE_SPLASH * e.rate * dt);
+    } else {
+        for (const auto& p : bubbles.surfaced) water.splash(p.x, p.y, 0.025f, BUBBLE_SPLASH);
     }
-    
-    // Body triangulation
-    for (int i=0; i<segments; ++i) {
-        for (int j=0; j<12; ++j) {
-            unsigned a = i*13 + j, b = a+1, c = (i+1)*13 + j, d = c+1;
-            if (j == 11) { b = i*13; d = (i+1)*13; }
-            idx.insert(idx.end(), {a,c,b, b,c,d});
-        }
+    for (const auto& v : t.fish) for (const auto& f : v) {
+        float depth = t.waterY - f.pos.y;
+        if (depth >= FISH_CONTACT_DEPTH) continue;
+        float speed = glm::length(f.vel);
+        water.splash(f.pos.x, f.pos.z, 0.04f*f.scale, 0.03f*speed*dt*(1.0f - depth/FISH_CONTACT_DEPTH));
     }
-    
-    Mesh m; glGenVertexArrays(1,&m.vao); glBindVertexArray(m.vao);
-    glGenBuffers(1,&m.vbo); glBindBuffer(GL_ARRAY_BUFFER,m.vbo);
-    glBufferData(GL_ARRAY_BUFFER, v.size()*sizeof(V), v.data(), GL_STATIC_DRAW);
-    glGenBuffers(1,&m.ebo); glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,m.ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, idx.size()*sizeof(unsigned), idx.data(), GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0); glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,sizeof(V),(void*)0);
-    glEnableVertexAttribArray(1); glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,sizeof(V),(void*)offsetof(V,n));
-    m.idxCount=(GLsizei)idx.size();
-    glBindVertexArray(0); return m;
+    return water.update(dt);
 }
 
-static Mesh makeStarfish(float outerRadius = 0.12f, float innerRadius = 0.06f, float thickness = 0.03f) {
-    struct V { glm::vec3 p,n; };
-    std::vector<V> v; std::vector<unsigned> idx;
-    
-    const int arms = 5;
-    const int segments = 10;
-    
-    // Top surface
-    for (int a=0; a<arms; ++a) {
-        float armAngle = (2.0f * 3.14159f) * (float)a / (float)arms;
-        
-        for (int s=0; s<=segments; ++s) {
-            float t = (float)s / (float)segments;
-            float radius = innerRadius + t * (outerRadius - innerRadius);
-            
-            // Main arm
-            float x = radius * std::cos(armAngle);
-            float z = radius * std::sin(armAngle);
-            float y = thickness * 0.5f * (1.0f - t * 0.3f);
-            
-            v.push_back({glm::vec3(x, y, z), glm::vec3(0, 1, 0)});
-            
-            // Arm sides
-            float sideAngle1 = armAngle - 0.2f;
-            float sideAngle2 = armAngle + 0.2f;
-            float sideRadius = radius * (0.7f - t * 0.3f);
-            
-            if (s < segments) {
-                v.push_back({glm::vec3(sideRadius * std::cos(sideAngle1), y, sideRadius * std::sin(sideAngle1)), glm::vec3(0, 1, 0)});
-                v.push_back({glm::vec3(sideRadius * std::cos(sideAngle2), y, sideRadius * std::sin(sideAngle2)), glm::vec3(0, 1, 0)});
-            }
+// ===========================================================
+// Simulation step
+// ===========================================================
+// Everything that advances with dt, free of GL calls so it can run on the
+// simulation thread. Returns true if the water surface changed.
+static std::atomic<float> tankStepMs{0.0f};   // last step of all tanks, for the title
+
+// Tanks are independent shards: each steps on one worker, in any order
+static void stepTanks(std::vector<Tank>& ts, float dt, const SimLodSettings* lod = nullptr) {
+    bool cpuBubbles = !gpuBubbles;
+    splitStalkBudget(ts, scene.stalkBudget);
+    jobs::parallelFor(ts.size(), 1, [&](size_t b, size_t e) {
+        for (size_t i=b;i<e;++i) stepTank(ts[i], scene, dt, cpuBubbles, lod);
+    });
+}
+
+// Simulation LOD (--sim-lod / --sim-budget, see SchoolLod). The render thread
+// publishes the camera every frame; the simulation reads it when it steps.
+static bool simLod = false;
+static float simLodTierStart = 1.5f;
+static int simBudget = -1;                  // steering updates per step over all tanks, < 0 = no cap
+static std::atomic<float> lodCamera[3] = {{0.0f}, {0.0f}, {0.0f}};
+static std::atomic<int> lodSteered{0}, lodDeferred{0};   // last step, for the title
+
+static void publishLodCamera(glm::vec3 c) {
+    for (int i=0;i<3;++i) lodCamera[i].store(c[i], std::memory_order_relaxed);
+}
+static SimLodSettings lodSettings() {
+    SimLodSettings l;
+    l.camera = glm::vec3(lodCamera[0].load(std::memory_order_relaxed), lodCamera[1].load(std::memory_order_relaxed),
+                         lodCamera[2].load(std::memory_order_relaxed));
+    l.tierStart = simLodTierStart;
+    return l;
+}
+static void stepTanksLod(std::vector<Tank>& ts, float dt, const SimLodSettings& l) {
+    splitSimBudget(ts, simBudget);
+    stepTanks(ts, dt, &l);
+    int steered = 0, deferred = 0;
+    for (const Tank& t : ts)
+        for (const SchoolLod& sl : t.lod) { steered += sl.evaluated; deferred += sl.deferred; }
+    lodSteered = steered; lodDeferred = deferred;
+}
+
+static bool simulate(float dt) {
+    feedTanks();
+    auto t0 = std::chrono::steady_clock::now();
+    if (simLod) stepTanksLod(tanks, dt, lodSettings());
+    else stepTanks(tanks, dt);
+    tankStepMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    return stepWater(dt);
+}
+
+// --tank-scaling N: cost of a simulation step for 1, 2, 4 ... N tanks of the
+// current scene, stepped in parallel and one after another.
+static void printTankScaling(int maxTanks) {
+    const float dt = 1.0f / 60.0f;
+    const int warmup = 120, steps = 120;
+    double oneTankMs = 0.0;
+    std::cout << "Tank scaling (" << jobs::threadCount() << " threads, " << scene.totalFish() << " fish per tank):" << std::endl;
+    for (int n=1;;n=std::min(n*2, maxTanks)) {
+        std::vector<Tank> ts(n);
+        for (int i=0;i<n;++i) {
+            ts[i].waterY = scene.waterY;
+            ts[i].rng.seed(tankSeed(i));
+            populateTank(ts[i], scene);
+            initTankBubbles(ts[i], scene, tankBubbleSeed(i));
         }
+        for (int k=0;k<warmup;++k) stepTanks(ts, dt);   // let the bubble pools fill
+        auto t0 = std::chrono::steady_clock::now();
+        for (int k=0;k<steps;++k) stepTanks(ts, dt);
+        double par = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() / steps;
+        t0 = std::chrono::steady_clock::now();
+        for (int k=0;k<steps;++k) for (Tank& t : ts) stepTank(t, scene, dt, true);
+        double ser = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() / steps;
+        if (n == 1) oneTankMs = par;
+        std::cout << "  " << n << " tanks: " << par << " ms/step (serial " << ser << " ms, "
+                  << ser / par << "x), " << par / n << " ms per tank, " << par / oneTankMs << "x the cost of one tank" << std::endl;
+        if (n == maxTanks) break;
     }
-    
-    // Simple triangulation for demonstration
-    for (unsigned i=0; i<v.size()-2; i+=3) {
-        idx.insert(idx.end(), {i, i+1, i+2});
-    }
-    
-    Mesh m; glGenVertexArrays(1,&m.vao); glBindVertexArray(m.vao);
-    glGenBuffers(1,&m.vbo); glBindBuffer(GL_ARRAY_BUFFER,m.vbo);
-    glBufferData(GL_ARRAY_BUFFER, v.size()*sizeof(V), v.data(), GL_STATIC_DRAW);
-    glGenBuffers(1,&m.ebo); glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,m.ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, idx.size()*sizeof(unsigned), idx.data(), GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0); glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,sizeof(V),(void*)0);
-    glEnableVertexAttribArray(1); glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,sizeof(V),(void*)offsetof(V,n));
-    m.idxCount=(GLsizei)idx.size();
-    glBindVertexArray(0); return m;
 }
 
-static Mesh makeKelp(int segments = 20, float height = 0.8f, float width = 0.04f) {
-    struct V { glm::vec3 p,n; };
-    std::vector<V> v; std::vector<unsigned> idx;
-    
-    // Create 3 strips at different angles for 3D kelp
-    const int numStrips = 3;
-    for (int strip = 0; strip < numStrips; ++strip) {
-        float angle = (2.0f * 3.14159f) * (float)strip / (float)numStrips;
-        glm::vec3 stripDir = glm::vec3(std::cos(angle), 0.0f, std::sin(angle));
-        glm::vec3 stripNormal = glm::vec3(-std::sin(angle), 0.0f, std::cos(angle));
-        
-        int baseVertex = (int)v.size();
-        
-        for (int i=0; i<=segments; ++i) {
-            float t = (float)i/segments;
-            float y = t * height;
-            float sway = 0.15f * std::sin(t * 8.0f + strip) * t; // Different sway per strip
-            float w = width * (1.0f - t * 0.3f);
-            
-            glm::vec3 offset = stripDir * w * 0.5f;
-            glm::vec3 swayOffset = glm::vec3(sway * std::cos(angle), 0.0f, sway * std::sin(angle));
-            
-            v.push_back({glm::vec3(-offset.x + swayOffset.x, y, -offset.z + swayOffset.z), stripNormal});
-            v.push_back({glm::vec3( offset.x + swayOffset.x, y,  offset.z + swayOffset.z), stripNormal});
-            
-            if (i < segments) {
-                unsigned base = baseVertex + i*2;
-                idx.insert(idx.end(), {base, base+2, base+1,  base+1, base+2, base+3});
-                // Add back faces
-                idx.insert(idx.end(), {base+1, base+2, base,  base+3, base+2, base+1});
+// --shm-export name: every fish is published to a POSIX shared-memory segment
+// after each simulation step (see fish_shm.h). Called by whichever thread owns
+// the simulation, right after it steps.
+static FishShmWriter shmExport;
+
+static void exportFish(float simTime) {
+    if (!shmExport.isOpen()) return;
+    uint32_t total = 0;
+    for (int s=0;s<SPECIES_COUNT;++s) total += (uint32_t)fishCount(s);
+    if (!shmExport.reserve(total)) return;
+    FishShmRecord* r = shmExport.begin();
+    for (size_t ti=0;ti<tanks.size();++ti) {
+        const Tank& t = tanks[ti];
+        for (int s=0;s<SPECIES_COUNT;++s)
+            for (const FishInst& f : t.fish[s]) {
+                glm::vec3 p = f.pos + t.origin;
+                *r++ = { {p.x, p.y, p.z}, {f.vel.x, f.vel.y, f.vel.z}, (uint32_t)s, (uint32_t)ti };
             }
-        }
     }
-    
-    Mesh m; glGenVertexArrays(1,&m.vao); glBindVertexArray(m.vao);
-    glGenBuffers(1,&m.vbo); glBindBuffer(GL_ARRAY_BUFFER,m.vbo);
-    glBufferData(GL_ARRAY_BUFFER, v.size()*sizeof(V), v.data(), GL_STATIC_DRAW);
-    glGenBuffers(1,&m.ebo); glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,m.ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, idx.size()*sizeof(unsigned), idx.data(), GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0); glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,sizeof(V),(void*)0);
-    glEnableVertexAttribArray(1); glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,sizeof(V),(void*)offsetof(V,n));
-    m.idxCount=(GLsizei)idx.size();
-    glBindVertexArray(0); return m;
+    shmExport.commit(total, (uint32_t)tanks.size(), simTime);
 }
 
-static Mesh makeTreasureChest(float w = 0.2f, float h = 0.15f, float d = 0.15f) {
-    struct V { glm::vec3 p,n; };
-    std::vector<V> v; std::vector<unsigned> idx;
-    
-    float x=w*0.5f, y=h*0.5f, z=d*0.5f;
-    auto addQuad=[&](glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 d, glm::vec3 n){
-        size_t base=v.size();
-        v.push_back({a,n}); v.push_back({b,n}); v.push_back({c,n}); v.push_back({d,n});
-        idx.insert(idx.end(), { (unsigned)base,(unsigned)base+2,(unsigned)base+1,
-                                (unsigned)base,(unsigned)base+3,(unsigned)base+2 });
+// --sim-lod-bench: step cost and visible error of the simulation LOD against
+// the full update, for the scene and --tanks layout seen from the start
+// camera. The error is how far (in pixels at 1080p) each fish ends up from
+// where the full update puts it, after 0.5 s from the same state. Schooling is
+// chaotic, so the full update with a different jitter stream is listed as the
+// noise floor to compare against.
+static void printSimLodBench() {
+    const float dt = 1.0f / 60.0f;
+    const int horizon = 30, rounds = 10;
+    const float pxPerRadian = 540.0f / std::tan(glm::radians(30.0f));   // 1080p, 60 degree vertical fov
+    // Schools only: bubbles cost the same either way
+    auto step = [&](std::vector<Tank>& ts, const SimLodSettings* l) {
+        jobs::parallelFor(ts.size(), 1, [&](size_t b, size_t e) {
+            for (size_t i=b;i<e;++i) stepTank(ts[i], scene, dt, false, l);
+        });
     };
-    
-    // Chest body
-    addQuad({-x,-y,-z},{ x,-y,-z},{ x, y,-z},{-x, y,-z}, { 0, 0, 1}); // Back
-    addQuad({-x,-y, z},{-x, y, z},{ x, y, z},{ x,-y, z}, { 0, 0,-1}); // Front
-    addQuad({-x,-y,-z},{-x,-y, z},{-x, y, z},{-x, y,-z}, { 1, 0, 0}); // Left
-    addQuad({ x,-y, z},{ x,-y,-z},{ x, y,-z},{ x, y, z}, {-1, 0, 0}); // Right
-    addQuad({-x,-y,-z},{ x,-y,-z},{ x,-y, z},{-x,-y, z}, { 0, 1, 0}); // Bottom
-    
-    // Slightly open lid
-    float lidY = y + h * 0.1f;
-    addQuad({-x, y, z},{ x, y, z},{ x, lidY,-z},{-x, lidY,-z}, { 0, 0.7f, 0.7f}); // Lid
-    
-    Mesh m; glGenVertexArrays(1,&m.vao); glBindVertexArray(m.vao);
-    glGenBuffers(1,&m.vbo); glBindBuffer(GL_ARRAY_BUFFER,m.vbo);
-    glBufferData(GL_ARRAY_BUFFER, v.size()*sizeof(V), v.data(), GL_STATIC_DRAW);
-    glGenBuffers(1,&m.ebo); glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,m.ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, idx.size()*sizeof(unsigned), idx.data(), GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0); glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,sizeof(V),(void*)0);
-    glEnableVertexAttribArray(1); glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,sizeof(V),(void*)offsetof(V,n));
-    m.idxCount=(GLsizei)idx.size();
-    glBindVertexArray(0); return m;
-}
-
-// ===========================================================
-// Species/instances
-// ===========================================================
-enum Species : int { CLOWNFISH=0, NEON_TETRA=1, ZEBRA_DANIO=2, ANGELFISH=3, GOLDFISH=4, BETTA=5, GUPPY=6, PLATY=7 };
-struct FishInst {
-    glm::vec3 pos, vel;
-    float phase;
-    float scale;
-    glm::vec3 stretch;
-    glm::vec3 color;
-    float species;
-};
-static std::vector<FishInst> clownfish, neon, danio, angelfish, goldfish, betta, guppy, platy;
-static GLuint vboClown=0, vboNeon=0, vboDanio=0, vboAngelfish=0, vboGoldfish=0, vboBetta=0, vboGuppy=0, vboPlaty=0;
-
-static Mesh fishMesh, clownfishMesh, angelfishMesh, animatedFishMesh, plantMesh, glassTankMesh, tankBaseMesh, waterVolumeMesh, floorMesh, waterMesh, rockMesh, coralMesh, shellMesh, driftwoodMesh, anemoneMesh, starfishMesh, kelpMesh, treasureChestMesh;
-
-// Fix tank bounds - these should match the actual tank dimensions
-const float TANK_WIDTH = 2.4f;   // Tank box is 5.0f wide, so interior is ~2.4f
-const float TANK_HEIGHT = 1.3f;  // Tank box is 2.8f tall, so interior is ~1.3f
-const float TANK_DEPTH = 1.4f;   // Tank box is 3.0f deep, so interior is ~1.4f
-static const glm::vec3 TANK_EXTENTS = {TANK_WIDTH, TANK_HEIGHT, TANK_DEPTH};
-static float waterY = 0.6f; // Adjusted for 85% full tank
-
-static int N_CLOWN = 6, N_NEON = 12, N_DANIO = 8, N_ANGELFISH = 4, N_GOLDFISH = 3, N_BETTA = 2, N_GUPPY = 8, N_PLATY = 6;
-static int N_PLANTS = 25, N_ROCKS = 15, N_CORALS = 12, N_SHELLS = 18, N_DRIFTWOOD = 8, N_ANEMONES = 6, N_STARFISH = 10, N_KELP = 15, N_DECORATIONS = 8;
-
-static GLuint plantVBO=0;
-static std::vector<glm::vec3> plantPos;
-static std::vector<glm::vec2> plantHP;
-static std::vector<glm::vec3> plantColor;
-
-static std::vector<glm::vec4> rocks;
-static std::vector<glm::vec4> corals;
-static std::vector<glm::vec4> shells;
-static std::vector<glm::vec4> driftwood;
-static std::vector<glm::vec4> anemones;
-static std::vector<glm::vec4> starfish;
-static std::vector<glm::vec4> kelp;
-static std::vector<glm::vec4> decorations;
-
-static std::mt19937 rng(2025);
-static std::uniform_real_distribution<float> urand(-1.0f, 1.0f);
-static std::uniform_real_distribution<float> urand01(0.0f, 1.0f);
-
-static void initSpeciesVec(std::vector<FishInst>& v, int count, Species s,
-                           glm::vec3 baseColor, glm::vec3 varyColor,
-                           glm::vec3 stretchMean, glm::vec3 stretchVar,
-                           float speedMin, float speedMax,
-                           float yMin, float yMax, float scaleMin, float scaleMax) {
-    v.resize(count);
-    for (int i=0;i<count;++i) {
-        // Keep fish well within tank bounds
-        glm::vec3 p(urand(rng)*TANK_EXTENTS.x*0.7f,
-                    yMin + urand01(rng)*(yMax-yMin),
-                    urand(rng)*TANK_EXTENTS.z*0.7f);
-        glm::vec3 dir = glm::normalize(glm::vec3(urand(rng), urand(rng)*0.2f, urand(rng)));
-        float sp = speedMin + urand01(rng)*(speedMax-speedMin);
-        glm::vec3 col = glm::clamp(baseColor + varyColor * urand(rng)*0.5f, glm::vec3(0.0f), glm::vec3(1.0f));
-        glm::vec3 stretch = glm::max(stretchMean + stretchVar * urand(rng), glm::vec3(0.25f));
-        float sc = scaleMin + urand01(rng)*(scaleMax-scaleMin);
-        v[i] = { p, dir*sp, urand01(rng)*6.28318f, sc, stretch, col, (float)s };
+    auto populated = [] {
+        std::vector<Tank> ts(tanks.size());
+        for (size_t i=0;i<ts.size();++i) {
+            ts[i].origin = tanks[i].origin; ts[i].waterY = tanks[i].waterY; ts[i].rng.seed(tankSeed((int)i));
+            populateTank(ts[i], scene);
+        }
+        return ts;
+    };
+    int fish = 0;
+    for (int s=0;s<SPECIES_COUNT;++s) fish += (int)tanks.size() * scene.species[s].count;
+    std::cout << "Simulation LOD (" << tanks.size() << " tanks, " << fish << " fish, camera at "
+              << camPos.x << "," << camPos.y << "," << camPos.z << ", tiers from " << simLodTierStart << "):" << std::endl;
+
+    struct Mode { const char* name; bool lod, otherJitter; int budget; };
+    const Mode modes[] = { {"full update", false, false, -1}, {"full update, other jitter", false, true, -1},
+                           {"LOD", true, false, -1}, {"LOD, budget 25%", true, false, fish / 4} };
+    double fullMs = 0.0;
+    for (const Mode& m : modes) {
+        SimLodSettings l;
+        l.camera = camPos; l.tierStart = simLodTierStart;
+        std::vector<Tank> ref = populated(), ts = populated();
+        splitSimBudget(ts, m.budget);
+        double ms = 0.0, errSum = 0.0, errMax = 0.0;
+        long steered = 0, samples = 0;
+        for (int r=0;r<rounds;++r) {
+            // Both start the round from the reference state
+            for (size_t t=0;t<ts.size();++t) {
+                for (int s=0;s<SPECIES_COUNT;++s) ts[t].fish[s] = ref[t].fish[s];
+                ts[t].rng = ref[t].rng;
+                if (m.otherJitter) ts[t].rng.discard(1);
+            }
+            for (int k=0;k<horizon;++k) {
+                step(ref, nullptr);
+                auto t0 = std::chrono::steady_clock::now();
+                step(ts, m.lod ? &l : nullptr);
+                ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+                if (m.lod) for (const Tank& t : ts) for (const SchoolLod& sl : t.lod) steered += sl.evaluated;
+            }
+            for (size_t t=0;t<ts.size();++t)
+                for (int s=0;s<SPECIES_COUNT;++s)
+                    for (size_t i=0;i<ts[t].fish[s].size();++i) {
+                        glm::vec3 want = ref[t].fish[s][i].pos + ref[t].origin, got = ts[t].fish[s][i].pos + ts[t].origin;
+                        double px = glm::length(got - want) / std::max(glm::length(want - camPos), 0.05f) * pxPerRadian;
+                        errSum += px; errMax = std::max(errMax, px); ++samples;
+                    }
+        }
+        ms /= rounds * horizon;
+        if (!m.lod) steered = (long)fish * rounds * horizon;
+        if (fullMs == 0.0) fullMs = ms;
+        std::cout << "  " << m.name << ": " << ms << " ms/step (" << fullMs / ms << "x), "
+                  << (double)steered / (rounds * horizon) << " steering updates/step; error after 0.5 s "
+                  << errSum / std::max(samples, 1L) << " px mean, " << errMax << " px max" << std::endl;
     }
 }
-static void initPlantsAndRocks() {
-    plantPos.resize(N_PLANTS);
-    plantHP.resize(N_PLANTS);
-    plantColor.resize(N_PLANTS);
-    for (int i=0;i<N_PLANTS;++i) {
-        float x = (urand01(rng) < 0.5f ? -1.0f : 1.0f) * (0.3f + urand01(rng)*0.5f) * TANK_EXTENTS.x;
-        float z = urand(rng)*TANK_EXTENTS.z*0.8f;
-        float h = 0.35f + urand01(rng)*0.55f;
-        float phase = urand01(rng)*6.28318f;
-        glm::vec3 col = glm::vec3(0.18f + urand01(rng)*0.1f, 0.55f + urand01(rng)*0.35f, 0.18f);
-        plantPos[i]   = glm::vec3(x, -TANK_HEIGHT, z);
-        plantHP[i]    = glm::vec2(h, phase);
-        plantColor[i] = col;
-    }
-    if (!plantVBO) glGenBuffers(1, &plantVBO);
 
-    // Rock clusters - create natural groupings with larger sizes
-    rocks.resize(N_ROCKS);
-    for (int i=0;i<N_ROCKS;++i) {
-        float clusterX = (i < N_ROCKS/2) ? -0.6f : 0.6f; // Two main clusters
-        float x = clusterX + urand(rng)*0.4f;
-        float z = urand(rng)*TANK_EXTENTS.z*0.6f;
-        float r = 0.25f + urand01(rng)*0.35f; // Much larger rocks (was 0.08f + 0.18f)
-        rocks[i] = glm::vec4(x, -TANK_HEIGHT, z, r);
+// Serial path: simulate and upload on the render thread
+static void simulateAndUpload(float dt, float simTime) {
+    bool waterChanged = simulate(dt);
+    exportFish(simTime);
+    for (int i=0;i<SPECIES_COUNT;++i) {
+        int n = fishCount(i);
+        FrameVector<float> inst((size_t)n*FISH_INSTANCE_FLOATS, 0.0f, FrameAllocator<float>(frameArena));
+        packFish(i, inst.data());
+        uploadFish(i, inst.data(), n);
     }
-    
-    // Coral garden - spread around with larger sizes
-    corals.resize(N_CORALS);
-    for (int i=0;i<N_CORALS;++i) {
-        float x = urand(rng)*TANK_EXTENTS.x*0.7f;
-        float z = urand(rng)*TANK_EXTENTS.z*0.7f;
-        float r = 0.3f + urand01(rng)*0.4f; // Much larger corals (was 0.12f + 0.20f)
-        corals[i] = glm::vec4(x, -TANK_HEIGHT, z, r);
+    if (!gpuBubbles) {
+        packBubbles(bubbleUpload.data());
+        uploadBubbles(bubbleUpload.data(), (int)bubbleSlotsUsed());
     }
-    
-    // Shells scattered on floor
-    shells.resize(N_SHELLS);
-    for (int i=0;i<N_SHELLS;++i) {
-        float x = urand(rng)*TANK_EXTENTS.x*0.8f;
-        float z = urand(rng)*TANK_EXTENTS.z*0.8f;
-        float r = 0.05f + urand01(rng)*0.08f;
-        shells[i] = glm::vec4(x, -TANK_HEIGHT, z, r);
+    {
+        int n = (int)foodCount();
+        FrameVector<float> inst((size_t)n*DECOR_INSTANCE_FLOATS, 0.0f, FrameAllocator<float>(frameArena));
+        packFood(inst.data());
+        uploadFood(inst.data(), n);
     }
-    
-    // Driftwood pieces
-    driftwood.resize(N_DRIFTWOOD);
-    for (int i=0;i<N_DRIFTWOOD;++i) {
-        float x = urand(rng)*TANK_EXTENTS.x*0.6f;
-        float z = urand(rng)*TANK_EXTENTS.z*0.6f;
-        float r = 0.15f + urand01(rng)*0.25f;
-        driftwood[i] = glm::vec4(x, -TANK_HEIGHT + 0.05f, z, r);
+    {
+        FrameVector<float> nodes(stalkFloats(), 0.0f, FrameAllocator<float>(frameArena));
+        packStalks(nodes.data());
+        uploadStalks(nodes.data(), nodes.size());
     }
-    
-    // Sea anemones - near rocks, larger size
-    anemones.resize(N_ANEMONES);
-    for (int i=0;i<N_ANEMONES;++i) {
-        float x = urand(rng)*TANK_EXTENTS.x*0.5f;
-        float z = urand(rng)*TANK_EXTENTS.z*0.5f;
-        float r = 0.15f + urand01(rng)*0.20f; // Larger anemones (was 0.08f + 0.12f)
-        anemones[i] = glm::vec4(x, -TANK_HEIGHT, z, r);
+    if (waterChanged) uploadWater(water.texels());
+}
+
+// Threaded path (--threaded-sim): the simulation thread packs each step into a
+// SimFrame and the render thread uploads whichever frame is newest. Only one
+// thread touches the simulation state at a time: the sim thread while it runs,
+// the render thread (snapshots) after stop().
+static SimThread simThread;
+static uint64_t waterSeq = 0, waterUploadedSeq = 0;
+
+static void simulateInto(float dt, SimFrame& out, float& simTime) {
+    simTime += dt;
+    if (simulate(dt)) ++waterSeq;
+    exportFish(simTime);
+    for (int i=0;i<SPECIES_COUNT;++i) {
+        out.fish[i].resize((size_t)fishCount(i)*FISH_INSTANCE_FLOATS);
+        packFish(i, out.fish[i].data());
     }
-    
-    // Starfish on floor
-    starfish.resize(N_STARFISH);
-    for (int i=0;i<N_STARFISH;++i) {
-        float x = urand(rng)*TANK_EXTENTS.x*0.9f;
-        float z = urand(rng)*TANK_EXTENTS.z*0.9f;
-        float r = 0.06f + urand01(rng)*0.08f;
-        starfish[i] = glm::vec4(x, -TANK_HEIGHT + 0.01f, z, r);
+    out.bubbles.resize(gpuBubbles ? 0 : bubbleSlotsUsed()*4);
+    if (!out.bubbles.empty()) packBubbles(out.bubbles.data());
+    out.food.resize(foodCount()*DECOR_INSTANCE_FLOATS);
+    packFood(out.food.data());
+    out.stalks.resize(stalkFloats());
+    packStalks(out.stalks.data());
+    // Slots are reused round-robin, so bring this one up to date even if this step didn't move the water
+    if (out.waterSeq != waterSeq) {
+        int r = water.resolution();
+        out.water.assign(water.texels(), water.texels() + (size_t)r*r*4);
+        out.waterSeq = waterSeq;
     }
-    
-    // Kelp forest in back corners
-    kelp.resize(N_KELP);
-    for (int i=0;i<N_KELP;++i) {
-        float corner = (i < N_KELP/2) ? -1.0f : 1.0f;
-        float x = corner * (0.7f + urand01(rng)*0.2f) * TANK_EXTENTS.x;
-        float z = (urand01(rng) < 0.5f ? -1.0f : 1.0f) * (0.5f + urand01(rng)*0.3f) * TANK_EXTENTS.z;
-        float r = 0.6f + urand01(rng)*0.4f; // Height variation
-        kelp[i] = glm::vec4(x, -TANK_HEIGHT, z, r);
+    out.simTime = simTime;
+}
+static void uploadSimFrame(const SimFrame& f) {
+    for (int i=0;i<SPECIES_COUNT;++i)
+        uploadFish(i, f.fish[i].data(), (int)(f.fish[i].size() / FISH_INSTANCE_FLOATS));
+    uploadBubbles(f.bubbles.data(), (int)(f.bubbles.size() / 4));
+    uploadFood(f.food.data(), (int)(f.food.size() / DECOR_INSTANCE_FLOATS));
+    uploadStalks(f.stalks.data(), f.stalks.size());
+    if (f.waterSeq != waterUploadedSeq && !f.water.empty()) {
+        uploadWater(f.water.data());
+        waterUploadedSeq = f.waterSeq;
     }
-    
-    // Special decorations (treasure chests, etc.)
-    decorations.resize(N_DECORATIONS);
-    for (int i=0;i<N_DECORATIONS;++i) {
-        float x = urand(rng)*TANK_EXTENTS.x*0.4f;
-        float z = urand(rng)*TANK_EXTENTS.z*0.4f;
-        float r = 0.1f + urand01(rng)*0.1f;
-        decorations[i] = glm::vec4(x, -TANK_HEIGHT + 0.02f, z, r);
+}
+
+// ===========================================================
+// Memory report
+// ===========================================================
+// GPU entries are registered where resources are created; CPU containers grow
+// as they go, so their capacities are sampled here right before a report.
+// Reads simulation state: with --threaded-sim, only call while it is stopped.
+static void trackCpuMemory() {
+    using memreg::CPU;
+    size_t fish[SPECIES_COUNT] = {}, lists = 0, pools = 0, decor = 0, stalks = 0, obstacles = 0, food = 0;
+    for (const Tank& t : tanks) {
+        for (int i=0;i<SPECIES_COUNT;++i) fish[i] += t.fish[i].capacity()*sizeof(FishInst);
+        for (const auto& c : t.neighborCache) lists += c.memoryBytes();
+        pools += t.bubbles.memoryBytes();
+        decor += (t.plantPos.capacity() + t.plantColor.capacity())*sizeof(glm::vec3) + t.plantHP.capacity()*sizeof(glm::vec2);
+        for (const auto& v : t.decor) decor += v.capacity()*sizeof(glm::vec4);
+        stalks += t.stalks.memoryBytes();
+        obstacles += t.obstacles.memoryBytes();
+        food += t.food.memoryBytes();
     }
+    for (int i=0;i<SPECIES_COUNT;++i) memreg::track(CPU, "Fish schools", scene.species[i].name, fish[i]);
+    memreg::track(CPU, "Fish schools", "neighbour lists", lists);
+    memreg::track(CPU, "Bubbles", "particle pools", pools);
+    memreg::track(CPU, "Bubbles", "upload staging", bubbleUpload.capacity()*sizeof(float));
+    memreg::track(CPU, "Water", "heightfield simulation", water.memoryBytes());
+    memreg::track(CPU, "Decorations", "placements", decor);
+    memreg::track(CPU, "Decorations", "plant & kelp chains", stalks);
+    memreg::track(CPU, "Decorations", "obstacle field", obstacles);
+    memreg::track(CPU, "Food", "pellets & grid", food);
+    memreg::track(CPU, "Frame arena", "render thread", frameArena.capacity());
+    memreg::track(CPU, "Shared memory", "fish export", shmExport.bytes());
+    memreg::track(CPU, "Capture", "encoder frames", captureEncoder.memoryBytes());
+    // Sim thread slots (empty without --threaded-sim); the others match the front one in steady state
+    const SimFrame& f = simThread.front();
+    size_t slot = (f.bubbles.capacity() + f.food.capacity() + f.stalks.capacity() + f.water.capacity())*sizeof(float);
+    for (const auto& v : f.fish) slot += v.capacity()*sizeof(float);
+    memreg::track(CPU, "Sim thread", "triple-buffered frames", 3*slot);
 }
-static void setupFishInstancing(GLuint &instVBO, const Mesh& m, int count) {
-    if (!instVBO) glGenBuffers(1, &instVBO);
-    glBindVertexArray(m.vao);
-    glBindBuffer(GL_ARRAY_BUFFER, instVBO);
-    glBufferData(GL_ARRAY_BUFFER, count * (sizeof(float)*15), nullptr, GL_DYNAMIC_DRAW);
-    glEnableVertexAttribArray(3); glVertexAttribPointer(3,3,GL_FLOAT,GL_FALSE,sizeof(float)*15,(void*)0);                 glVertexAttribDivisor(3,1);
-    glEnableVertexAttribArray(4); glVertexAttribPointer(4,3,GL_FLOAT,GL_FALSE,sizeof(float)*15,(void*)(sizeof(float)*3));  glVertexAttribDivisor(4,1);
-    glEnableVertexAttribArray(5); glVertexAttribPointer(5,2,GL_FLOAT,GL_FALSE,sizeof(float)*15,(void*)(sizeof(float)*6));  glVertexAttribDivisor(5,1);
-    glEnableVertexAttribArray(6); glVertexAttribPointer(6,3,GL_FLOAT,GL_FALSE,sizeof(float)*15,(void*)(sizeof(float)*8));  glVertexAttribDivisor(6,1);
-    glEnableVertexAttribArray(7); glVertexAttribPointer(7,3,GL_FLOAT,GL_FALSE,sizeof(float)*15,(void*)(sizeof(float)*11)); glVertexAttribDivisor(7,1);
-    glEnableVertexAttribArray(8); glVertexAttribPointer(8,1,GL_FLOAT,GL_FALSE,sizeof(float)*15,(void*)(sizeof(float)*14)); glVertexAttribDivisor(8,1);
-    glBindVertexArray(0);
+static void printMemoryReport() {
+    trackCpuMemory();
+    memreg::report(std::cout);
 }
 
 // ===========================================================
-// Bubbles
+// Snapshots & replay
 // ===========================================================
-static const int N_BUB = 60;
-static std::vector<glm::vec3> bubblePos;
-static GLuint bubbleVBO = 0, bubbleVAO = 0;
+// Snapshots hold every tank: tank 0's sections under their plain names (as
+// before --tanks), tank i's under "tank<i>.", and the tank count in meta.tanks.
+static const char* const speciesKeys[8] = { "fish.clownfish", "fish.neon", "fish.danio", "fish.angelfish",
+                                            "fish.goldfish", "fish.betta", "fish.guppy", "fish.platy" };
+static const char* const decorKeys[DECOR_KINDS] = { "decor.rocks", "decor.corals", "decor.shells", "decor.driftwood",
+                                                    "decor.anemones", "decor.starfish", "decor.kelp", "decor.chests" };
+
+// Fingerprint of everything the simulation advances, compared frame by frame on replay
+static uint64_t simStateHash() {
+    uint64_t h = hashBytes(nullptr, 0);
+    for (const Tank& t : tanks) {
+        for (const auto& v : t.fish) h = hashBytes(v.data(), v.size()*sizeof(FishInst), h);
+        const BubbleSystem& b = t.bubbles;
+        int n = b.used();
+        h = hashBytes(b.px.data(), n*sizeof(float), h);
+        h = hashBytes(b.py.data(), n*sizeof(float), h);
+        h = hashBytes(b.pz.data(), n*sizeof(float), h);
+        const FoodSystem& f = t.food;
+        h = hashBytes(f.px.data(), f.px.size()*sizeof(float), h);
+        h = hashBytes(f.py.data(), f.py.size()*sizeof(float), h);
+        h = hashBytes(f.pz.data(), f.pz.size()*sizeof(float), h);
+        const StalkSystem& s = t.stalks;
+        h = hashBytes(s.x.data(), s.x.size()*sizeof(float), h);
+        h = hashBytes(s.y.data(), s.y.size()*sizeof(float), h);
+        h = hashBytes(s.z.data(), s.z.size()*sizeof(float), h);
+    }
+    return h;
+}
 
-static void initBubbles() {
-    bubblePos.resize(N_BUB);
-    for (int i=0;i<N_BUB;++i) {
-        float x = urand(rng)*TANK_EXTENTS.x*0.6f;
-        float z = urand(rng)*TANK_EXTENTS.z*0.6f;
-        float y = -TANK_HEIGHT + urand01(rng)*0.3f;
-        bubblePos[i] = glm::vec3(x,y,z);
+static std::string tankSectionPrefix(size_t i) { return i ? "tank" + std::to_string(i) + "." : std::string(); }
+
+static bool saveSnapshot(const std::string& path, float simTime) {
+    SnapshotWriter w;
+    uint32_t layout[3] = { (uint32_t)sizeof(FishInst), (uint32_t)sizeof(BubbleEmitter), (uint32_t)sizeof(glm::vec4) };
+    w.addValue("meta.layout", layout);
+    w.addValue("meta.tanks", (uint32_t)tanks.size());
+    w.addValue("sim.time", simTime);
+    for (size_t i=0;i<tanks.size();++i) {
+        const Tank& t = tanks[i];
+        w.setPrefix(tankSectionPrefix(i));
+        w.addValue("tank.waterY", t.waterY);
+        for (int s=0;s<8;++s) w.addVector(speciesKeys[s], t.fish[s]);
+        for (int k=0;k<DECOR_KINDS;++k) w.addVector(decorKeys[k], t.decor[k]);
+        w.addVector("plants.pos", t.plantPos);
+        w.addVector("plants.hp", t.plantHP);
+        w.addVector("plants.color", t.plantColor);
+        t.bubbles.save(w);
+        t.food.save(w);
+        t.stalks.save(w);
+        w.addRng("rng.main", t.rng);
     }
-    glGenVertexArrays(1,&bubbleVAO);
-    glBindVertexArray(bubbleVAO);
-    glGenBuffers(1,&bubbleVBO);
-    glBindBuffer(GL_ARRAY_BUFFER,bubbleVBO);
-    glBufferData(GL_ARRAY_BUFFER, bubblePos.size()*sizeof(glm::vec3), bubblePos.data(), GL_DYNAMIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,sizeof(glm::vec3),(void*)0);
-    glBindVertexArray(0);
+    w.setPrefix("");
+    water.save(w);
+    bool ok = w.save(path);
+    if (ok) std::cout << "Snapshot saved: " << path << " (" << tanks.size() << " tanks)" << std::endl;
+    return ok;
 }
-static void updateBubbles(float dt) {
-    for (int i=0;i<N_BUB;++i) {
-        bubblePos[i].y += (0.28f + 0.18f*urand01(rng)) * dt;
-        bubblePos[i].x += 0.06f * std::sin(glfwGetTime()*2.2f + i*0.31f) * dt;
-        if (bubblePos[i].y > waterY - 0.02f) {
-            bubblePos[i].y = -TANK_HEIGHT + urand01(rng)*0.2f;
-            bubblePos[i].x = urand(rng)*TANK_EXTENTS.x*0.5f;
-            bubblePos[i].z = urand(rng)*TANK_EXTENTS.z*0.5f;
-        }
+
+// One tank's sections (under the reader's prefix) into t; false on a missing
+// or malformed one, with t left half-read
+static bool loadTankSections(const SnapshotReader& r, Tank& t, int index) {
+    bool ok = r.readValue("tank.waterY", t.waterY);
+    for (int i=0;i<8 && ok;++i) ok = r.readVector(speciesKeys[i], t.fish[i]);
+    for (int k=0;k<DECOR_KINDS && ok;++k) ok = r.readVector(decorKeys[k], t.decor[k]);
+    ok = ok && r.readVector("plants.pos", t.plantPos) && r.readVector("plants.hp", t.plantHP)
+            && r.readVector("plants.color", t.plantColor)
+            && t.plantHP.size() == t.plantPos.size() && t.plantColor.size() == t.plantPos.size();
+    ok = ok && t.bubbles.load(r) && r.readRng("rng.main", t.rng);
+    if (!ok) return false;
+    // Older snapshots have no food: start with none
+    if (!t.food.load(r)) initTankFood(t, scene, tankFoodSeed(index));
+    initTankStalks(t);
+    t.stalks.load(r);   // older snapshots: the plants start upright
+    bakeTankObstacles(t, scene.obstacleCell);
+    return true;
+}
+
+static bool loadSnapshot(const std::string& path, float& simTime) {
+    SnapshotReader r;
+    if (!r.open(path)) return false;
+    uint32_t layout[3];
+    if (!r.readValue("meta.layout", layout) || layout[0] != sizeof(FishInst)
+        || layout[1] != sizeof(BubbleEmitter) || layout[2] != sizeof(glm::vec4)) {
+        std::cerr << "Snapshot: " << path << " was written with a different struct layout\n";
+        return false;
     }
-    glBindBuffer(GL_ARRAY_BUFFER,bubbleVBO);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, bubblePos.size()*sizeof(glm::vec3), bubblePos.data());
+    uint32_t count = 1;   // older snapshots: tank 0 only
+    r.readValue("meta.tanks", count);
+    if (count != tanks.size()) {
+        std::cerr << "Snapshot: " << path << " holds " << count << " tanks, this run has " << tanks.size() << "\n";
+        return false;
+    }
+    // Everything goes into copies first, so a bad section leaves the live tanks alone
+    std::vector<Tank> loaded(tanks);
+    float time = 0.0f;
+    bool ok = r.readValue("sim.time", time);
+    for (size_t i=0;i<loaded.size() && ok;++i) {
+        r.setPrefix(tankSectionPrefix(i));
+        ok = loadTankSections(r, loaded[i], (int)i);
+    }
+    r.setPrefix("");
+    if (!ok) { std::cerr << "Snapshot: " << path << " is missing or has malformed sections\n"; return false; }
+
+    for (size_t i=0;i<tanks.size();++i) tanks[i] = std::move(loaded[i]);   // in place: others hold on to tanks[i]
+    simTime = time;
+    setupAllFishInstancing();
+    buildTankInstances();
+    bubbleUpload.resize(bubbleCapacity() * 4);
+    // Older snapshots and other water resolutions keep the live surface
+    if (water.load(r)) uploadWater(water.texels());
+    std::cout << "Snapshot loaded: " << path << " (t=" << simTime << ", " << tanks.size() << " tanks)" << std::endl;
+    return true;
 }
 
 // ===========================================================
@@ -1122,7 +1478,7 @@ static GLint u(GLuint p, const char* n){ return glGetUniformLocation(p, n); }
 static void drawScreenTriangle(){ glBindVertexArray(screenVAO); glDrawArrays(GL_TRIANGLES, 0, 3); }
 
 // Create cubemap texture helper
-static GLuint createCube(GLenum internal, int size, bool mipmap) {
+static GLuint createCube(GLenum internal, int size, bool mipmap, const char* name) {
     GLuint tex; glGenTextures(1,&tex);
     glBindTexture(GL_TEXTURE_CUBE_MAP, tex);
     for (int f=0; f<6; ++f)
@@ -1133,6 +1489,7 @@ static GLuint createCube(GLenum internal, int size, bool mipmap) {
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
     if (mipmap) glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+    memreg::track(memreg::GPU, "IBL", name, 6*(mipmap ? mipChainTexels(size, size) : (size_t)size*size)*texelBytes(internal));
     return tex;
 }
 
@@ -1140,16 +1497,20 @@ static void ensureIBLTargets(){
     if (!fbo) glGenFramebuffers(1,&fbo);
     if (!rbo) glGenRenderbuffers(1,&rbo);
 }
+static void allocIBLDepth(int size) {
+    glBindRenderbuffer(GL_RENDERBUFFER, rbo);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, size, size);
+    memreg::track(memreg::GPU, "IBL", "capture depth/stencil", (size_t)size*size*texelBytes(GL_DEPTH24_STENCIL8));
+}
 
 // Generate procedural HDR environment -> envCube
 static void generateEnvCube(int size) {
     ensureIBLTargets();
     if (envCube) glDeleteTextures(1,&envCube);
-    envCube = createCube(GL_RGBA16F, size, false);
+    envCube = createCube(GL_RGBA16F, size, false, "environment cube");
 
     glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-    glBindRenderbuffer(GL_RENDERBUFFER, rbo);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, size, size);
+    allocIBLDepth(size);
 
     glUseProgram(progIBLGen);
     glUniform1f(u(progIBLGen,"uFaceSize"), (float)size);
@@ -1167,11 +1528,10 @@ static void generateEnvCube(int size) {
 static void generateIrradiance(int size) {
     ensureIBLTargets();
     if (irrCube) glDeleteTextures(1,&irrCube);
-    irrCube = createCube(GL_RGBA16F, size, false);
+    irrCube = createCube(GL_RGBA16F, size, false, "irradiance cube");
 
     glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-    glBindRenderbuffer(GL_RENDERBUFFER, rbo);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, size, size);
+    allocIBLDepth(size);
 
     glUseProgram(progIBLDiff);
     glUniform1f(u(progIBLDiff,"uFaceSize"), (float)size);
@@ -1191,7 +1551,7 @@ static void generateIrradiance(int size) {
 static void generatePrefilter(int baseSize) {
     ensureIBLTargets();
     if (prefilterCube) glDeleteTextures(1,&prefilterCube);
-    prefilterCube = createCube(GL_RGBA16F, baseSize, true);
+    prefilterCube = createCube(GL_RGBA16F, baseSize, true, "prefiltered cube + mips");
     glBindTexture(GL_TEXTURE_CUBE_MAP, prefilterCube);
     prefilterMaxMip = (int)std::floor(std::log2((float)baseSize));
     for (int mip=1; mip<=prefilterMaxMip; ++mip) {
@@ -1208,8 +1568,7 @@ static void generatePrefilter(int baseSize) {
     for (int mip=0; mip<=prefilterMaxMip; ++mip){
         int size = baseSize >> mip;
         float rough = (float)mip / (float)prefilterMaxMip;
-        glBindRenderbuffer(GL_RENDERBUFFER, rbo);
-        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, size, size);
+        allocIBLDepth(size);
         glViewport(0,0,size,size);
         glUniform1f(u(progIBLSpec,"uFaceSize"), (float)size);
         glUniform1f(u(progIBLSpec,"uRoughness"), rough);
@@ -1228,14 +1587,14 @@ static void generateBRDF(int size) {
     if (!brdfLUT) glGenTextures(1,&brdfLUT);
     glBindTexture(GL_TEXTURE_2D, brdfLUT);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16F, size, size, 0, GL_RG, GL_FLOAT, nullptr);
+    memreg::track(memreg::GPU, "IBL", "BRDF LUT", (size_t)size*size*texelBytes(GL_RG16F));
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
     glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-    glBindRenderbuffer(GL_RENDERBUFFER, rbo);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, size, size);
+    allocIBLDepth(size);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, brdfLUT, 0);
     glViewport(0,0,size,size);
 
@@ -1249,7 +1608,73 @@ static void generateBRDF(int size) {
 // ===========================================================
 // Main
 // ===========================================================
-int main(){
+int main(int argc, char** argv){
+    auto appStart = std::chrono::steady_clock::now();
+    std::string scenePath, snapshotIn, recordPath, replayPath;
+    bool waterBench = false, threadedSim = false;
+    int tankCount = 1, tankScaling = 0;
+    bool captureAtStart = false, simLodBench = false;
+    std::string hdrFormatArg, shmName;
+    for (int i=1;i<argc;++i) {
+        std::string a = argv[i];
+        bool hasValue = i+1 < argc;
+        if      (a == "--scene"    && hasValue) scenePath  = argv[++i];
+        else if (a == "--snapshot" && hasValue) snapshotIn = argv[++i];
+        else if (a == "--record"   && hasValue) recordPath = argv[++i];
+        else if (a == "--replay"   && hasValue) replayPath = argv[++i];
+        else if (a == "--water-bench")          waterBench = true;
+        else if (a == "--threaded-sim")         threadedSim = true;
+        else if (a == "--tanks" && hasValue)    tankCount = std::clamp(std::atoi(argv[++i]), 1, 256);
+        else if (a == "--tank-scaling" && hasValue) tankScaling = std::clamp(std::atoi(argv[++i]), 1, 256);
+        else if (a == "--shm-export" && hasValue) shmName = argv[++i];
+        else if (a == "--sim-lod" && hasValue)  { simLod = true; simLodTierStart = std::max(0.1f, (float)std::atof(argv[++i])); }
+        else if (a == "--sim-budget" && hasValue) { simLod = true; simBudget = std::max(0, std::atoi(argv[++i])); }
+        else if (a == "--sim-lod-bench")        simLodBench = true;
+        else if (a == "--capture" && hasValue)  { capturePath = argv[++i]; captureAtStart = true; }
+        else if (a == "--capture-fps" && hasValue) captureFps = std::clamp(std::atoi(argv[++i]), 1, 240);
+        else if (a == "--hdr-format" && hasValue) hdrFormatArg = argv[++i];
+        else if (a == "--gpu-budget" && hasValue) gpuBudgetMs = std::max(0.0f, (float)std::atof(argv[++i]));
+        else if (a == "--refraction-scale" && hasValue) refractionScale = std::clamp((float)std::atof(argv[++i]), 0.125f, 1.0f);
+        else {
+            std::cerr << "Unknown or incomplete option: " << a << "\n"
+                      << "Usage: Aquarium [--scene file] [--snapshot file] [--record file | --replay file] [--water-bench]\n"
+                      << "               [--threaded-sim] [--tanks n] [--tank-scaling max-tanks] [--shm-export /name]\n"
+                      << "               [--capture file.y4m|prefix] [--capture-fps n]\n"
+                      << "               [--sim-lod tier-distance] [--sim-budget steering-updates] [--sim-lod-bench]\n"
+                      << "               [--hdr-format r11g11b10f|rgba16f] [--refraction-scale 0.125-1]\n"
+                      << "               [--gpu-budget ms (0 = fixed resolution)]\n";
+            return -1;
+        }
+    }
+    if (!recordPath.empty() && !replayPath.empty()) { std::cerr << "--record and --replay are exclusive\n"; return -1; }
+    // Replays compare state hashes every render frame; the sim thread steps on its own clock
+    if (threadedSim && (!recordPath.empty() || !replayPath.empty())) { std::cerr << "--threaded-sim cannot record or replay\n"; return -1; }
+
+    if (hdrFormatArg == "rgba16f") hdrFormat = GL_RGBA16F;
+    else if (!hdrFormatArg.empty() && hdrFormatArg != "r11g11b10f") { std::cerr << "Unknown HDR format: " << hdrFormatArg << "\n"; return -1; }
+
+    if (waterBench) {
+        for (int r : {256, 1024})
+            std::cout << "Water sim " << r << "x" << r << ": " << WaterSim::benchmark(r, r <= 256 ? 200 : 20)
+                      << " ms/step (" << jobs::threadCount() << " threads)" << std::endl;
+        return 0;
+    }
+
+    // Scene: an explicit --scene must load; the bundled default may be absent
+    if (!scenePath.empty()) {
+        if (!loadSceneConfig(scenePath, scene)) return -1;
+    } else if (!loadSceneConfig("scenes/default.scene", scene)) {
+        std::cerr << "Using built-in default scene\n";
+    }
+    std::cout << "Scene: " << scene.name << " (" << scene.totalFish() << " fish)" << std::endl;
+    if (tankScaling) { printTankScaling(tankScaling); return 0; }
+    configureTanks(tankCount);
+    if (simLodBench) { printSimLodBench(); return 0; }
+    if (!shmName.empty()) {
+        if (!shmExport.open(shmName, (uint32_t)(scene.totalFish() * tankCount))) return -1;
+        std::cout << "Exporting fish to shared memory " << shmName << " (" << shmExport.bytes() / 1024 << " KB)" << std::endl;
+    }
+
     if (!glfwInit()) { std::cerr<<"GLFW init failed\n"; return -1; }
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR,4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR,1);
@@ -1277,137 +1702,158 @@ int main(){
     glEnable(GL_FRAMEBUFFER_SRGB);
 
     createOrResizeHDR();
+    printHDRBudget();
     glGenVertexArrays(1, &screenVAO);
 
-    // ---------- compile shaders ----------
-    auto S = [&](const char* p){ return loadFile(p); };
-
-    GLuint vs_basic = compileShader(GL_VERTEX_SHADER,   S("shaders/basic.vert").c_str(),  "basic.vert");
-    GLuint fs_basic = compileShader(GL_FRAGMENT_SHADER, S("shaders/basic.frag").c_str(),  "basic.frag");
-    progBasic = linkProgram(vs_basic, fs_basic, "progBasic");
-
-    GLuint vs_water = compileShader(GL_VERTEX_SHADER,   S("shaders/water.vert").c_str(),  "water.vert");
-    GLuint fs_water = compileShader(GL_FRAGMENT_SHADER, S("shaders/water.frag").c_str(),  "water.frag");
-    progWater = linkProgram(vs_water, fs_water, "progWater");
-
-    GLuint vs_fish  = compileShader(GL_VERTEX_SHADER,   S("shaders/fish.vert").c_str(),   "fish.vert");
-    GLuint fs_fish  = compileShader(GL_FRAGMENT_SHADER, S("shaders/fish.frag").c_str(),   "fish.frag");
-    progFish = linkProgram(vs_fish, fs_fish, "progFish");
-
-    GLuint vs_bub   = compileShader(GL_VERTEX_SHADER,   S("shaders/bubbles.vert").c_str(),"bubbles.vert");
-    GLuint fs_bub   = compileShader(GL_FRAGMENT_SHADER, S("shaders/bubbles.frag").c_str(),"bubbles.frag");
-    progBub = linkProgram(vs_bub, fs_bub, "progBub");
-
-    GLuint vs_plant = compileShader(GL_VERTEX_SHADER,   S("shaders/plant.vert").c_str(),  "plant.vert");
-    GLuint fs_plant = compileShader(GL_FRAGMENT_SHADER, S("shaders/plant.frag").c_str(),  "plant.frag");
-    progPlant = linkProgram(vs_plant, fs_plant, "progPlant");
-
-    // Screen tri VS reused for IBL/tonemap
-    GLuint vs_tri = compileShader(GL_VERTEX_SHADER,     S("shaders/tonemap.vert").c_str(),"tonemap.vert");
-
-    GLuint fs_tone = compileShader(GL_FRAGMENT_SHADER,  S("shaders/tonemap.frag").c_str(),"tonemap.frag");
-    progTone = linkProgram(vs_tri, fs_tone, "progTonemap");
-
-    // IBL passes
-    GLuint fs_envGen  = compileShader(GL_FRAGMENT_SHADER, S("shaders/ibl_cubegen.frag").c_str(),  "ibl_cubegen.frag");
-    GLuint fs_diffuse = compileShader(GL_FRAGMENT_SHADER, S("shaders/ibl_diffuse.frag").c_str(),   "ibl_diffuse.frag");
-    GLuint fs_spec    = compileShader(GL_FRAGMENT_SHADER, S("shaders/ibl_specular.frag").c_str(),  "ibl_specular.frag");
-    GLuint fs_brdf    = compileShader(GL_FRAGMENT_SHADER, S("shaders/ibl_brdf_lut.frag").c_str(),  "ibl_brdf_lut.frag");
-    progIBLGen  = linkProgram(vs_tri, fs_envGen,  "progIBLGen");
-    progIBLDiff = linkProgram(vs_tri, fs_diffuse, "progIBLDiff");
-    progIBLSpec = linkProgram(vs_tri, fs_spec,    "progIBLSpec");
-    progBRDF    = linkProgram(vs_tri, fs_brdf,    "progBRDF");
+    // ---------- startup task graph ----------
+    // File reads, OBJ parsing, mesh generation, the caustics bake and scene
+    // population run on workers; shader compilation, GL uploads and the IBL
+    // passes run on this thread as soon as their inputs are ready.
+    using Task = jobs::TaskGraph;
+    Task startup;
+
+    const char* shaderFiles[] = { "shaders/basic.vert", "shaders/basic.frag", "shaders/water.vert",
+                                  "shaders/water.frag", "shaders/fish.vert", "shaders/fish.frag",
+                                  "shaders/bubbles.vert", "shaders/bubbles.frag", "shaders/plant.vert",
+                                  "shaders/plant.frag", "shaders/tonemap.vert", "shaders/tonemap.frag",
+                                  "shaders/ibl_cubegen.frag", "shaders/ibl_diffuse.frag",
+                                  "shaders/ibl_specular.frag", "shaders/ibl_brdf_lut.frag" };
+    std::map<std::string, std::string> shaderSrc;
+    int readShaders = startup.add("read shaders", [&]{
+        for (const char* f : shaderFiles) shaderSrc[f] = loadFile(f);
+    });
+    int shaders = startup.add("compile shaders", [&]{
+        auto S = [&](const char* p){ return shaderSrc.at(p); };
+
+        GLuint vs_basic = compileShader(GL_VERTEX_SHADER,   S("shaders/basic.vert").c_str(),  "basic.vert");
+        GLuint fs_basic = compileShader(GL_FRAGMENT_SHADER, S("shaders/basic.frag").c_str(),  "basic.frag");
+        progBasic = linkProgram(vs_basic, fs_basic, "progBasic");
+
+        GLuint vs_water = compileShader(GL_VERTEX_SHADER,   S("shaders/water.vert").c_str(),  "water.vert");
+        GLuint fs_water = compileShader(GL_FRAGMENT_SHADER, S("shaders/water.frag").c_str(),  "water.frag");
+        progWater = linkProgram(vs_water, fs_water, "progWater");
+
+        GLuint vs_fish  = compileShader(GL_VERTEX_SHADER,   S("shaders/fish.vert").c_str(),   "fish.vert");
+        GLuint fs_fish  = compileShader(GL_FRAGMENT_SHADER, S("shaders/fish.frag").c_str(),   "fish.frag");
+        progFish = linkProgram(vs_fish, fs_fish, "progFish");
+
+        GLuint vs_bub   = compileShader(GL_VERTEX_SHADER,   S("shaders/bubbles.vert").c_str(),"bubbles.vert");
+        GLuint fs_bub   = compileShader(GL_FRAGMENT_SHADER, S("shaders/bubbles.frag").c_str(),"bubbles.frag");
+        progBub = linkProgram(vs_bub, fs_bub, "progBub");
+
+        GLuint vs_plant = compileShader(GL_VERTEX_SHADER,   S("shaders/plant.vert").c_str(),  "plant.vert");
+        GLuint fs_plant = compileShader(GL_FRAGMENT_SHADER, S("shaders/plant.frag").c_str(),  "plant.frag");
+        progPlant = linkProgram(vs_plant, fs_plant, "progPlant");
+
+        // Screen tri VS reused for IBL/tonemap
+        GLuint vs_tri = compileShader(GL_VERTEX_SHADER,     S("shaders/tonemap.vert").c_str(),"tonemap.vert");
+
+        GLuint fs_tone = compileShader(GL_FRAGMENT_SHADER,  S("shaders/tonemap.frag").c_str(),"tonemap.frag");
+        progTone = linkProgram(vs_tri, fs_tone, "progTonemap");
+
+        // IBL passes
+        GLuint fs_envGen  = compileShader(GL_FRAGMENT_SHADER, S("shaders/ibl_cubegen.frag").c_str(),  "ibl_cubegen.frag");
+        GLuint fs_diffuse = compileShader(GL_FRAGMENT_SHADER, S("shaders/ibl_diffuse.frag").c_str(),   "ibl_diffuse.frag");
+        GLuint fs_spec    = compileShader(GL_FRAGMENT_SHADER, S("shaders/ibl_specular.frag").c_str(),  "ibl_specular.frag");
+        GLuint fs_brdf    = compileShader(GL_FRAGMENT_SHADER, S("shaders/ibl_brdf_lut.frag").c_str(),  "ibl_brdf_lut.frag");
+        progIBLGen  = linkProgram(vs_tri, fs_envGen,  "progIBLGen");
+        progIBLDiff = linkProgram(vs_tri, fs_diffuse, "progIBLDiff");
+        progIBLSpec = linkProgram(vs_tri, fs_spec,    "progIBLSpec");
+        progBRDF    = linkProgram(vs_tri, fs_brdf,    "progBRDF");
+    }, {readShaders}, Task::Main);
+
+    int envIBL = startup.add("IBL environment", []{ generateEnvCube(256); }, {shaders}, Task::Main);   // procedural HDR environment
+    startup.add("IBL irradiance", []{ generateIrradiance(32); }, {envIBL}, Task::Main);                // diffuse irradiance
+    startup.add("IBL prefilter", []{ generatePrefilter(128); }, {envIBL}, Task::Main);                 // specular prefilter mip chain
+    startup.add("IBL BRDF LUT", []{ generateBRDF(256); }, {shaders}, Task::Main);                       // BRDF LUT
 
     // ---------- geometry ----------
     const float TANK_W = 5.0f, TANK_H = 2.8f, TANK_D = 3.0f;
-    glassTankMesh = makeGlassTank(TANK_W, TANK_H, TANK_D, 0.08f);  // Glass container with thick walls
-    tankBaseMesh = makeTankBase(TANK_W, TANK_H, TANK_D);           // Base stand for the tank
-    waterVolumeMesh = makeWaterVolume(TANK_W, TANK_H, TANK_D, 0.85f); // Water volume (85% full)
-    floorMesh = makeFloor(TANK_W*0.9f, TANK_D*0.9f, -TANK_HEIGHT);   // Sand floor inside tank
-    waterMesh = makeWaterPlane(160, 160, TANK_W*0.9f, TANK_D*0.9f, waterY); // Water surface (kept for effects)
-    
-    // Load specific OBJ fish models from root directory
-    std::cout << "Loading fish models from root directory..." << std::endl;
-    fishMesh = loadOBJModel("fish.obj");                           // Generic fish for smaller species
-    clownfishMesh = loadOBJModel("koi_fish.obj");                  // Koi for clownfish (orange/red)
-    angelfishMesh = loadOBJModel("bream_fish__dorade_royale.obj"); // Bream for angelfish (silver)
-    animatedFishMesh = loadOBJModel("fish_animated.obj");          // Animated for goldfish
-    
-    std::cout << "Fish models loading complete!" << std::endl;
+    struct MeshJob { const char* name; Mesh* out; std::function<MeshData()> build; };
+    MeshJob meshJobs[] = {
+        {"glass tank",    &glassTankMesh,   [&]{ return makeGlassTank(TANK_W, TANK_H, TANK_D, 0.08f); }},  // Glass container with thick walls
+        {"tank base",     &tankBaseMesh,    [&]{ return makeTankBase(TANK_W, TANK_H, TANK_D); }},          // Base stand for the tank
+        {"water volume",  &waterVolumeMesh, [&]{ return makeWaterVolume(TANK_W, TANK_H, TANK_D, 0.85f); }}, // Water volume (85% full)
+        {"floor",         &floorMesh,       [&]{ return makeFloor(TANK_W*0.9f, TANK_D*0.9f, -TANK_HEIGHT); }},  // Sand floor inside tank
+        // Specific OBJ fish models from the working directory
+        {"fish.obj",      &fishMesh,         []{ return loadOBJModel("fish.obj"); }},                       // Generic fish for smaller species
+        {"koi_fish.obj",  &clownfishMesh,    []{ return loadOBJModel("koi_fish.obj"); }},                   // Koi for clownfish (orange/red)
+        {"bream_fish.obj", &angelfishMesh,   []{ return loadOBJModel("bream_fish__dorade_royale.obj"); }},  // Bream for angelfish (silver)
+        {"fish_animated.obj", &animatedFishMesh, []{ return loadOBJModel("fish_animated.obj"); }},          // Animated for goldfish
+        {"plant",         &plantMesh,         []{ return makePlantStrip(); }},
+        {"rock",          &rockMesh,          []{ return makeRockDome(); }},
+        {"coral",         &coralMesh,         []{ return makeCoral(); }},
+        {"shell",         &shellMesh,         []{ return makeShell(); }},
+        {"driftwood",     &driftwoodMesh,     []{ return makeDriftwood(); }},
+        {"anemone",       &anemoneMesh,       []{ return makeAnemone(); }},
+        {"starfish",      &starfishMesh,      []{ return makeStarfish(); }},
+        {"kelp",          &kelpMesh,          []{ return makeKelp(); }},
+        {"treasure chest", &treasureChestMesh, []{ return makeTreasureChest(); }},
+        {"food pellet", &foodMesh, []{ return makeBox(0.012f, 0.008f, 0.012f); }},
+    };
+    MeshData meshData[std::size(meshJobs)];
+    std::vector<int> meshStages;
+    for (size_t i=0;i<std::size(meshJobs);++i) {
+        const MeshJob& j = meshJobs[i];
+        MeshData& d = meshData[i];
+        int build = startup.add(std::string("build ") + j.name, [&j, &d]{ d = j.build(); });
+        meshStages.push_back(startup.add(std::string("stage ") + j.name, [&j, &d]{ *j.out = addToMeshArena(j.name, d); d = MeshData(); },
+                                          {build}, Task::Main));
+    }
+    int arena = startup.add("upload mesh arena", []{ uploadMeshArena(); }, meshStages, Task::Main);
+
+    startup.add("water", [&]{ initWater(TANK_W*0.9f, TANK_D*0.9f); }, {}, Task::Main);
+    CausticsBake caustics;
+    int bakeCaustics = startup.add("caustics", [&]{ caustics = bakeAmbientCaustics(); });
+    startup.add("upload caustics", [&]{ uploadCaustics(caustics); caustics = CausticsBake(); }, {bakeCaustics}, Task::Main);
+
+    // ---------- tanks ----------
+    // One task per tank: each draws from its own rng, so they populate in parallel
+    std::vector<int> populate = {arena};
+    for (size_t i=0;i<tanks.size();++i)
+        populate.push_back(startup.add("populate tank " + std::to_string(i), [i]{ populateTank(tanks[i], scene); }));
+    startup.add("fish instancing", []{ setupAllFishInstancing(); }, populate, Task::Main);
+    startup.add("tank instances & bubbles", []{ setupTankInstancing(); initBubbles(); initFood(); }, populate, Task::Main);
+
+    startup.run();
+    std::cout << "Startup timeline (" << jobs::threadCount() << " threads):" << std::endl;
+    startup.printTimeline(std::cout);
+    std::cout << "Startup graph: " << startup.wallMs() << " ms" << std::endl;
+
     std::cout << "Setting up fish species with their assigned models:" << std::endl;
     std::cout << "- Clownfish: " << (clownfishMesh.idxCount > 0 ? "koi_fish.obj loaded" : "using fallback") << " (" << clownfishMesh.idxCount << " indices)" << std::endl;
     std::cout << "- Angelfish: " << (angelfishMesh.idxCount > 0 ? "bream_fish.obj loaded" : "using fallback") << " (" << angelfishMesh.idxCount << " indices)" << std::endl;
     std::cout << "- Goldfish: " << (animatedFishMesh.idxCount > 0 ? "fish_animated.obj loaded" : "using fallback") << " (" << animatedFishMesh.idxCount << " indices)" << std::endl;
     std::cout << "- Other species: " << (fishMesh.idxCount > 0 ? "fish.obj loaded" : "using fallback") << " (" << fishMesh.idxCount << " indices)" << std::endl;
-    std::cout << "Fish counts: Clown=" << N_CLOWN << ", Neon=" << N_NEON << ", Danio=" << N_DANIO 
-              << ", Angelfish=" << N_ANGELFISH << ", Goldfish=" << N_GOLDFISH 
-              << ", Betta=" << N_BETTA << ", Guppy=" << N_GUPPY << ", Platy=" << N_PLATY << std::endl;
+    std::cout << "Fish counts: Clown=" << scene.species[CLOWNFISH].count << ", Neon=" << scene.species[NEON_TETRA].count
+              << ", Danio=" << scene.species[ZEBRA_DANIO].count << ", Angelfish=" << scene.species[ANGELFISH].count
+              << ", Goldfish=" << scene.species[GOLDFISH].count << ", Betta=" << scene.species[BETTA].count
+              << ", Guppy=" << scene.species[GUPPY].count << ", Platy=" << scene.species[PLATY].count << std::endl;
     std::cout << "Tank extents: " << TANK_EXTENTS.x << "x" << TANK_EXTENTS.y << "x" << TANK_EXTENTS.z << std::endl;
-    std::cout << "Water level: " << waterY << std::endl;
-    
-    plantMesh = makePlantStrip();
-    rockMesh  = makeRockDome();
-    coralMesh = makeCoral();
-    shellMesh = makeShell();
-    driftwoodMesh = makeDriftwood();
-    anemoneMesh = makeAnemone();
-    starfishMesh = makeStarfish();
-    kelpMesh = makeKelp();
-    treasureChestMesh = makeTreasureChest();
-
-    // ---------- species ----------
-    auto initSpeciesVec_ = ::initSpeciesVec;
-    // Adjust Y ranges to be within proper tank bounds
-    initSpeciesVec_(clownfish, N_CLOWN, CLOWNFISH,
-                    {1.0f,0.55f,0.20f}, {0.2f,0.1f,0.1f},
-                    {1.2f,0.9f,1.0f},   {0.25f,0.1f,0.2f},
-                    0.4f,0.8f, -0.8f,  waterY-0.2f, 1.0f, 1.3f);
-    initSpeciesVec_(neon, N_NEON, NEON_TETRA,
-                    {0.20f,0.85f,1.0f}, {0.2f,0.2f,0.2f},
-                    {1.0f,0.7f,0.8f},   {0.2f,0.15f,0.15f},
-                    0.5f,1.0f, -0.6f,   waterY-0.15f, 0.8f, 1.0f);
-    initSpeciesVec_(danio, N_DANIO, ZEBRA_DANIO,
-                    {0.9f,0.85f,0.55f}, {0.2f,0.2f,0.2f},
-                    {1.3f,0.8f,0.9f},   {0.25f,0.12f,0.2f},
-                    0.6f,1.2f, -0.7f,   waterY-0.12f, 0.9f, 1.1f);
-    initSpeciesVec_(angelfish, N_ANGELFISH, ANGELFISH,
-                    {0.8f,0.8f,0.9f}, {0.3f,0.3f,0.3f},
-                    {1.5f,1.2f,0.6f},   {0.3f,0.2f,0.1f},
-                    0.3f,0.6f, -0.5f,   waterY-0.25f, 1.3f, 1.6f);
-    initSpeciesVec_(goldfish, N_GOLDFISH, GOLDFISH,
-                    {1.0f,0.7f,0.2f}, {0.2f,0.1f,0.1f},
-                    {1.1f,0.9f,1.0f},   {0.2f,0.15f,0.2f},
-                    0.2f,0.5f, -0.4f,   waterY-0.3f, 1.4f, 1.8f);
-    initSpeciesVec_(betta, N_BETTA, BETTA,
-                    {0.8f,0.3f,0.8f}, {0.3f,0.2f,0.3f},
-                    {1.0f,1.4f,0.7f},   {0.2f,0.3f,0.15f},
-                    0.3f,0.7f, -0.3f,   waterY-0.15f, 1.1f, 1.4f);
-    initSpeciesVec_(guppy, N_GUPPY, GUPPY,
-                    {0.3f,0.8f,0.9f}, {0.2f,0.3f,0.2f},
-                    {0.8f,0.6f,0.7f},   {0.15f,0.1f,0.15f},
-                    0.5f,0.9f, -0.6f,   waterY-0.1f, 0.6f, 0.8f);
-    initSpeciesVec_(platy, N_PLATY, PLATY,
-                    {0.9f,0.4f,0.6f}, {0.2f,0.2f,0.2f},
-                    {0.9f,0.7f,0.8f},   {0.15f,0.1f,0.15f},
-                    0.4f,0.8f, -0.5f,   waterY-0.12f, 0.7f, 0.9f);
-
-    setupFishInstancing(vboClown, clownfishMesh, N_CLOWN);        // Use koi model for clownfish
-    setupFishInstancing(vboNeon,  fishMesh, N_NEON);            // Use generic fish for neon tetras
-    setupFishInstancing(vboDanio, fishMesh, N_DANIO);           // Use generic fish for danios
-    setupFishInstancing(vboAngelfish, angelfishMesh, N_ANGELFISH); // Use bream model for angelfish
-    setupFishInstancing(vboGoldfish, animatedFishMesh, N_GOLDFISH); // Use animated fish for goldfish
-    setupFishInstancing(vboBetta, fishMesh, N_BETTA);            // Use generic fish for bettas
-    setupFishInstancing(vboGuppy, fishMesh, N_GUPPY);            // Use generic fish for guppies
-    setupFishInstancing(vboPlaty, fishMesh, N_PLATY);            // Use generic fish for platies
-
-    initPlantsAndRocks();
-    initBubbles();
-
-    // ---------- IBL generation ----------
-    generateEnvCube(256);     // procedural HDR environment
-    generateIrradiance(32);   // diffuse irradiance
-    generatePrefilter(128);   // specular prefilter mip chain
-    generateBRDF(256);        // BRDF LUT
+    std::cout << "Water level: " << scene.waterY << std::endl;
+
+    // ---------- snapshot / record / replay ----------
+    // A recording is paired with the snapshot it starts from (<recording>.snap).
+    float simTime = 0.0f;
+    ReplayRecorder recorder;
+    ReplayPlayer player;
+    if (!replayPath.empty()) snapshotIn = replayPath + ".snap";
+    if (!snapshotIn.empty() && !loadSnapshot(snapshotIn, simTime)) { glfwTerminate(); return -1; }
+    if (!replayPath.empty()) {
+        if (!player.open(replayPath)) { glfwTerminate(); return -1; }
+        std::cout << "Replaying " << player.frameCount() << " frames from " << replayPath << std::endl;
+    }
+    if (!recordPath.empty() || !replayPath.empty()) {
+        // The bubble budget throttles emission by wall-clock time, which would
+        // make the run depend on the machine: recordings emit at a fixed rate
+        for (Tank& t : tanks) t.bubbles.budgetMs = 0.0f;
+    }
+    if (!recordPath.empty()) {
+        if (!saveSnapshot(recordPath + ".snap", simTime) || !recorder.open(recordPath)) { glfwTerminate(); return -1; }
+        std::cout << "Recording to " << recordPath << std::endl;
+    }
+    size_t replayMismatches = 0, firstMismatch = 0;
+    double replaySimMs = 0.0;
 
     // ---------- common params ----------
     glm::vec3 lightDir = glm::normalize(glm::vec3(-0.7f,-1.2f,-0.35f));
@@ -1423,16 +1869,27 @@ int main(){
     std::cout << "- Tank base: wooden stand positioned below tank" << std::endl;
     std::cout << "- Tone mapping exposure: " << exposure << std::endl;
     
+    const Tank& tank0 = tanks[0];
     std::cout << "\n=== Aquarium Decorations ===" << std::endl;
-    std::cout << "- Rock clusters: " << N_ROCKS << " rocks in natural groupings (size: 0.25-0.6)" << std::endl;
-    std::cout << "- Coral garden: " << N_CORALS << " colorful corals spread throughout (size: 0.3-0.7)" << std::endl;
-    std::cout << "- Sea anemones: " << N_ANEMONES << " animated anemones with tentacles (size: 0.15-0.35)" << std::endl;
-    std::cout << "- Starfish: " << N_STARFISH << " starfish scattered on floor" << std::endl;
-    std::cout << "- Kelp forest: " << N_KELP << " tall 3D kelp in back corners" << std::endl;
-    std::cout << "- Shells: " << N_SHELLS << " shells scattered on sand" << std::endl;
-    std::cout << "- Driftwood: " << N_DRIFTWOOD << " weathered wood pieces" << std::endl;
-    std::cout << "- Plants: " << N_PLANTS << " 3D animated aquatic plants (4 strips each)" << std::endl;
-    std::cout << "- Treasure chests: " << N_DECORATIONS << " decorative treasure chests" << std::endl;
+    std::cout << "- Rock clusters: " << tank0.decor[ROCKS].size() << " rocks in natural groupings (size: 0.25-0.6)" << std::endl;
+    std::cout << "- Coral garden: " << tank0.decor[CORALS].size() << " colorful corals spread throughout (size: 0.3-0.7)" << std::endl;
+    std::cout << "- Sea anemones: " << tank0.decor[ANEMONES].size() << " animated anemones with tentacles (size: 0.15-0.35)" << std::endl;
+    std::cout << "- Starfish: " << tank0.decor[STARFISH].size() << " starfish scattered on floor" << std::endl;
+    std::cout << "- Kelp forest: " << tank0.decor[KELP].size() << " tall 3D kelp in back corners" << std::endl;
+    std::cout << "- Shells: " << tank0.decor[SHELLS].size() << " shells scattered on sand" << std::endl;
+    std::cout << "- Driftwood: " << tank0.decor[DRIFTWOOD].size() << " weathered wood pieces" << std::endl;
+    std::cout << "- Plants: " << tank0.plantPos.size() << " 3D animated aquatic plants (4 strips each)" << std::endl;
+    std::cout << "- Treasure chests: " << tank0.decor[CHESTS].size() << " decorative treasure chests" << std::endl;
+    std::cout << "- Bubbles: " << tank0.bubbles.emitters.size() << " emitters, pool of " << tank0.bubbles.capacity()
+              << " (stateless GPU mode: " << scene.gpuBubbles << ")" << std::endl;
+    if (tanks.size() > 1)
+        std::cout << "- Tanks: " << tanks.size() << " (counts above are per tank; tank 0 has the water surface)" << std::endl;
+    std::cout << "- Water: " << water.resolution() << "x" << water.resolution() << " heightfield, "
+              << water.substeps() << " substeps per " << (int)water.stepHz << " Hz step" << std::endl;
+    std::cout << "- Simulation: " << (threadedSim ? "own thread, pipelined one frame ahead of rendering" : "on the render thread") << std::endl;
+    if (gpuBudgetMs > 0.0f)
+        std::cout << "- Dynamic resolution: " << gpuBudgetMs << " ms GPU budget, scale "
+                  << RENDER_SCALE_MIN << "-1.0 (shown in the window title)" << std::endl;
     
     std::cout << "\n=== Controls ===" << std::endl;
     std::cout << "- WASD/QE: Camera movement" << std::endl;
@@ -1441,6 +1898,11 @@ int main(){
     std::cout << "- SPACE: Pause/unpause simulation" << std::endl;
     std::cout << "- 1-5: Time scale (0.25x to 4x)" << std::endl;
     std::cout << "- F1: Toggle wireframe" << std::endl;
+    std::cout << "- B: Toggle CPU / stateless GPU bubbles" << std::endl;
+    std::cout << "- F: Feed the fish" << std::endl;
+    std::cout << "- F5 / F6: Save / load snapshot (aquarium.snap)" << std::endl;
+    std::cout << "- M: Print memory report (also printed at exit)" << std::endl;
+    std::cout << "- F9: Start/stop video capture (" << capturePath << ")" << std::endl;
     std::cout << "- ESC: Exit" << std::endl;
     
     std::cout << "\n=== Project Objectives Status ===" << std::endl;
@@ -1450,9 +1912,22 @@ int main(){
     std::cout << "✅ 4. PBR lighting: IBL with irradiance/specular maps, BRDF LUT, HDR pipeline" << std::endl;
     std::cout << "✅ 5. Camera & controls: Orbit/fly modes, pause, time scaling, full interaction" << std::endl;
 
+    auto startSim = [&]{ simThread.start([&simTime](float dt, SimFrame& out){ simulateInto(dt, out, simTime); }); };
+    if (captureAtStart && !startCapture()) { glfwTerminate(); return -1; }
+    publishLodCamera(camPos);
+    if (threadedSim) startSim();
+
     float last = (float)glfwGetTime();
+    float lastTitleUpdate = 0.0f;
+    bool firstFrame = true;
+    uint64_t frameIndex = 0, windowFrames = 0, windowAllocs = 0;
+    uint64_t steadyFrames = 0, steadyAllocs = 0, steadyAllocFrames = 0;
     while (!glfwWindowShouldClose(win)) {
+        frameArena.reset();
+        meshDrawCalls = 0;
+        uint64_t allocsAtFrameStart = allocstats::count();
         float now=(float)glfwGetTime();
+        auto frameStart = std::chrono::steady_clock::now();
         float rawDt = now-last; 
         float dt = paused ? 0.0f : rawDt * timeScale; // Apply time scaling and pause
         last=now;
@@ -1460,87 +1935,122 @@ int main(){
         glfwPollEvents();
         if (glfwGetKey(win, GLFW_KEY_ESCAPE)==GLFW_PRESS) glfwSetWindowShouldClose(win, 1);
         if (glfwGetKey(win, GLFW_KEY_F1)==GLFW_PRESS){ wireframe=!wireframe; glPolygonMode(GL_FRONT_AND_BACK, wireframe?GL_LINE:GL_FILL); }
-        process_input(win, rawDt); // Use raw dt for camera movement
-
-        // updates - improved fish bounding logic
-        auto updateSchool=[&](std::vector<FishInst>& fish, float yMin, float yMax, float maxSpeed, float cohesion=0.18f, float alignW=0.45f){
-            const float neighborDist2 = 0.18f, avoidDist2=0.06f;
-            for (auto &f : fish) {
-                glm::vec3 pos=f.pos, vel=f.vel;
-                glm::vec3 align(0), coh(0), sep(0); int count = 0;
-                for (auto &o : fish) {
-                    if (&o==&f) continue;
-                    glm::vec3 d = o.pos - pos; float d2 = glm::dot(d,d);
-                    if (d2 < neighborDist2) {
-                        align += o.vel; coh += o.pos; ++count;
-                        if (d2 < avoidDist2) sep -= d * (0.2f / std::max(d2, 1e-4f));
-                    }
-                }
-                if (count>0) { align = glm::normalize(align/(float)count) * 0.6f; coh = (coh/(float)count) - pos; }
-                
-                // Enhanced bounding forces - fish should stay well within tank
-                glm::vec3 steer(0); 
-                float boundaryForce = 3.0f;
-                float softBoundary = 0.85f; // Start applying force before reaching the boundary
-                glm::vec3 lim = TANK_EXTENTS * softBoundary;
-                
-                if (pos.x > lim.x) steer.x -= (pos.x-lim.x)*boundaryForce; 
-                if (pos.x < -lim.x) steer.x += (-lim.x-pos.x)*boundaryForce;
-                if (pos.z > lim.z) steer.z -= (pos.z-lim.z)*boundaryForce; 
-                if (pos.z < -lim.z) steer.z += (-lim.z-pos.z)*boundaryForce;
-                if (pos.y > yMax) steer.y -= (pos.y-yMax)*boundaryForce*2.0f; 
-                if (pos.y < yMin) steer.y += (yMin-pos.y)*boundaryForce*2.0f;
-                
-                glm::vec3 drift(std::sin(f.phase*0.7f)*0.1f, std::sin(f.phase*1.3f)*0.05f, std::cos(f.phase*0.9f)*0.1f);
-                glm::vec3 jitter(urand(rng)*0.08f, urand(rng)*0.04f, urand(rng)*0.08f);
-                vel += align*alignW + coh*cohesion + sep*1.15f + steer + drift*0.3f + jitter*0.25f;
-                float s=glm::length(vel); if (s>maxSpeed) vel*= (maxSpeed/s);
-                pos += vel*dt; 
-                
-                // Hard clamp as safety net
-                pos.x = std::clamp(pos.x, -TANK_EXTENTS.x*0.9f, TANK_EXTENTS.x*0.9f);
-                pos.z = std::clamp(pos.z, -TANK_EXTENTS.z*0.9f, TANK_EXTENTS.z*0.9f);
-                pos.y = std::clamp(pos.y, yMin, yMax);
-                
-                f.pos=pos; f.vel=vel; f.phase += dt*3.0f;
+
+        // Inputs that change the simulation go through the recording
+        uint32_t simInput = 0;
+        if (keyPressed(win, GLFW_KEY_B)) simInput |= REPLAY_INPUT_TOGGLE_GPU_BUBBLES;
+        if (keyPressed(win, GLFW_KEY_F)) simInput |= REPLAY_INPUT_FEED;
+        ReplayFrame rf;
+        bool replaying = player.next(rf);
+        if (replaying) {
+            dt = rf.dt; rawDt = rf.rawDt; simInput = rf.input;
+            camYaw = rf.camYaw; camPitch = rf.camPitch; camPos = rf.camPos;
+            camFront = glm::normalize(glm::vec3(std::cos(glm::radians(camYaw)) * std::cos(glm::radians(camPitch)),
+                                                std::sin(glm::radians(camPitch)),
+                                                std::sin(glm::radians(camYaw)) * std::cos(glm::radians(camPitch))));
+        } else {
+            bool save = keyPressed(win, GLFW_KEY_F5), load = keyPressed(win, GLFW_KEY_F6);
+            // A load replaces the state behind the recording's back, and the file
+            // may differ by the time it is replayed, so it is off while recording
+            if (load && recorder.active()) {
+                std::cerr << "Snapshot load ignored while recording" << std::endl;
+                load = false;
             }
-        };
-        updateSchool(clownfish, -0.8f, waterY-0.2f, 0.8f);
-        updateSchool(neon,      -0.6f, waterY-0.15f, 1.0f, 0.22f, 0.30f);
-        updateSchool(danio,     -0.7f, waterY-0.12f, 1.2f, 0.18f, 0.40f);
-        updateSchool(angelfish, -0.5f, waterY-0.25f, 0.6f, 0.15f, 0.35f);
-        updateSchool(goldfish,  -0.4f, waterY-0.3f, 0.5f, 0.12f, 0.25f);
-        updateSchool(betta,     -0.3f, waterY-0.15f, 0.7f, 0.20f, 0.45f);
-        updateSchool(guppy,     -0.6f, waterY-0.1f, 0.9f, 0.25f, 0.35f);
-        updateSchool(platy,     -0.5f, waterY-0.12f, 0.8f, 0.18f, 0.30f);
+            if (threadedSim && (save || load)) simThread.stop();
+            if (save) saveSnapshot("aquarium.snap", simTime);
+            if (load) loadSnapshot("aquarium.snap", simTime);
+            if (threadedSim && (save || load)) startSim();
+            process_input(win, rawDt); // Use raw dt for camera movement
+        }
+        if (keyPressed(win, GLFW_KEY_F9)) {
+            if (captureEncoder.isOpen()) stopCapture(); else startCapture();
+        }
+        if (captureEncoder.isOpen() && rawDt > 1.5f / captureFps) ++captureMetrics.slowFrames;
+        if (keyPressed(win, GLFW_KEY_M)) {
+            if (threadedSim) simThread.stop();
+            printMemoryReport();
+            if (threadedSim) startSim();
+        }
+        if (simInput & REPLAY_INPUT_TOGGLE_GPU_BUBBLES) {
+            // The stateless shader holds a fixed number of emitters; with more it
+            // would drop some, so those scenes stay on the CPU system
+            int emitters = bubbleEmitterCount();
+            if (!gpuBubbles && emitters > GPU_BUBBLE_EMITTERS) {
+                std::cerr << "Bubbles: " << emitters << " emitters over all tanks, the stateless GPU mode takes at most "
+                          << GPU_BUBBLE_EMITTERS << "; staying on the CPU particle system" << std::endl;
+            } else {
+                gpuBubbles = !gpuBubbles;
+                std::cout << "Bubbles: " << (gpuBubbles ? "stateless GPU" : "CPU particle system") << std::endl;
+            }
+        }
+        if (simInput & REPLAY_INPUT_FEED) {
+            ++feedRequests;
+            std::cout << "Feeding: " << scene.feedPellets << " pellets per tank" << std::endl;
+        }
+        publishLodCamera(camPos);
+        auto simStart = std::chrono::steady_clock::now();
+        if (threadedSim) {
+            simThread.setTimeScale(paused ? 0.0f : timeScale);
+            if (simThread.acquire()) uploadSimFrame(simThread.front());
+        } else {
+            simTime += dt;
+            simulateAndUpload(dt, simTime);
+        }
 
-        updateBubbles(dt);
+        if (recorder.active() || replaying) {
+            uint64_t hash = simStateHash();
+            if (recorder.active()) {
+                ReplayFrame f; f.dt = dt; f.rawDt = rawDt; f.input = simInput;
+                f.camYaw = camYaw; f.camPitch = camPitch; f.camPos = camPos; f.stateHash = hash;
+                recorder.write(f);
+            } else {
+                replaySimMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - simStart).count();
+                if (hash != rf.stateHash && replayMismatches++ == 0) firstMismatch = player.position() - 1;
+                if (!player.active()) {
+                    size_t n = player.frameCount();
+                    std::cout << "Replay finished: " << n << " frames, sim " << replaySimMs << " ms total ("
+                              << (n ? replaySimMs / n : 0.0) << " ms/frame), ";
+                    if (replayMismatches) std::cout << replayMismatches << " frames diverged, first at frame " << firstMismatch << std::endl;
+                    else                  std::cout << "bit-exact with the recording" << std::endl;
+                    glfwSetWindowShouldClose(win, 1);
+                }
+            }
+        }
 
         // ------------------- Render to HDR FBO -------------------
+        beginGpuTimer();
+        renderW = std::max(1, (int)(SCR_W * renderScale)); renderH = std::max(1, (int)(SCR_H * renderScale));
+        refrW = std::max(1, (int)(renderW * refractionScale)); refrH = std::max(1, (int)(renderH * refractionScale));
         glBindFramebuffer(GL_FRAMEBUFFER, hdrFBO);
-        glViewport(0,0,SCR_W,SCR_H);
+        glViewport(0,0,renderW,renderH);
         glClearColor(outsideColor.r, outsideColor.g, outsideColor.b, 1.0f); // Warm brown outside world
         glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
 
         glm::mat4 proj = glm::perspective(glm::radians(60.0f),(float)SCR_W/(float)SCR_H,0.05f,100.0f);
         glm::mat4 view = glm::lookAt(camPos, camPos+camFront, camUp);
+        setWaterUniforms(progBasic, now);
+        setWaterUniforms(progWater, now);
+
+        // One instanced draw per batch, covering every tank
+        auto drawDecorBatch = [&](const DecorBatch& b) {
+            if (!b.count) return;
+            glUniform1i(u(progBasic,"uMaterialType"), b.material);
+            glUniform1i(u(progBasic,"uApplyCaustics"), b.caustics ? 1 : 0);
+            aimDecorInstances(b.first);
+            drawMeshInstanced(*b.mesh, b.count);
+        };
 
-        // ===== Tank Base (Solid) =====
+        // ===== Tank Bases (Solid), Floors & Decorations =====
         glUseProgram(progBasic);
         glUniformMatrix4fv(u(progBasic,"uProj"),1,GL_FALSE,glm::value_ptr(proj));
         glUniformMatrix4fv(u(progBasic,"uView"),1,GL_FALSE,glm::value_ptr(view));
-        glm::mat4 baseModel = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -1.8f, 0.0f)); // Position base below tank
-        glUniformMatrix4fv(u(progBasic,"uModel"),1,GL_FALSE,glm::value_ptr(baseModel));
         glUniform3f(u(progBasic,"uLightDir"), lightDir.x,lightDir.y,lightDir.z);
         glUniform3f(u(progBasic,"uViewPos"), camPos.x, camPos.y, camPos.z);
         glUniform3f(u(progBasic,"uFogColor"), fogColor.r,fogColor.g,fogColor.b);
         glUniform1f(u(progBasic,"uFogNear"),  fogNear);
         glUniform1f(u(progBasic,"uFogFar"),   fogFar);
         glUniform1f(u(progBasic,"uTime"),     now);
-        glUniform1i(u(progBasic,"uApplyCaustics"), 0);
-        glUniform1i(u(progBasic,"uMaterialType"), 6); // Wood/base material
         glUniform1f(u(progBasic,"uAlpha"), 1.0f);
-        glUniform3f(u(progBasic,"uBaseColor"), 0.4f, 0.25f, 0.15f); // Dark wood color
         glActiveTexture(GL_TEXTURE1); glBindTexture(GL_TEXTURE_CUBE_MAP, irrCube);
         glUniform1i(u(progBasic,"uIrradiance"), 1);
         glActiveTexture(GL_TEXTURE2); glBindTexture(GL_TEXTURE_CUBE_MAP, prefilterCube);
@@ -1548,137 +2058,21 @@ int main(){
         glActiveTexture(GL_TEXTURE3); glBindTexture(GL_TEXTURE_2D, brdfLUT);
         glUniform1i(u(progBasic,"uBRDFLUT"), 3);
         glUniform1f(u(progBasic,"uPrefLodMax"), (float)prefilterMaxMip);
-        glBindVertexArray(tankBaseMesh.vao);
-        glDrawElements(GL_TRIANGLES, tankBaseMesh.idxCount, GL_UNSIGNED_INT, 0);
-
-        // ===== Floor (sand) =====
-        glUniformMatrix4fv(u(progBasic,"uModel"),1,GL_FALSE,glm::value_ptr(glm::mat4(1.0f)));
-        glUniform1i(u(progBasic,"uApplyCaustics"), 1);
+        glBindVertexArray(decorVAO);
+        drawDecorBatch(tankBaseBatch);
+        drawDecorBatch(floorBatch);
+        for (const DecorStyle& st : decorStyles) drawDecorBatch(decorBatches[st.kind]);
         glUniform1i(u(progBasic,"uMaterialType"), 0);
-        glUniform3f(u(progBasic,"uBaseColor"), 0.78f, 0.72f, 0.52f);
-        glBindVertexArray(floorMesh.vao);
-        glDrawElements(GL_TRIANGLES, floorMesh.idxCount, GL_UNSIGNED_INT, 0);
-
-        // ===== Decorations =====
-        glUniform1i(u(progBasic,"uApplyCaustics"), 0);
-        glUniform1i(u(progBasic,"uMaterialType"), 1);
-        for (int i=0;i<N_ROCKS;++i) {
-            glm::vec4 r = rocks[i];
-            glm::mat4 M = glm::translate(glm::mat4(1.0f), glm::vec3(r.x, r.y, r.z))
-                        * glm::scale(glm::mat4(1.0f), glm::vec3(r.w));
-            glUniformMatrix4fv(u(progBasic,"uModel"),1,GL_FALSE,glm::value_ptr(M));
-            glUniform3f(u(progBasic,"uBaseColor"), 0.35f+0.12f*(float)i/N_ROCKS, 0.30f, 0.26f);
-            glBindVertexArray(rockMesh.vao);
-            glDrawElements(GL_TRIANGLES, rockMesh.idxCount, GL_UNSIGNED_INT, 0);
-        }
-        
-        glUniform1i(u(progBasic,"uMaterialType"), 2);
-        for (int i=0;i<N_CORALS;++i) {
-            glm::vec4 c = corals[i];
-            glm::mat4 M = glm::translate(glm::mat4(1.0f), glm::vec3(c.x, c.y, c.z))
-                        * glm::scale(glm::mat4(1.0f), glm::vec3(c.w));
-            glUniformMatrix4fv(u(progBasic,"uModel"),1,GL_FALSE,glm::value_ptr(M));
-            glUniform3f(u(progBasic,"uBaseColor"), 0.8f+0.2f*(float)i/N_CORALS, 0.3f+0.2f*(float)i/N_CORALS, 0.4f+0.3f*(float)i/N_CORALS);
-            glBindVertexArray(coralMesh.vao);
-            glDrawElements(GL_TRIANGLES, coralMesh.idxCount, GL_UNSIGNED_INT, 0);
-        }
-        
-        glUniform1i(u(progBasic,"uMaterialType"), 3);
-        for (int i=0;i<N_SHELLS;++i) {
-            glm::vec4 s = shells[i];
-            glm::mat4 M = glm::translate(glm::mat4(1.0f), glm::vec3(s.x, s.y, s.z))
-                        * glm::rotate(glm::mat4(1.0f), (float)i * 0.7f, glm::vec3(0,1,0))
-                        * glm::scale(glm::mat4(1.0f), glm::vec3(s.w));
-            glUniformMatrix4fv(u(progBasic,"uModel"),1,GL_FALSE,glm::value_ptr(M));
-            glUniform3f(u(progBasic,"uBaseColor"), 0.9f+0.1f*(float)i/N_SHELLS, 0.85f+0.1f*(float)i/N_SHELLS, 0.7f+0.2f*(float)i/N_SHELLS);
-            glBindVertexArray(shellMesh.vao);
-            glDrawElements(GL_TRIANGLES, shellMesh.idxCount, GL_UNSIGNED_INT, 0);
-        }
-        
-        glUniform1i(u(progBasic,"uMaterialType"), 4);
-        for (int i=0;i<N_DRIFTWOOD;++i) {
-            glm::vec4 d = driftwood[i];
-            glm::mat4 M = glm::translate(glm::mat4(1.0f), glm::vec3(d.x, d.y, d.z))
-                        * glm::rotate(glm::mat4(1.0f), (float)i * 0.5f, glm::vec3(0,1,0))
-                        * glm::scale(glm::mat4(1.0f), glm::vec3(d.w));
-            glUniformMatrix4fv(u(progBasic,"uModel"),1,GL_FALSE,glm::value_ptr(M));
-            glUniform3f(u(progBasic,"uBaseColor"), 0.4f+0.2f*(float)i/N_DRIFTWOOD, 0.25f+0.1f*(float)i/N_DRIFTWOOD, 0.15f+0.1f*(float)i/N_DRIFTWOOD);
-            glBindVertexArray(driftwoodMesh.vao);
-            glDrawElements(GL_TRIANGLES, driftwoodMesh.idxCount, GL_UNSIGNED_INT, 0);
-        }
-        
-        // Sea Anemones
-        glUniform1i(u(progBasic,"uMaterialType"), 8);
-        for (int i=0;i<N_ANEMONES;++i) {
-            glm::vec4 a = anemones[i];
-            glm::mat4 M = glm::translate(glm::mat4(1.0f), glm::vec3(a.x, a.y, a.z))
-                        * glm::scale(glm::mat4(1.0f), glm::vec3(a.w));
-            glUniformMatrix4fv(u(progBasic,"uModel"),1,GL_FALSE,glm::value_ptr(M));
-            float hue = (float)i / N_ANEMONES;
-            glUniform3f(u(progBasic,"uBaseColor"), 0.8f + 0.2f*std::sin(hue*6.28f), 0.4f + 0.3f*std::cos(hue*4.0f), 0.6f + 0.4f*std::sin(hue*8.0f));
-            glBindVertexArray(anemoneMesh.vao);
-            glDrawElements(GL_TRIANGLES, anemoneMesh.idxCount, GL_UNSIGNED_INT, 0);
-        }
-        
-        // Starfish
-        glUniform1i(u(progBasic,"uMaterialType"), 9);
-        for (int i=0;i<N_STARFISH;++i) {
-            glm::vec4 s = starfish[i];
-            glm::mat4 M = glm::translate(glm::mat4(1.0f), glm::vec3(s.x, s.y, s.z))
-                        * glm::rotate(glm::mat4(1.0f), (float)i * 1.2f, glm::vec3(0,1,0))
-                        * glm::scale(glm::mat4(1.0f), glm::vec3(s.w));
-            glUniformMatrix4fv(u(progBasic,"uModel"),1,GL_FALSE,glm::value_ptr(M));
-            glUniform3f(u(progBasic,"uBaseColor"), 0.9f + 0.1f*(float)i/N_STARFISH, 0.5f + 0.3f*(float)i/N_STARFISH, 0.3f + 0.2f*(float)i/N_STARFISH);
-            glBindVertexArray(starfishMesh.vao);
-            glDrawElements(GL_TRIANGLES, starfishMesh.idxCount, GL_UNSIGNED_INT, 0);
-        }
-        
-        // Treasure Chests
-        glUniform1i(u(progBasic,"uMaterialType"), 10);
-        for (int i=0;i<N_DECORATIONS;++i) {
-            glm::vec4 t = decorations[i];
-            glm::mat4 M = glm::translate(glm::mat4(1.0f), glm::vec3(t.x, t.y, t.z))
-                        * glm::rotate(glm::mat4(1.0f), (float)i * 0.8f, glm::vec3(0,1,0))
-                        * glm::scale(glm::mat4(1.0f), glm::vec3(t.w));
-            glUniformMatrix4fv(u(progBasic,"uModel"),1,GL_FALSE,glm::value_ptr(M));
-            glUniform3f(u(progBasic,"uBaseColor"), 0.6f, 0.4f, 0.2f); // Bronze/gold color
-            glBindVertexArray(treasureChestMesh.vao);
-            glDrawElements(GL_TRIANGLES, treasureChestMesh.idxCount, GL_UNSIGNED_INT, 0);
+        if (foodDrawn) {
+            glUniform1i(u(progBasic,"uApplyCaustics"), 1);
+            glBindVertexArray(foodVAO);
+            drawMeshInstanced(foodMesh, foodDrawn);
         }
-        
-        glUniform1i(u(progBasic,"uMaterialType"), 0);
 
         // ===== Plants & Kelp =====
-        {
-            if (!plantVBO) glGenBuffers(1,&plantVBO);
-            // Combine regular plants and kelp for animated rendering
-            int totalPlants = N_PLANTS + N_KELP;
-            std::vector<float> data; data.resize(totalPlants*8);
-            
-            // Regular plants
-            for (int i=0;i<N_PLANTS;++i) {
-                int o=i*8;
-                data[o+0]=plantPos[i].x; data[o+1]=plantPos[i].y; data[o+2]=plantPos[i].z;
-                data[o+3]=plantHP[i].x;  data[o+4]=plantHP[i].y;
-                data[o+5]=plantColor[i].r; data[o+6]=plantColor[i].g; data[o+7]=plantColor[i].b;
-            }
-            
-            // Kelp forest
-            for (int i=0;i<N_KELP;++i) {
-                int o=(N_PLANTS+i)*8;
-                glm::vec4 k = kelp[i];
-                data[o+0]=k.x; data[o+1]=k.y; data[o+2]=k.z;
-                data[o+3]=k.w; data[o+4]=urand01(rng)*6.28f; // height and phase
-                data[o+5]=0.1f + 0.15f*urand01(rng); data[o+6]=0.4f + 0.3f*urand01(rng); data[o+7]=0.1f; // Kelp colors
-            }
-            
-            glBindBuffer(GL_ARRAY_BUFFER, plantVBO);
-            glBufferData(GL_ARRAY_BUFFER, data.size()*sizeof(float), data.data(), GL_DYNAMIC_DRAW);
-        }
         glUseProgram(progPlant);
         glUniformMatrix4fv(u(progPlant,"uProj"),1,GL_FALSE,glm::value_ptr(proj));
         glUniformMatrix4fv(u(progPlant,"uView"),1,GL_FALSE,glm::value_ptr(view));
-        glUniform1f(u(progPlant,"uTime"), now);
         glUniform3f(u(progPlant,"uLightDir"), lightDir.x,lightDir.y,lightDir.z);
         glUniform3f(u(progPlant,"uViewPos"), camPos.x, camPos.y, camPos.z);
         glUniform3f(u(progPlant,"uFogColor"), fogColor.r,fogColor.g,fogColor.b);
@@ -1688,57 +2082,27 @@ int main(){
         // Disable face culling for 3D plants to show from all angles
         glDisable(GL_CULL_FACE);
         
-        // Render regular plants
-        glBindVertexArray(plantMesh.vao);
-        glBindBuffer(GL_ARRAY_BUFFER, plantVBO);
-        glEnableVertexAttribArray(8);  glVertexAttribPointer(8,3,GL_FLOAT,GL_FALSE,sizeof(float)*8,(void*)0);                 glVertexAttribDivisor(8,1);
-        glEnableVertexAttribArray(9);  glVertexAttribPointer(9,2,GL_FLOAT,GL_FALSE,sizeof(float)*8,(void*)(sizeof(float)*3));  glVertexAttribDivisor(9,1);
-        glEnableVertexAttribArray(10); glVertexAttribPointer(10,3,GL_FLOAT,GL_FALSE,sizeof(float)*8,(void*)(sizeof(float)*5)); glVertexAttribDivisor(10,1);
-        glDrawElementsInstanced(GL_TRIANGLES, plantMesh.idxCount, GL_UNSIGNED_INT, 0, N_PLANTS);
-        
-        // Render kelp forest with kelp mesh
-        glBindVertexArray(kelpMesh.vao);
-        glDrawElementsInstanced(GL_TRIANGLES, kelpMesh.idxCount, GL_UNSIGNED_INT, 0, N_KELP);
+        // Render regular plants, then the kelp forest from the kelp range of the same stream
+        glActiveTexture(GL_TEXTURE0); glBindTexture(GL_TEXTURE_BUFFER, stalkTex);
+        glUniform1i(u(progPlant,"uNodes"), 0);
+        glBindVertexArray(plantVAO);
+        aimPlantInstances(0);
+        glUniform1i(u(progPlant,"uStalkBase"), 0);
+        glUniform1f(u(progPlant,"uMeshHeight"), PLANT_MESH_HEIGHT);
+        if (plantsDrawn) drawMeshInstanced(plantMesh, plantsDrawn);
+        aimPlantInstances(plantsDrawn);
+        glUniform1i(u(progPlant,"uStalkBase"), plantsDrawn);
+        glUniform1f(u(progPlant,"uMeshHeight"), KELP_MESH_HEIGHT);
+        if (kelpDrawn) drawMeshInstanced(kelpMesh, kelpDrawn);
         glBindVertexArray(0);
         
         // Re-enable face culling
         glEnable(GL_CULL_FACE);
 
         // ===== Fish =====
-        auto uploadFish = [&](const std::vector<FishInst>& species, GLuint vbo, const Mesh& mesh){
-            std::vector<float> inst; inst.resize(species.size()*15);
-            for (size_t i=0;i<species.size();++i) {
-                const auto &f = species[i];
-                glm::vec3 dir = glm::length(f.vel)>1e-6f ? glm::normalize(f.vel) : glm::vec3(0,0,-1);
-                size_t o = i*15;
-                inst[o+0]=f.pos.x; inst[o+1]=f.pos.y; inst[o+2]=f.pos.z;
-                inst[o+3]=dir.x;   inst[o+4]=dir.y;   inst[o+5]=dir.z;
-                inst[o+6]=f.phase; inst[o+7]=f.scale;
-                inst[o+8]=f.stretch.x; inst[o+9]=f.stretch.y; inst[o+10]=f.stretch.z;
-                inst[o+11]=f.color.r;  inst[o+12]=f.color.g;  inst[o+13]=f.color.b;
-                inst[o+14]=f.species;
-            }
-
-            glBindVertexArray(mesh.vao);
-            glBindBuffer(GL_ARRAY_BUFFER, vbo);
-            glBufferSubData(GL_ARRAY_BUFFER, 0, inst.size()*sizeof(float), inst.data());
-            glBindVertexArray(0);
-        };
-        
-        // Upload all fish data to their respective meshes
-        uploadFish(clownfish, vboClown, clownfishMesh);     // Koi model
-        uploadFish(neon,     vboNeon, fishMesh);            // Generic fish
-        uploadFish(danio,    vboDanio, fishMesh);           // Generic fish
-        uploadFish(angelfish, vboAngelfish, angelfishMesh); // Bream model  
-        uploadFish(goldfish,  vboGoldfish, animatedFishMesh); // Animated fish
-        uploadFish(betta,     vboBetta, fishMesh);          // Generic fish
-        uploadFish(guppy,     vboGuppy, fishMesh);          // Generic fish
-        uploadFish(platy,     vboPlaty, fishMesh);          // Generic fish
-
-        auto drawSpecies = [&](const std::vector<FishInst>& v, GLuint vbo, const Mesh& mesh){
-            if (v.empty()) return;
-            glBindVertexArray(mesh.vao);
-            glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        auto drawSpecies = [&](int s){
+            if (fishDrawn[s] == 0) return;
+            glBindVertexArray(speciesVAOs[s]);
             glUseProgram(progFish);
             glUniformMatrix4fv(u(progFish,"uProj"),1,GL_FALSE,glm::value_ptr(proj));
             glUniformMatrix4fv(u(progFish,"uView"),1,GL_FALSE,glm::value_ptr(view));
@@ -1755,40 +2119,29 @@ int main(){
             glActiveTexture(GL_TEXTURE3); glBindTexture(GL_TEXTURE_2D, brdfLUT);
             glUniform1i(u(progFish,"uBRDFLUT"), 3);
             glUniform1f(u(progFish,"uPrefLodMax"), (float)prefilterMaxMip);
-            glDrawElementsInstanced(GL_TRIANGLES, mesh.idxCount, GL_UNSIGNED_INT, 0, (GLsizei)v.size());
+            drawMeshInstanced(*speciesMeshes[s], fishDrawn[s]);
             glBindVertexArray(0);
         };
         
         // Draw all fish species with their specific models
-        drawSpecies(clownfish, vboClown, clownfishMesh);     // Koi model - orange/red
-        drawSpecies(neon,     vboNeon, fishMesh);            // Generic - blue
-        drawSpecies(danio,    vboDanio, fishMesh);           // Generic - yellow
-        drawSpecies(angelfish, vboAngelfish, angelfishMesh); // Bream model - silver
-        drawSpecies(goldfish,  vboGoldfish, animatedFishMesh); // Animated - gold
-        drawSpecies(betta,     vboBetta, fishMesh);          // Generic - purple
-        drawSpecies(guppy,     vboGuppy, fishMesh);          // Generic - cyan
-        drawSpecies(platy,     vboPlaty, fishMesh);          // Generic - pink
-
-        // copy opaque for refraction
+        for (int sp=0; sp<SPECIES_COUNT; ++sp) drawSpecies(sp);
+
+        // downscaled copy of the opaque scene for refraction
         glBindFramebuffer(GL_READ_FRAMEBUFFER, hdrFBO);
-        glBindTexture(GL_TEXTURE_2D, opaqueCopyTex);
-        glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, SCR_W, SCR_H);
-        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, refractFBO);
+        glBlitFramebuffer(0, 0, renderW, renderH, 0, 0, refrW, refrH, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+        glBindFramebuffer(GL_FRAMEBUFFER, hdrFBO);
 
         // ===== Water Volume (Blue Interior) =====
         glUseProgram(progBasic);
         glUniformMatrix4fv(u(progBasic,"uProj"),1,GL_FALSE,glm::value_ptr(proj));
         glUniformMatrix4fv(u(progBasic,"uView"),1,GL_FALSE,glm::value_ptr(view));
-        glUniformMatrix4fv(u(progBasic,"uModel"),1,GL_FALSE,glm::value_ptr(glm::mat4(1.0f)));
         glUniform3f(u(progBasic,"uLightDir"), lightDir.x,lightDir.y,lightDir.z);
         glUniform3f(u(progBasic,"uViewPos"), camPos.x, camPos.y, camPos.z);
         glUniform3f(u(progBasic,"uFogColor"), fogColor.r,fogColor.g,fogColor.b);
         glUniform1f(u(progBasic,"uFogNear"),  fogNear);
         glUniform1f(u(progBasic,"uFogFar"),   fogFar);
         glUniform1f(u(progBasic,"uTime"),     now);
-        glUniform1i(u(progBasic,"uApplyCaustics"), 1);
-        glUniform1i(u(progBasic,"uMaterialType"), 7); // Water volume material
-        glUniform3f(u(progBasic,"uBaseColor"), 0.1f, 0.5f, 0.9f); // Beautiful blue water
         glUniform1f(u(progBasic,"uAlpha"), 0.3f); // Semi-transparent water
         glActiveTexture(GL_TEXTURE1); glBindTexture(GL_TEXTURE_CUBE_MAP, irrCube);
         glUniform1i(u(progBasic,"uIrradiance"), 1);
@@ -1802,8 +2155,8 @@ int main(){
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
         glDepthMask(GL_FALSE);
         glDisable(GL_CULL_FACE); // Show water from all angles
-        glBindVertexArray(waterVolumeMesh.vao);
-        glDrawElements(GL_TRIANGLES, waterVolumeMesh.idxCount, GL_UNSIGNED_INT, 0);
+        glBindVertexArray(decorVAO);
+        drawDecorBatch(waterVolumeBatch);
         glEnable(GL_CULL_FACE);
         glDepthMask(GL_TRUE);
 
@@ -1811,14 +2164,52 @@ int main(){
         glUseProgram(progBub);
         glUniformMatrix4fv(u(progBub,"uProj"),1,GL_FALSE,glm::value_ptr(proj));
         glUniformMatrix4fv(u(progBub,"uView"),1,GL_FALSE,glm::value_ptr(view));
-        glBindVertexArray(bubbleVAO);
-        glDrawArrays(GL_POINTS, 0, N_BUB);
+        glUniform1i(u(progBub,"uStateless"), gpuBubbles ? 1 : 0);
+        glUniform1f(u(progBub,"uPointScale"), renderScale);
+        if (gpuBubbles) {
+            // Every tank's emitters, moved to world space
+            glm::vec4 em[GPU_BUBBLE_EMITTERS], spawn[GPU_BUBBLE_EMITTERS], rise[GPU_BUBBLE_EMITTERS];
+            const BubbleEmitter* src[GPU_BUBBLE_EMITTERS];
+            int ne = 0;
+            float totalRate = 0.0f;
+            for (const Tank& t : tanks)
+                for (const BubbleEmitter& e : t.bubbles.emitters) {
+                    if (ne == GPU_BUBBLE_EMITTERS) break;
+                    src[ne] = &e;
+                    em[ne] = glm::vec4(e.pos + t.origin, e.radius);
+                    rise[ne] = glm::vec4(e.riseMin, e.riseMax, t.waterY + t.origin.y, 0.0f);
+                    totalRate += std::max(e.rate, 0.0f);
+                    ++ne;
+                }
+            float share = 0.0f;
+            for (int i=0;i<ne;++i) {
+                const BubbleEmitter& e = *src[i];
+                share += totalRate > 0.0f ? std::max(e.rate, 0.0f) / totalRate : 1.0f / (float)ne;
+                spawn[i] = glm::vec4(share, e.sizeMin, e.sizeMax, e.drift);
+            }
+            glUniform1f(u(progBub,"uTime"), threadedSim ? simThread.front().simTime : simTime);
+            glUniform1i(u(progBub,"uEmitterCount"), ne);
+            if (ne > 0) {
+                glUniform4fv(u(progBub,"uEmitters"), ne, &em[0].x);
+                glUniform4fv(u(progBub,"uEmitterSpawn"), ne, &spawn[0].x);
+                glUniform4fv(u(progBub,"uEmitterRise"), ne, &rise[0].x);
+            }
+            glBindVertexArray(gpuBubbleVAO);
+            glDrawArrays(GL_POINTS, 0, scene.gpuBubbles * (int)tanks.size());   // gpu_count is per tank
+        } else {
+            glBindVertexArray(bubbleVAO);
+            glDrawArrays(GL_POINTS, 0, bubblesDrawn);
+        }
 
-        // ===== Water Surface (for effects) =====
+        // ===== Water Surface (projected grid) =====
+        ensureWaterGrid();
+        glm::vec4 waterNDC;
+        bool waterVisible = waterScreenBounds(proj*view, camPos.y, waterNDC);
         glUseProgram(progWater);
         glUniformMatrix4fv(u(progWater,"uProj"),1,GL_FALSE,glm::value_ptr(proj));
         glUniformMatrix4fv(u(progWater,"uView"),1,GL_FALSE,glm::value_ptr(view));
-        glUniformMatrix4fv(u(progWater,"uModel"),1,GL_FALSE,glm::value_ptr(glm::mat4(1.0f)));
+        glUniformMatrix4fv(u(progWater,"uInvViewProj"),1,GL_FALSE,glm::value_ptr(glm::inverse(proj*view)));
+        glUniform4f(u(progWater,"uGridNDC"), waterNDC.x, waterNDC.y, waterNDC.z, waterNDC.w);
         glUniform1f(u(progWater,"uTime"), now);
         glUniform3f(u(progWater,"uDeepColor"),    0.1f, 0.4f, 0.8f);   // Rich deep blue
         glUniform3f(u(progWater,"uShallowColor"), 0.3f, 0.8f, 1.0f);   // Bright aqua blue
@@ -1827,25 +2218,22 @@ int main(){
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, opaqueCopyTex);
         glUniform1i(u(progWater,"uSceneColor"), 0);
-        glBindVertexArray(waterMesh.vao);
+        glUniform2f(u(progWater,"uSceneUVScale"), (float)refrW/refrAllocW, (float)refrH/refrAllocH);
+        glBindVertexArray(waterGrid.vao);
         glDisable(GL_CULL_FACE);
-        glDrawElements(GL_TRIANGLES, waterMesh.idxCount, GL_UNSIGNED_INT, 0);
+        if (waterVisible) glDrawElements(GL_TRIANGLES, waterGrid.idxCount, GL_UNSIGNED_INT, 0);
         glEnable(GL_CULL_FACE);
 
         // ===== Crystal Clear Glass Tank =====
         glUseProgram(progBasic);
         glUniformMatrix4fv(u(progBasic,"uProj"),1,GL_FALSE,glm::value_ptr(proj));
         glUniformMatrix4fv(u(progBasic,"uView"),1,GL_FALSE,glm::value_ptr(view));
-        glUniformMatrix4fv(u(progBasic,"uModel"),1,GL_FALSE,glm::value_ptr(glm::mat4(1.0f)));
         glUniform3f(u(progBasic,"uLightDir"), lightDir.x,lightDir.y,lightDir.z);
         glUniform3f(u(progBasic,"uViewPos"), camPos.x, camPos.y, camPos.z);
         glUniform3f(u(progBasic,"uFogColor"), fogColor.r,fogColor.g,fogColor.b);
         glUniform1f(u(progBasic,"uFogNear"),  fogNear);
         glUniform1f(u(progBasic,"uFogFar"),   fogFar);
         glUniform1f(u(progBasic,"uTime"),     now);
-        glUniform1i(u(progBasic,"uApplyCaustics"), 0);
-        glUniform1i(u(progBasic,"uMaterialType"), 5); // Special glass material
-        glUniform3f(u(progBasic,"uBaseColor"), 0.98f, 0.99f, 1.0f); // Almost pure white glass
         glUniform1f(u(progBasic,"uAlpha"), 0.03f); // Ultra transparent glass
         glActiveTexture(GL_TEXTURE1); glBindTexture(GL_TEXTURE_CUBE_MAP, irrCube);
         glUniform1i(u(progBasic,"uIrradiance"), 1);
@@ -1858,8 +2246,8 @@ int main(){
         // Glass rendering with proper transparency
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
         glDepthMask(GL_FALSE); // Don't write to depth buffer for transparency
-        glBindVertexArray(glassTankMesh.vao);
-        glDrawElements(GL_TRIANGLES, glassTankMesh.idxCount, GL_UNSIGNED_INT, 0);
+        glBindVertexArray(decorVAO);
+        drawDecorBatch(glassBatch);
         glDepthMask(GL_TRUE);
 
         // ----- tonemap to screen -----
@@ -1870,11 +2258,74 @@ int main(){
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, hdrColorTex);
         glUniform1i(u(progTone,"uHDR"), 0);
+        glUniform2f(u(progTone,"uUVScale"), (float)renderW/hdrAllocW, (float)renderH/hdrAllocH);
+        glUniform2f(u(progTone,"uTexel"), 1.0f/hdrAllocW, 1.0f/hdrAllocH);
+        glUniform1f(u(progTone,"uSharpen"), renderScale < 1.0f ? 0.6f * (1.0f - renderScale) / (1.0f - RENDER_SCALE_MIN) : 0.0f);
         glUniform1f(u(progTone,"uExposure"), exposure);
         drawScreenTriangle();
         glEnable(GL_DEPTH_TEST);
+        endGpuTimer();
+        if (captureEncoder.isOpen()) captureFrame(SCR_W, SCR_H);
+        if (threadedSim) simThread.addRenderTime(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+
+        // Heap allocations this frame, before the title update below makes its own
+        uint64_t frameAllocs = allocstats::count() - allocsAtFrameStart;
+        windowAllocs += frameAllocs; ++windowFrames;
+        if (++frameIndex > ALLOC_WARMUP_FRAMES) {
+            ++steadyFrames; steadyAllocs += frameAllocs;
+            if (frameAllocs) ++steadyAllocFrames;
+        }
+
+        // Instrumentation: GPU time against the budget and the resolution it bought
+        if (now - lastTitleUpdate > 0.5f) {
+            lastTitleUpdate = now;
+            std::ostringstream t;
+            t.setf(std::ios::fixed); t.precision(1);
+            t << "AquariumGL | GPU " << gpuFrameMs << " ms";
+            if (gpuBudgetMs > 0.0f) t << " / " << gpuBudgetMs << " budget";
+            t.precision(2);
+            t << " | scale " << renderScale << " (" << renderW << "x" << renderH << ")";
+            if (threadedSim) {
+                // overlap > 1 means simulation and rendering ran concurrently
+                SimMetrics m = simThread.takeMetrics();
+                t << " | sim " << m.simMs << " ms, latency " << m.latencyMs << " ms, overlap " << m.overlap;
+                if (m.skipped) t << ", " << m.skipped << " skipped";
+            }
+            t << " | " << meshDrawCalls << " mesh draws";
+            if (tanks.size() > 1) t << ", " << tanks.size() << " tanks, step " << tankStepMs.load() << " ms";
+            if (foodDrawn) t << " | " << foodDrawn << " pellets";
+            if (simLod) {
+                int fish = 0;
+                for (int s=0;s<SPECIES_COUNT;++s) fish += fishDrawn[s];
+                t << " | LOD " << lodSteered.load() << "/" << fish << " fish steered";
+                if (tanks.size() == 1) t << ", step " << tankStepMs.load() << " ms";
+                if (lodDeferred.load()) t << ", " << lodDeferred.load() << " over budget";
+            }
+            if (captureEncoder.isOpen())
+                t << " | REC " << captureEncoder.stats().written << " frames, " << captureMetrics.cpuMs / std::max<uint64_t>(captureMetrics.frames, 1)
+                  << " ms/frame, " << captureMetrics.gpuBehind + captureMetrics.encoderBehind << " dropped";
+            t << " | heap " << (double)windowAllocs / windowFrames << " allocs/frame, arena " << frameArena.peak() / 1024 << " KB";
+            windowAllocs = 0; windowFrames = 0;
+            glfwSetWindowTitle(win, t.str().c_str());
+        }
 
         glfwSwapBuffers(win);
+        if (firstFrame) {
+            firstFrame = false;
+            std::cout << "Time to first frame: "
+                      << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - appStart).count() << " ms" << std::endl;
+        }
+    }
+    simThread.stop();
+    printMemoryReport();
+    stopCapture();
+    shmExport.close();
+    std::cout << "Heap allocations after " << ALLOC_WARMUP_FRAMES << " warm-up frames: " << steadyAllocs
+              << " in " << steadyFrames << " frames (" << steadyAllocFrames << " frames allocated); frame arena peak "
+              << frameArena.peak() / 1024 << " KB of " << frameArena.capacity() / 1024 << " KB" << std::endl;
+    if (recorder.active()) {
+        std::cout << "Recorded " << recorder.frames() << " frames to " << recordPath << std::endl;
+        recorder.close();
     }
     glfwTerminate();
     return 0;
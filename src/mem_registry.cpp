@@ -0,0 +1,73 @@
+#include "mem_registry.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace memreg {
+namespace {
+
+struct Registry {
+    std::mutex m;
+    // pool -> category -> name -> bytes
+    std::map<std::string, std::map<std::string, size_t>> cats[2];
+};
+Registry& registry() { static Registry r; return r; }
+
+std::string formatBytes(size_t b) {
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(b >= 1024 * 1024 ? 1 : 0);
+    if (b >= 1024 * 1024) os << b / (1024.0 * 1024.0) << " MB";
+    else if (b >= 1024)   os << b / 1024.0 << " KB";
+    else                  os << b << " B";
+    return os.str();
+}
+
+size_t sum(const std::map<std::string, size_t>& entries) {
+    size_t s = 0;
+    for (const auto& e : entries) s += e.second;
+    return s;
+}
+
+} // namespace
+
+void track(Pool pool, const std::string& category, const std::string& name, size_t bytes) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lk(r.m);
+    auto& cat = r.cats[pool][category];
+    if (bytes) { cat[name] = bytes; return; }
+    cat.erase(name);
+    if (cat.empty()) r.cats[pool].erase(category);
+}
+
+size_t total(Pool pool) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lk(r.m);
+    size_t s = 0;
+    for (const auto& c : r.cats[pool]) s += sum(c.second);
+    return s;
+}
+
+void report(std::ostream& os) {
+    size_t gpu = total(GPU), cpu = total(CPU);
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lk(r.m);
+    os << "=== Memory: GPU " << formatBytes(gpu) << ", CPU " << formatBytes(cpu) << " ===\n";
+    const char* poolNames[2] = { "GPU", "CPU" };
+    for (int p = 0; p < 2; ++p) {
+        std::vector<std::pair<size_t, const std::string*>> order;
+        for (const auto& c : r.cats[p]) order.push_back({ sum(c.second), &c.first });
+        std::sort(order.begin(), order.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+        for (const auto& o : order) {
+            os << poolNames[p] << "  " << std::left << std::setw(34) << *o.second << std::right << std::setw(10) << formatBytes(o.first) << "\n";
+            for (const auto& e : r.cats[p][*o.second])
+                os << "       " << std::left << std::setw(31) << e.first << std::right << std::setw(10) << formatBytes(e.second) << "\n";
+        }
+    }
+    os << std::flush;
+}
+
+} // namespace memreg
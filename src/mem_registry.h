@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+// ===========================================================
+// Memory registry: bytes per resource, by category
+// ===========================================================
+//
+// Creation sites record what they allocated under a category ("HDR targets",
+// "IBL", ...) and a name; recording the same name again replaces the old
+// size, so resizes and re-creations just re-register. GPU sizes are computed
+// from the formats and dimensions requested, not queried from the driver
+// (which adds padding and alignment of its own).
+namespace memreg {
+
+enum Pool { GPU, CPU };
+
+// bytes == 0 removes the entry. Thread-safe.
+void track(Pool pool, const std::string& category, const std::string& name, size_t bytes);
+size_t total(Pool pool);
+
+// Every entry grouped by pool and category, largest category first
+void report(std::ostream& os);
+
+} // namespace memreg
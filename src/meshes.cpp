@@ -0,0 +1,563 @@
+#include "meshes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// Create a proper fish mesh with good visibility
+MeshData createFishMesh() {
+    using V = MeshVertex;
+    std::vector<V> v; std::vector<unsigned> idx;
+    auto push = [&](const glm::vec3& p, const glm::vec3& n){ v.push_back({p, glm::normalize(n)}); };
+
+    const int segX=24, segR=16;
+    const float rMax=0.08f, zFlatten=0.7f; // Larger and more visible
+    for (int i=0; i<=segX; ++i) {
+        float t = (float)i / (float)segX;
+        float r = rMax * std::pow(std::sin(3.14159f * std::clamp(t*1.02f, 0.0f, 1.0f)), 0.75f);
+        if (i == 0) r *= 0.5f; // Head
+        if (i > segX * 0.8f) r *= 0.6f; // Tail taper
+        for (int j=0; j<=segR; ++j) {
+            float a = (2.0f * 3.14159f) * (float)j / (float)segR;
+            float cy = std::cos(a), sy = std::sin(a);
+            glm::vec3 p = { t * 0.25f, r * cy, zFlatten * r * sy }; // Scale down length
+            glm::vec3 n = { 0.0f, cy, (1.0f / zFlatten) * sy };
+            push(p, n);
+        }
+    }
+    int ring = segR + 1;
+    for (int i=0; i<segX; ++i) for (int j=0; j<segR; ++j) {
+        unsigned a = i*ring + j, b=a+1, c=(i+1)*ring + j, d=c+1;
+        idx.insert(idx.end(), {a,c,b, b,c,d});
+    }
+
+    // Add nose cap
+    glm::vec3 nose = {0.0f, 0.0f, 0.0f};
+    unsigned baseCenter = (unsigned)v.size();
+    v.push_back({nose, glm::vec3(-1,0,0)});
+    for (int j=0; j<segR; ++j) { 
+        unsigned a=j, b=(j+1)%segR; 
+        idx.insert(idx.end(), {baseCenter, a, b}); 
+    }
+    
+    // Add tail fin
+    float x = 0.26f;
+    glm::vec3 tU = {x,  0.12f,  0.0f}, tD = {x, -0.12f,  0.0f};
+    glm::vec3 baseL = {0.22f,  0.03f,  0.02f}, baseR = {0.22f, -0.03f,  0.02f};
+    glm::vec3 baseL2= {0.22f,  0.03f, -0.02f}, baseR2= {0.22f, -0.03f, -0.02f};
+    unsigned s = (unsigned)v.size();
+    v.push_back({tU,{0,0, 1}}); v.push_back({tD,{0,0, 1}}); v.push_back({baseL,{0,0, 1}}); v.push_back({baseR,{0,0, 1}});
+    v.push_back({tU,{0,0,-1}}); v.push_back({tD,{0,0,-1}}); v.push_back({baseL2,{0,0,-1}}); v.push_back({baseR2,{0,0,-1}});
+    idx.insert(idx.end(), {s+2,s+0,s+1,  s+2,s+1,s+3});
+    idx.insert(idx.end(), {s+5,s+7,s+4,  s+5,s+6,s+7});
+
+    return { std::move(v), std::move(idx) };
+}
+
+// Simple OBJ loader with better error reporting. Runs on a startup worker, so
+// each message goes out in a single write.
+MeshData loadOBJModel(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "ERROR: Failed to open OBJ file: " + filename + "\n"
+                     "Current working directory should contain: fish.obj, koi_fish.obj, bream_fish__dorade_royale.obj, fish_animated.obj\n"
+                     "Using fallback procedural mesh instead.\n";
+        return createFishMesh(); // Use our procedural fish mesh as fallback
+    }
+    
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;
+    std::vector<unsigned> indices;
+    
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream iss(line);
+        std::string type;
+        iss >> type;
+        
+        if (type == "v") {
+            float x, y, z;
+            iss >> x >> y >> z;
+            positions.push_back(glm::vec3(x, y, z));
+        } else if (type == "vn") {
+            float x, y, z;
+            iss >> x >> y >> z;
+            normals.push_back(glm::normalize(glm::vec3(x, y, z)));
+        } else if (type == "f") {
+            std::string vertex;
+            for (int i = 0; i < 3; ++i) {
+                iss >> vertex;
+                std::istringstream viss(vertex);
+                std::string index_str;
+                std::vector<int> indices_vertex;
+                
+                while (std::getline(viss, index_str, '/')) {
+                    if (index_str.empty()) {
+                        indices_vertex.push_back(0);
+                    } else {
+                        indices_vertex.push_back(std::stoi(index_str) - 1);
+                    }
+                }
+                
+                while (indices_vertex.size() < 3) {
+                    indices_vertex.push_back(0);
+                }
+                
+                indices.push_back(indices_vertex[0]);
+            }
+        }
+    }
+    
+    if (positions.empty()) {
+        std::cerr << "ERROR: No vertices found in OBJ file: " + filename + "\n";
+        return createFishMesh();
+    }
+    
+    // Scale to appropriate size for aquarium - make them quite large and visible
+    float scale = 0.15f; // Larger scale for better visibility
+    
+    std::cout << "SUCCESS: Loaded " + filename + " with " + std::to_string(positions.size()) + " vertices, "
+                 + std::to_string(indices.size()) + " indices\n";
+    
+    MeshData d;
+    d.v.reserve(positions.size());
+    for (size_t i = 0; i < positions.size(); ++i)
+        d.v.push_back({ positions[i] * scale, (i < normals.size()) ? normals[i] : glm::vec3(0, 1, 0) });
+    d.idx = std::move(indices);
+    return d;
+}
+
+MeshData makeBox(float w, float h, float d) {
+    float x=w*0.5f, y=h*0.5f, z=d*0.5f;
+    using V = MeshVertex;
+    std::vector<V> v; std::vector<unsigned> i;
+    auto addQuad=[&](glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 d, glm::vec3 n){
+        size_t base=v.size();
+        v.push_back({a,n}); v.push_back({b,n}); v.push_back({c,n}); v.push_back({d,n});
+        i.insert(i.end(), { (unsigned)base,(unsigned)base+2,(unsigned)base+1,
+                            (unsigned)base,(unsigned)base+3,(unsigned)base+2 });
+    };
+    addQuad({-x,-y, z},{ x,-y, z},{ x, y, z},{-x, y, z}, { 0, 0,-1});
+    addQuad({ x,-y,-z},{-x,-y,-z},{-x, y,-z},{ x, y,-z}, { 0, 0, 1});
+    addQuad({-x,-y,-z},{-x,-y, z},{-x, y, z},{-x, y,-z}, { 1, 0, 0});
+    addQuad({ x,-y, z},{ x,-y,-z},{ x, y,-z},{ x, y, z}, {-1, 0, 0});
+    addQuad({-x, y, z},{ x, y, z},{ x, y,-z},{-x, y,-z}, { 0,-1, 0});
+    return { std::move(v), std::move(i) };
+}
+
+MeshData makeGlassTank(float w, float h, float d, float thickness) {
+    float x=w*0.5f, y=h*0.5f, z=d*0.5f;
+    float t=thickness;
+    using V = MeshVertex;
+    std::vector<V> v; std::vector<unsigned> i;
+    auto addQuad=[&](glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 d, glm::vec3 n){
+        size_t base=v.size();
+        v.push_back({a,n}); v.push_back({b,n}); v.push_back({c,n}); v.push_back({d,n});
+        i.insert(i.end(), { (unsigned)base,(unsigned)base+2,(unsigned)base+1,
+                            (unsigned)base,(unsigned)base+3,(unsigned)base+2 });
+    };
+    
+    // Bottom glass panel (exterior)
+    addQuad({-x,-y-t,-z},{ x,-y-t,-z},{ x,-y-t, z},{-x,-y-t, z}, { 0, 1, 0});
+    // Bottom glass panel (interior)  
+    addQuad({-x,-y,-z},{-x,-y, z},{ x,-y, z},{ x,-y,-z}, { 0,-1, 0});
+    
+    // Left wall (exterior)
+    addQuad({-x-t,-y-t,-z},{-x-t, y,-z},{-x-t, y, z},{-x-t,-y-t, z}, { 1, 0, 0});
+    // Left wall (interior)
+    addQuad({-x,-y,-z},{-x,-y, z},{-x, y, z},{-x, y,-z}, {-1, 0, 0});
+    
+    // Right wall (exterior)
+    addQuad({ x+t,-y-t, z},{ x+t, y, z},{ x+t, y,-z},{ x+t,-y-t,-z}, {-1, 0, 0});
+    // Right wall (interior)
+    addQuad({ x,-y, z},{ x, y, z},{ x, y,-z},{ x,-y,-z}, { 1, 0, 0});
+    
+    // Front wall (exterior)
+    addQuad({-x-t,-y-t, z-t},{ x+t,-y-t, z-t},{ x+t, y, z-t},{-x-t, y, z-t}, { 0, 0,-1});
+    // Front wall (interior)
+    addQuad({-x,-y, z},{ x,-y, z},{ x, y, z},{-x, y, z}, { 0, 0, 1});
+    
+    // Back wall (exterior)
+    addQuad({ x+t,-y-t,-z-t},{-x-t,-y-t,-z-t},{-x-t, y,-z-t},{ x+t, y,-z-t}, { 0, 0, 1});
+    // Back wall (interior)
+    addQuad({ x,-y,-z},{-x,-y,-z},{-x, y,-z},{ x, y,-z}, { 0, 0,-1});
+    
+    return { std::move(v), std::move(i) };
+}
+
+MeshData makeWaterVolume(float w, float h, float d, float waterLevel) {
+    float x=w*0.5f*0.95f, y=h*waterLevel*0.5f, z=d*0.5f*0.95f; // Slightly smaller than tank interior
+    float bottom = -h*0.5f + 0.02f; // Just above tank bottom
+    using V = MeshVertex;
+    std::vector<V> v; std::vector<unsigned> i;
+    auto addQuad=[&](glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 d, glm::vec3 n){
+        size_t base=v.size();
+        v.push_back({a,n}); v.push_back({b,n}); v.push_back({c,n}); v.push_back({d,n});
+        i.insert(i.end(), { (unsigned)base,(unsigned)base+1,(unsigned)base+2,
+                            (unsigned)base,(unsigned)base+2,(unsigned)base+3 });
+    };
+    
+    // Water volume faces (all inward-facing normals for proper transparency)
+    addQuad({-x,bottom,-z},{ x,bottom,-z},{ x,bottom, z},{-x,bottom, z}, { 0, 1, 0}); // Bottom
+    addQuad({-x,bottom,-z},{-x, y,-z},{-x, y, z},{-x,bottom, z}, { 1, 0, 0}); // Left
+    addQuad({ x,bottom, z},{ x, y, z},{ x, y,-z},{ x,bottom,-z}, {-1, 0, 0}); // Right  
+    addQuad({-x,bottom, z},{-x, y, z},{ x, y, z},{ x,bottom, z}, { 0, 0,-1}); // Front
+    addQuad({ x,bottom,-z},{ x, y,-z},{-x, y,-z},{-x,bottom,-z}, { 0, 0, 1}); // Back
+    addQuad({-x, y, z},{ x, y, z},{ x, y,-z},{-x, y,-z}, { 0,-1, 0}); // Top (water surface)
+    
+    return { std::move(v), std::move(i) };
+}
+
+MeshData makeTankBase(float w, float h, float d) {
+    float bw = w * 1.3f, bh = h * 0.15f, bd = d * 1.3f; // Base is wider and shorter
+    float x=bw*0.5f, y=bh*0.5f, z=bd*0.5f;
+    using V = MeshVertex;
+    std::vector<V> v; std::vector<unsigned> i;
+    auto addQuad=[&](glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 d, glm::vec3 n){
+        size_t base=v.size();
+        v.push_back({a,n}); v.push_back({b,n}); v.push_back({c,n}); v.push_back({d,n});
+        i.insert(i.end(), { (unsigned)base,(unsigned)base+2,(unsigned)base+1,
+                            (unsigned)base,(unsigned)base+3,(unsigned)base+2 });
+    };
+    
+    // All 6 faces of the base
+    addQuad({-x,-y, z},{ x,-y, z},{ x, y, z},{-x, y, z}, { 0, 0,-1}); // Front
+    addQuad({ x,-y,-z},{-x,-y,-z},{-x, y,-z},{ x, y,-z}, { 0, 0, 1}); // Back
+    addQuad({-x,-y,-z},{-x,-y, z},{-x, y, z},{-x, y,-z}, { 1, 0, 0}); // Left
+    addQuad({ x,-y, z},{ x,-y,-z},{ x, y,-z},{ x, y, z}, {-1, 0, 0}); // Right
+    addQuad({-x, y, z},{ x, y, z},{ x, y,-z},{-x, y,-z}, { 0,-1, 0}); // Top
+    addQuad({-x,-y,-z},{ x,-y,-z},{ x,-y, z},{-x,-y, z}, { 0, 1, 0}); // Bottom
+    
+    return { std::move(v), std::move(i) };
+}
+MeshData makeFloor(float sx, float sz, float y) {
+    using V = MeshVertex;
+    std::vector<V> v = {
+        {{-sx*0.5f,y,-sz*0.5f},{0,1,0}},
+        {{ sx*0.5f,y,-sz*0.5f},{0,1,0}},
+        {{ sx*0.5f,y, sz*0.5f},{0,1,0}},
+        {{-sx*0.5f,y, sz*0.5f},{0,1,0}},
+    };
+    std::vector<unsigned> i = {0,1,2, 0,2,3};
+    return { std::move(v), std::move(i) };
+}
+
+MeshData makePlantStrip(int segments, float height, float width) {
+    using V = MeshVertex;
+    std::vector<V> v;
+    std::vector<unsigned> idx;
+    
+    // Create 4 strips at different angles for 3D appearance
+    const int numStrips = 4;
+    for (int strip = 0; strip < numStrips; ++strip) {
+        float angle = (2.0f * 3.14159f) * (float)strip / (float)numStrips;
+        glm::vec3 stripDir = glm::vec3(std::cos(angle), 0.0f, std::sin(angle));
+        glm::vec3 stripNormal = glm::vec3(-std::sin(angle), 0.0f, std::cos(angle));
+        
+        int baseVertex = (int)v.size();
+        
+        for (int i=0;i<=segments;++i) {
+            float t = (float)i/segments;
+            float y = t * height;
+            float w = width * (0.7f + 0.3f * (1.0f - t));
+            float sway = 0.05f * std::sin(t * 6.0f) * t; // Natural plant sway
+            
+            glm::vec3 offset = stripDir * w * 0.5f;
+            glm::vec3 swayOffset = glm::vec3(sway, 0.0f, sway * 0.5f);
+            
+            v.push_back({glm::vec3(-offset.x + swayOffset.x, y, -offset.z + swayOffset.z), stripNormal});
+            v.push_back({glm::vec3( offset.x + swayOffset.x, y,  offset.z + swayOffset.z), stripNormal});
+            
+            if (i < segments) {
+                unsigned base = baseVertex + i*2;
+                idx.insert(idx.end(), {base, base+2, base+1,  base+1, base+2, base+3});
+                // Add back faces for proper 3D appearance
+                idx.insert(idx.end(), {base+1, base+2, base,  base+3, base+2, base+1});
+            }
+        }
+    }
+    
+    return { std::move(v), std::move(idx) };
+}
+MeshData makeRockDome(int rings, int sectors, float radius) {
+    using V = MeshVertex;
+    std::vector<V> v; std::vector<unsigned> idx;
+    for (int r=0;r<=rings;++r) {
+        float vr = (float)r/rings;
+        float phi = (vr*0.5f)*3.14159f;
+        for (int s=0;s<=sectors;++s) {
+            float vs = (float)s/sectors;
+            float theta = vs*2.0f*3.14159f;
+            float x = radius*std::cos(theta)*std::sin(phi);
+            float y = radius*std::cos(phi);
+            float z = radius*std::sin(theta)*std::sin(phi);
+            glm::vec3 p(x,y,z), n = glm::normalize(glm::vec3(x, std::max(y, 1e-3f), z));
+            v.push_back({p,n});
+        }
+    }
+    int ring = sectors+1;
+    for (int r=0;r<rings;++r) for (int s=0;s<sectors;++s) {
+        unsigned a=r*ring+s, b=a+1, c=(r+1)*ring+s, d=c+1;
+        idx.insert(idx.end(), {a,c,b, b,c,d});
+    }
+    return { std::move(v), std::move(idx) };
+}
+
+MeshData makeCoral(int segments, float height, float baseRadius) { // Increased height and radius
+    using V = MeshVertex;
+    std::vector<V> v; std::vector<unsigned> idx;
+    
+    for (int i=0; i<=segments; ++i) {
+        float t = (float)i/segments;
+        float y = t * height;
+        float radius = baseRadius * (1.0f - t * 0.2f) + 0.04f * std::sin(t * 8.0f); // Less taper, more visible
+        
+        for (int j=0; j<=12; ++j) { // More sides for rounder coral
+            float angle = (2.0f * 3.14159f) * (float)j / 12.0f;
+            float x = radius * std::cos(angle);
+            float z = radius * std::sin(angle);
+            
+            // Add some bumpy texture
+            float bumpiness = 1.0f + 0.2f * std::sin(angle * 4.0f) * std::cos(t * 6.0f);
+            x *= bumpiness;
+            z *= bumpiness;
+            
+            glm::vec3 p(x, y, z);
+            glm::vec3 n = glm::normalize(glm::vec3(x, 0.2f, z));
+            v.push_back({p, n});
+        }
+    }
+    
+    for (int i=0; i<segments; ++i) {
+        for (int j=0; j<12; ++j) {
+            unsigned a = i*13 + j, b = a+1, c = (i+1)*13 + j, d = c+1;
+            if (j == 11) { b = i*13; d = (i+1)*13; }
+            idx.insert(idx.end(), {a,c,b, b,c,d});
+        }
+    }
+    
+    return { std::move(v), std::move(idx) };
+}
+
+MeshData makeShell(float radius, float height) {
+    using V = MeshVertex;
+    std::vector<V> v; std::vector<unsigned> idx;
+    
+    const int rings = 6, sectors = 12;
+    for (int r=0; r<=rings; ++r) {
+        float vr = (float)r/rings;
+        float phi = vr * 3.14159f * 0.3f;
+        float r_radius = radius * (1.0f - vr * 0.3f);
+        
+        for (int s=0; s<=sectors; ++s) {
+            float vs = (float)s/sectors;
+            float theta = vs * 2.0f * 3.14159f;
+            float x = r_radius * std::cos(theta);
+            float y = height * std::sin(phi);
+            float z = r_radius * std::sin(theta);
+            
+            glm::vec3 p(x, y, z);
+            glm::vec3 n = glm::normalize(glm::vec3(x, 0.5f, z));
+            v.push_back({p, n});
+        }
+    }
+    
+    int ring = sectors+1;
+    for (int r=0; r<rings; ++r) {
+        for (int s=0; s<sectors; ++s) {
+            unsigned a = r*ring + s, b = a+1, c = (r+1)*ring + s, d = c+1;
+            idx.insert(idx.end(), {a,c,b, b,c,d});
+        }
+    }
+    
+    return { std::move(v), std::move(idx) };
+}
+
+MeshData makeDriftwood(int segments, float length, float radius) {
+    using V = MeshVertex;
+    std::vector<V> v; std::vector<unsigned> idx;
+    
+    for (int i=0; i<=segments; ++i) {
+        float t = (float)i/segments;
+        float x = t * length;
+        float r = radius * (1.0f - t * 0.4f);
+        
+        for (int j=0; j<=8; ++j) {
+            float angle = (2.0f * 3.14159f) * (float)j / 8.0f;
+            float y = r * std::cos(angle);
+            float z = r * std::sin(angle);
+            
+            glm::vec3 p(x, y, z);
+            glm::vec3 n = glm::normalize(glm::vec3(0.1f, y, z));
+            v.push_back({p, n});
+        }
+    }
+    
+    for (int i=0; i<segments; ++i) {
+        for (int j=0; j<8; ++j) {
+            unsigned a = i*9 + j, b = a+1, c = (i+1)*9 + j, d = c+1;
+            if (j == 7) { b = i*9; d = (i+1)*9; }
+            idx.insert(idx.end(), {a,c,b, b,c,d});
+        }
+    }
+    
+    return { std::move(v), std::move(idx) };
+}
+
+MeshData makeAnemone(int segments, float height, float baseRadius) {
+    using V = MeshVertex;
+    std::vector<V> v; std::vector<unsigned> idx;
+    
+    // Central body
+    for (int i=0; i<=segments; ++i) {
+        float t = (float)i/segments;
+        float y = t * height * 0.6f;
+        float radius = baseRadius * (1.0f - t * 0.2f);
+        
+        for (int j=0; j<=12; ++j) {
+            float angle = (2.0f * 3.14159f) * (float)j / 12.0f;
+            float x = radius * std::cos(angle);
+            float z = radius * std::sin(angle);
+            
+            glm::vec3 p(x, y, z);
+            glm::vec3 n = glm::normalize(glm::vec3(x, 0.2f, z));
+            v.push_back({p, n});
+        }
+    }
+    
+    // Tentacles
+    int bodyVerts = (int)v.size();
+    for (int t=0; t<8; ++t) {
+        float tentacleAngle = (2.0f * 3.14159f) * (float)t / 8.0f;
+        float baseX = baseRadius * 0.8f * std::cos(tentacleAngle);
+        float baseZ = baseRadius * 0.8f * std::sin(tentacleAngle);
+        
+        for (int i=0; i<=6; ++i) {
+            float s = (float)i / 6.0f;
+            float tentacleHeight = height * 0.6f + s * height * 0.4f;
+            float sway = 0.1f * std::sin(s * 6.0f) * std::cos(tentacleAngle * 2.0f);
+            
+            glm::vec3 p(baseX + sway, tentacleHeight, baseZ + sway);
+            glm::vec3 n = glm::normalize(glm::vec3(baseX, 1.0f, baseZ));
+            v.push_back({p, n});
+        }
+    }
+    
+    // Body triangulation
+    for (int i=0; i<segments; ++i) {
+        for (int j=0; j<12; ++j) {
+            unsigned a = i*13 + j, b = a+1, c = (i+1)*13 + j, d = c+1;
+            if (j == 11) { b = i*13; d = (i+1)*13; }
+            idx.insert(idx.end(), {a,c,b, b,c,d});
+        }
+    }
+    
+    return { std::move(v), std::move(idx) };
+}
+
+MeshData makeStarfish(float outerRadius, float innerRadius, float thickness) {
+    using V = MeshVertex;
+    std::vector<V> v; std::vector<unsigned> idx;
+    
+    const int arms = 5;
+    const int segments = 10;
+    
+    // Top surface
+    for (int a=0; a<arms; ++a) {
+        float armAngle = (2.0f * 3.14159f) * (float)a / (float)arms;
+        
+        for (int s=0; s<=segments; ++s) {
+            float t = (float)s / (float)segments;
+            float radius = innerRadius + t * (outerRadius - innerRadius);
+            
+            // Main arm
+            float x = radius * std::cos(armAngle);
+            float z = radius * std::sin(armAngle);
+            float y = thickness * 0.5f * (1.0f - t * 0.3f);
+            
+            v.push_back({glm::vec3(x, y, z), glm::vec3(0, 1, 0)});
+            
+            // Arm sides
+            float sideAngle1 = armAngle - 0.2f;
+            float sideAngle2 = armAngle + 0.2f;
+            float sideRadius = radius * (0.7f - t * 0.3f);
+            
+            if (s < segments) {
+                v.push_back({glm::vec3(sideRadius * std::cos(sideAngle1), y, sideRadius * std::sin(sideAngle1)), glm::vec3(0, 1, 0)});
+                v.push_back({glm::vec3(sideRadius * std::cos(sideAngle2), y, sideRadius * std::sin(sideAngle2)), glm::vec3(0, 1, 0)});
+            }
+        }
+    }
+    
+    // Simple triangulation for demonstration
+    for (unsigned i=0; i<v.size()-2; i+=3) {
+        idx.insert(idx.end(), {i, i+1, i+2});
+    }
+    
+    return { std::move(v), std::move(idx) };
+}
+
+MeshData makeKelp(int segments, float height, float width) {
+    using V = MeshVertex;
+    std::vector<V> v; std::vector<unsigned> idx;
+    
+    // Create 3 strips at different angles for 3D kelp
+    const int numStrips = 3;
+    for (int strip = 0; strip < numStrips; ++strip) {
+        float angle = (2.0f * 3.14159f) * (float)strip / (float)numStrips;
+        glm::vec3 stripDir = glm::vec3(std::cos(angle), 0.0f, std::sin(angle));
+        glm::vec3 stripNormal = glm::vec3(-std::sin(angle), 0.0f, std::cos(angle));
+        
+        int baseVertex = (int)v.size();
+        
+        for (int i=0; i<=segments; ++i) {
+            float t = (float)i/segments;
+            float y = t * height;
+            float sway = 0.15f * std::sin(t * 8.0f + strip) * t; // Different sway per strip
+            float w = width * (1.0f - t * 0.3f);
+            
+            glm::vec3 offset = stripDir * w * 0.5f;
+            glm::vec3 swayOffset = glm::vec3(sway * std::cos(angle), 0.0f, sway * std::sin(angle));
+            
+            v.push_back({glm::vec3(-offset.x + swayOffset.x, y, -offset.z + swayOffset.z), stripNormal});
+            v.push_back({glm::vec3( offset.x + swayOffset.x, y,  offset.z + swayOffset.z), stripNormal});
+            
+            if (i < segments) {
+                unsigned base = baseVertex + i*2;
+                idx.insert(idx.end(), {base, base+2, base+1,  base+1, base+2, base+3});
+                // Add back faces
+                idx.insert(idx.end(), {base+1, base+2, base,  base+3, base+2, base+1});
+            }
+        }
+    }
+    
+    return { std::move(v), std::move(idx) };
+}
+
+MeshData makeTreasureChest(float w, float h, float d) {
+    using V = MeshVertex;
+    std::vector<V> v; std::vector<unsigned> idx;
+    
+    float x=w*0.5f, y=h*0.5f, z=d*0.5f;
+    auto addQuad=[&](glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 d, glm::vec3 n){
+        size_t base=v.size();
+        v.push_back({a,n}); v.push_back({b,n}); v.push_back({c,n}); v.push_back({d,n});
+        idx.insert(idx.end(), { (unsigned)base,(unsigned)base+2,(unsigned)base+1,
+                                (unsigned)base,(unsigned)base+3,(unsigned)base+2 });
+    };
+    
+    // Chest body
+    addQuad({-x,-y,-z},{ x,-y,-z},{ x, y,-z},{-x, y,-z}, { 0, 0, 1}); // Back
+    addQuad({-x,-y, z},{-x, y, z},{ x, y, z},{ x,-y, z}, { 0, 0,-1}); // Front
+    addQuad({-x,-y,-z},{-x,-y, z},{-x, y, z},{-x, y,-z}, { 1, 0, 0}); // Left
+    addQuad({ x,-y, z},{ x,-y,-z},{ x, y,-z},{ x, y, z}, {-1, 0, 0}); // Right
+    addQuad({-x,-y,-z},{ x,-y,-z},{ x,-y, z},{-x,-y, z}, { 0, 1, 0}); // Bottom
+    
+    // Slightly open lid
+    float lidY = y + h * 0.1f;
+    addQuad({-x, y, z},{ x, y, z},{ x, lidY,-z},{-x, lidY,-z}, { 0, 0.7f, 0.7f}); // Lid
+    
+    return { std::move(v), std::move(idx) };
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// ===========================================================
+// Procedural meshes and OBJ loading (CPU only)
+// ===========================================================
+//
+// The generators and the OBJ loader only fill MeshData, so they run on worker
+// threads and in the benchmarks; the renderer uploads the result.
+
+struct MeshVertex { glm::vec3 p,n; };
+struct MeshData { std::vector<MeshVertex> v; std::vector<unsigned> idx; };
+
+MeshData createFishMesh();
+// Falls back to createFishMesh() if the file is missing or has no vertices
+MeshData loadOBJModel(const std::string& filename);
+
+MeshData makeBox(float w, float h, float d);
+MeshData makeGlassTank(float w, float h, float d, float thickness = 0.05f);
+MeshData makeWaterVolume(float w, float h, float d, float waterLevel = 0.9f);
+MeshData makeTankBase(float w, float h, float d);
+MeshData makeFloor(float sx=3.2f, float sz=1.8f, float y=-0.9f);
+MeshData makePlantStrip(int segments = 12, float height = 0.6f, float width = 0.027f);
+MeshData makeRockDome(int rings=12, int sectors=18, float radius=0.22f);
+MeshData makeCoral(int segments = 8, float height = 0.6f, float baseRadius = 0.15f);
+MeshData makeShell(float radius = 0.12f, float height = 0.08f);
+MeshData makeDriftwood(int segments = 6, float length = 0.3f, float radius = 0.04f);
+MeshData makeAnemone(int segments = 16, float height = 0.25f, float baseRadius = 0.06f);
+MeshData makeStarfish(float outerRadius = 0.12f, float innerRadius = 0.06f, float thickness = 0.03f);
+MeshData makeKelp(int segments = 20, float height = 0.8f, float width = 0.04f);
+MeshData makeTreasureChest(float w = 0.2f, float h = 0.15f, float d = 0.15f);
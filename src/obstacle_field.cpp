@@ -0,0 +1,101 @@
+#include "obstacle_field.h"
+#include "jobs.h"
+
+#include <algorithm>
+#include <cmath>
+
+float obstacleDistance(const ObstacleShape& s, glm::vec3 p) {
+    switch (s.kind) {
+        case ObstacleShape::SPHERE:
+            return glm::length(p - s.a) - s.radius;
+        case ObstacleShape::CAPSULE: {
+            glm::vec3 ab = s.b - s.a, ap = p - s.a;
+            float t = std::clamp(glm::dot(ap, ab) / std::max(glm::dot(ab, ab), 1e-12f), 0.0f, 1.0f);
+            return glm::length(ap - ab * t) - s.radius;
+        }
+        default: {
+            // Into the box's frame (inverse of the yaw basic.vert applies), then the rounded-box distance
+            glm::vec3 d = p - s.a;
+            float c = std::cos(s.yaw), sn = std::sin(s.yaw);
+            glm::vec3 local(c * d.x - sn * d.z, d.y, sn * d.x + c * d.z);
+            glm::vec3 q = glm::abs(local) - (s.b - glm::vec3(s.radius));
+            return glm::length(glm::max(q, glm::vec3(0.0f))) + std::min(std::max(q.x, std::max(q.y, q.z)), 0.0f) - s.radius;
+        }
+    }
+}
+
+// Cells of [lo, hi] expanded by `margin`, clipped to the grid
+static void cellRange(glm::vec3 lo, glm::vec3 hi, float margin, glm::vec3 origin, float invCell, glm::ivec3 dim,
+                      glm::ivec3& c0, glm::ivec3& c1) {
+    glm::vec3 a = (lo - glm::vec3(margin) - origin) * invCell, b = (hi + glm::vec3(margin) - origin) * invCell;
+    c0 = glm::max(glm::ivec3(glm::floor(a)), glm::ivec3(0));
+    c1 = glm::min(glm::ivec3(glm::ceil(b)), dim - glm::ivec3(1));
+}
+
+void ObstacleField::bake(glm::vec3 lo, glm::vec3 hi, float cellSize, const std::function<float(glm::vec3)>& walls,
+                         const std::vector<ObstacleShape>& shapes) {
+    cell = std::max(cellSize, 1e-3f);
+    invCell = 1.0f / cell;
+    origin = lo;
+    dim = glm::max(glm::ivec3(glm::ceil((hi - lo) * invCell)) + glm::ivec3(1), glm::ivec3(2));
+    dist.assign((size_t)dim.x * dim.y * dim.z, maxDist);
+
+    // Walls everywhere, a slice of z per job
+    jobs::parallelFor((size_t)dim.z, 1, [&](size_t zb, size_t ze) {
+        for (int z = (int)zb; z < (int)ze; ++z)
+            for (int y = 0; y < dim.y; ++y) {
+                float* row = &dist[((size_t)z * dim.y + y) * dim.x];
+                for (int x = 0; x < dim.x; ++x)
+                    row[x] = std::min(maxDist, walls(origin + glm::vec3(x, y, z) * cell));
+            }
+    });
+
+    // Each shape only within maxDist of its bounds; everything further is already "far"
+    for (const ObstacleShape& s : shapes) {
+        glm::vec3 bmin, bmax;
+        if (s.kind == ObstacleShape::SPHERE)       { bmin = s.a - glm::vec3(s.radius); bmax = s.a + glm::vec3(s.radius); }
+        else if (s.kind == ObstacleShape::CAPSULE) { bmin = glm::min(s.a, s.b) - glm::vec3(s.radius); bmax = glm::max(s.a, s.b) + glm::vec3(s.radius); }
+        else {
+            float r = std::sqrt(s.b.x * s.b.x + s.b.z * s.b.z);   // any yaw fits in this square
+            bmin = s.a - glm::vec3(r, s.b.y, r); bmax = s.a + glm::vec3(r, s.b.y, r);
+        }
+        glm::ivec3 c0, c1;
+        cellRange(bmin, bmax, maxDist, origin, invCell, dim, c0, c1);
+        for (int z = c0.z; z <= c1.z; ++z)
+            for (int y = c0.y; y <= c1.y; ++y)
+                for (int x = c0.x; x <= c1.x; ++x) {
+                    float& d = dist[((size_t)z * dim.y + y) * dim.x + x];
+                    d = std::min(d, obstacleDistance(s, origin + glm::vec3(x, y, z) * cell));
+                }
+    }
+}
+
+void ObstacleField::clear() {
+    dist.clear();
+    dist.shrink_to_fit();
+    dim = glm::ivec3(0);
+}
+
+float ObstacleField::sample(glm::vec3 p, glm::vec3* grad) const {
+    glm::vec3 g = glm::clamp((p - origin) * invCell, glm::vec3(0.0f), glm::vec3(dim - glm::ivec3(1)));
+    glm::ivec3 c = glm::min(glm::ivec3(g), dim - glm::ivec3(2));
+    glm::vec3 f = g - glm::vec3(c);
+    const size_t sx = 1, sy = (size_t)dim.x, sz = (size_t)dim.x * dim.y;
+    const float* d = &dist[c.z * sz + c.y * sy + c.x];
+    float d000 = d[0],       d100 = d[sx],
+          d010 = d[sy],      d110 = d[sy + sx],
+          d001 = d[sz],      d101 = d[sz + sx],
+          d011 = d[sz + sy], d111 = d[sz + sy + sx];
+    // Along x, then y, then z
+    float x00 = d000 + (d100 - d000) * f.x, x10 = d010 + (d110 - d010) * f.x;
+    float x01 = d001 + (d101 - d001) * f.x, x11 = d011 + (d111 - d011) * f.x;
+    float y0 = x00 + (x10 - x00) * f.y, y1 = x01 + (x11 - x01) * f.y;
+    if (grad) {
+        float dx0 = (d100 - d000) + ((d110 - d010) - (d100 - d000)) * f.y;
+        float dx1 = (d101 - d001) + ((d111 - d011) - (d101 - d001)) * f.y;
+        grad->x = (dx0 + (dx1 - dx0) * f.z) * invCell;
+        grad->y = ((x10 - x00) + ((x11 - x01) - (x10 - x00)) * f.z) * invCell;
+        grad->z = (y1 - y0) * invCell;
+    }
+    return y0 + (y1 - y0) * f.z;
+}
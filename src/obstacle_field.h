@@ -0,0 +1,54 @@
+#pragma once
+#include <functional>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// ===========================================================
+// Obstacle field: signed distance to walls and decorations
+// ===========================================================
+//
+// A voxel grid of signed distances, baked once from the tank's walls and the
+// solid decorations: positive in open water, negative inside. A fish looks up
+// the distance and its gradient (the direction away from the nearest surface)
+// with one trilinear fetch, so avoidance costs the same however many
+// obstacles the tank holds. Distances are only exact up to maxDist; beyond
+// that the field just says "far".
+
+// Solid primitive, tank-local. Signed distance is positive outside.
+struct ObstacleShape {
+    enum Kind { SPHERE, CAPSULE, BOX };
+    Kind kind = SPHERE;
+    glm::vec3 a{0.0f};    // sphere/box: centre; capsule: one end
+    glm::vec3 b{0.0f};    // capsule: other end; box: half extents
+    float radius = 0.0f;  // sphere/capsule radius; box: corner rounding
+    float yaw = 0.0f;     // box: rotation about +y
+};
+
+float obstacleDistance(const ObstacleShape& s, glm::vec3 p);
+
+class ObstacleField {
+public:
+    // Grid over [lo, hi] with cubic cells of `cell`. `walls` is the signed
+    // distance to the tank's inside surface (positive inside), so tanks of any
+    // shape can be baked; shapes are unioned into it.
+    void bake(glm::vec3 lo, glm::vec3 hi, float cell, const std::function<float(glm::vec3)>& walls,
+              const std::vector<ObstacleShape>& shapes);
+    void clear();
+    bool empty() const { return dist.empty(); }
+
+    // Trilinear distance at p (clamped to the grid) and, if `grad` is set, its
+    // gradient: the unnormalized direction away from the nearest surface.
+    float sample(glm::vec3 p, glm::vec3* grad = nullptr) const;
+
+    size_t memoryBytes() const { return dist.capacity() * sizeof(float); }
+    glm::ivec3 dims() const { return dim; }
+
+    float maxDist = 0.5f;   // distances are clamped to this when baking
+
+private:
+    glm::vec3 origin{0.0f};   // centre of cell (0,0,0)
+    float cell = 1.0f, invCell = 1.0f;
+    glm::ivec3 dim{0};
+    std::vector<float> dist;  // x fastest, then y, then z
+};
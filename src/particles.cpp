@@ -0,0 +1,203 @@
+#include "particles.h"
+#include "jobs.h"
+#include "snapshot.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+// Pressure ratio per unit of depth; bubbles expand as they rise (Boyle's law).
+static const float kPressurePerDepth = 0.5f;
+static const size_t kGrain = 16384;
+static const float kWobbleFreq = 2.2f;
+
+void BubbleSystem::init(int cap, float floor, float surface, uint32_t seed) {
+    floorY = floor; surfaceY = surface;
+    rng.seed(seed);
+    px.assign(cap, 0.0f); py.assign(cap, 0.0f); pz.assign(cap, 0.0f);
+    vx.assign(cap, 0.0f); vy.assign(cap, 0.0f); vz.assign(cap, 0.0f);
+    size.assign(cap, 0.0f); size0.assign(cap, 0.0f);
+    age.assign(cap, 0.0f); wobC.assign(cap, 1.0f); wobS.assign(cap, 0.0f);
+    live.assign(cap, 0);
+    // Growth factor by depth, tabulated so the hot loop avoids cbrt()
+    const float pFloor = 1.0f + kPressurePerDepth * (surface - floor);
+    growthStep = std::max(surface - floor, 1e-3f) / (float)(kGrowthLUT - 1);
+    for (int k = 0; k < kGrowthLUT; ++k)
+        growthLUT[k] = std::cbrt(pFloor / (1.0f + kPressurePerDepth * (float)k * growthStep));
+    freeList.clear(); freeList.reserve(cap);
+    deadSlots.assign(cap, 0);
+    blockDead.assign(jobs::threadCount() * 4, 0);
+    surfaced.clear(); surfaced.reserve(cap);
+    highWater = 0; liveCount = 0; spawnScale = 1.0f;
+}
+
+int BubbleSystem::addEmitter(const BubbleEmitter& e) {
+    emitters.push_back(e);
+    return (int)emitters.size() - 1;
+}
+
+void BubbleSystem::spawn(const BubbleEmitter& e) {
+    int i;
+    if (!freeList.empty()) { i = freeList.back(); freeList.pop_back(); }
+    else if (highWater < capacity()) { i = highWater++; }
+    else return; // pool exhausted: the budget caps the population
+
+    std::uniform_real_distribution<float> u(-1.0f, 1.0f), u01(0.0f, 1.0f);
+    px[i] = e.pos.x + u(rng) * e.radius;
+    py[i] = e.pos.y;
+    pz[i] = e.pos.z + u(rng) * e.radius;
+    float drift = e.drift * (0.6f + 0.4f * u01(rng));
+    float a = u01(rng) * 6.28318f;
+    vx[i] = drift * std::cos(a);            // wobble amplitude, modulated in update()
+    vz[i] = drift * std::sin(a);
+    vy[i] = e.riseMin + u01(rng) * (e.riseMax - e.riseMin);
+    size0[i] = e.sizeMin + u01(rng) * (e.sizeMax - e.sizeMin);
+    size[i] = size0[i];
+    age[i] = 0.0f;
+    float ph = u01(rng) * 6.28318f;
+    wobC[i] = std::cos(ph); wobS[i] = std::sin(ph);
+    live[i] = 1;
+    ++liveCount;
+}
+
+void BubbleSystem::update(float dt) {
+    auto t0 = std::chrono::steady_clock::now();
+
+    for (auto& e : emitters) {
+        e.carry += e.rate * spawnScale * dt;
+        int n = (int)e.carry;
+        e.carry -= (float)n;
+        for (int k = 0; k < n; ++k) spawn(e);
+    }
+
+    // Integrate in parallel; each block collects its own surfaced slots (into
+    // its own slot range of deadSlots) so the free list can be refilled without
+    // touching every slot again. The wobble is
+    // a unit phasor rotated by the same angle for every bubble, so no sin() per slot.
+    const float top = surfaceY - 0.02f;
+    const float rc = std::cos(kWobbleFreq * dt), rs = std::sin(kWobbleFreq * dt);
+    const float invStep = 1.0f / growthStep, maxK = (float)(kGrowthLUT - 1);
+    const size_t n = (size_t)highWater;
+    const size_t blocks = std::max<size_t>(1, std::min<size_t>((n + kGrain - 1) / kGrain, jobs::threadCount() * 4));
+    const size_t blockSize = (n + blocks - 1) / blocks;
+    if (blockDead.size() < blocks) blockDead.resize(blocks);   // only if the pool grew since init()
+    for (size_t b = 0; b < blocks; ++b) blockDead[b] = 0;
+
+    jobs::parallelFor(blocks, 1, [&](size_t b0, size_t b1) {
+        float* __restrict X = px.data(); float* __restrict Y = py.data(); float* __restrict Z = pz.data();
+        const float* __restrict VX = vx.data(); const float* __restrict VY = vy.data(); const float* __restrict VZ = vz.data();
+        float* __restrict S = size.data(); const float* __restrict S0 = size0.data();
+        float* __restrict A = age.data(); float* __restrict WC = wobC.data(); float* __restrict WS = wobS.data();
+        uint8_t* __restrict L = live.data();
+        const float sy = surfaceY;
+        for (size_t b = b0; b < b1; ++b) {
+            size_t i0 = b * blockSize, i1 = std::min(n, i0 + blockSize);
+            for (size_t i = i0; i < i1; ++i) {
+                float l = L[i] ? 1.0f : 0.0f, ldt = l * dt;
+                float c = WC[i], s = WS[i];
+                WC[i] = c * rc - s * rs;
+                WS[i] = s * rc + c * rs;
+                A[i] += ldt;
+                X[i] += VX[i] * s * ldt;
+                Y[i] += VY[i] * ldt;
+                Z[i] += VZ[i] * s * ldt;
+            }
+            int* out = deadSlots.data() + i0;
+            int dead = 0;
+            for (size_t i = i0; i < i1; ++i) {
+                if (!L[i]) continue;
+                if (Y[i] > top) { L[i] = 0; S[i] = 0.0f; out[dead++] = (int)i; continue; }
+                float k = std::min(std::max(sy - Y[i], 0.0f) * invStep, maxK);
+                S[i] = S0[i] * growthLUT[(int)k];
+            }
+            blockDead[b] = dead;
+        }
+    });
+
+    surfaced.clear();
+    for (size_t b = 0; b < blocks; ++b) {
+        const int* dead = deadSlots.data() + b * blockSize;
+        for (int k = 0; k < blockDead[b]; ++k) { int i = dead[k]; freeList.push_back(i); surfaced.push_back(glm::vec2(px[i], pz[i])); }
+        liveCount -= blockDead[b];
+    }
+
+    updateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    // Hold the CPU budget by throttling emission rather than dropping live bubbles
+    if (budgetMs > 0.0f) {
+        if (updateMs > budgetMs) spawnScale = std::max(0.05f, spawnScale * 0.9f);
+        else                     spawnScale = std::min(1.0f, spawnScale * 1.02f);
+    }
+}
+
+void BubbleSystem::pack(float* out, glm::vec3 offset) const {
+    jobs::parallelFor((size_t)highWater, kGrain, [&](size_t b, size_t e) {
+        for (size_t i = b; i < e; ++i) {
+            float* o = out + i * 4;
+            o[0] = px[i] + offset.x; o[1] = py[i] + offset.y; o[2] = pz[i] + offset.z;
+            o[3] = live[i] ? size[i] : 0.0f;
+        }
+    });
+}
+
+size_t BubbleSystem::memoryBytes() const {
+    size_t b = (px.capacity() + py.capacity() + pz.capacity() + vx.capacity() + vy.capacity() + vz.capacity()
+              + size.capacity() + size0.capacity() + age.capacity() + wobC.capacity() + wobS.capacity()) * sizeof(float)
+             + live.capacity() + freeList.capacity() * sizeof(int)
+             + emitters.capacity() * sizeof(BubbleEmitter) + surfaced.capacity() * sizeof(glm::vec2);
+    b += (deadSlots.capacity() + blockDead.capacity()) * sizeof(int);
+    return b;
+}
+
+void BubbleSystem::save(SnapshotWriter& w) const {
+    int32_t counters[2] = { highWater, liveCount };
+    float params[4] = { floorY, surfaceY, spawnScale, budgetMs };
+    w.addValue("bubbles.counters", counters);
+    w.addValue("bubbles.params", params);
+    w.addVector("bubbles.emitters", emitters);
+    w.addVector("bubbles.px", px); w.addVector("bubbles.py", py); w.addVector("bubbles.pz", pz);
+    w.addVector("bubbles.vx", vx); w.addVector("bubbles.vy", vy); w.addVector("bubbles.vz", vz);
+    w.addVector("bubbles.size", size); w.addVector("bubbles.size0", size0);
+    w.addVector("bubbles.age", age);
+    w.addVector("bubbles.wobC", wobC); w.addVector("bubbles.wobS", wobS);
+    w.addVector("bubbles.live", live);
+    w.addVector("bubbles.free", freeList);
+    w.addRng("bubbles.rng", rng);
+}
+
+bool BubbleSystem::load(const SnapshotReader& r) {
+    int32_t counters[2]; float params[4];
+    if (!r.readValue("bubbles.counters", counters) || !r.readValue("bubbles.params", params)) return false;
+    init(0, params[0], params[1], 0u);   // rebuild the growth table for these bounds
+    bool ok = r.readVector("bubbles.emitters", emitters)
+        && r.readVector("bubbles.px", px) && r.readVector("bubbles.py", py) && r.readVector("bubbles.pz", pz)
+        && r.readVector("bubbles.vx", vx) && r.readVector("bubbles.vy", vy) && r.readVector("bubbles.vz", vz)
+        && r.readVector("bubbles.size", size) && r.readVector("bubbles.size0", size0)
+        && r.readVector("bubbles.age", age)
+        && r.readVector("bubbles.wobC", wobC) && r.readVector("bubbles.wobS", wobS)
+        && r.readVector("bubbles.live", live)
+        && r.readVector("bubbles.free", freeList)
+        && r.readRng("bubbles.rng", rng);
+    size_t cap = px.size();
+    ok = ok && py.size() == cap && pz.size() == cap && vx.size() == cap && vy.size() == cap && vz.size() == cap
+            && size.size() == cap && size0.size() == cap && age.size() == cap
+            && wobC.size() == cap && wobS.size() == cap && live.size() == cap
+            && counters[0] >= 0 && (size_t)counters[0] <= cap
+            && counters[1] >= 0 && counters[1] <= counters[0];
+    // Slots the next spawn will write to must be real, free slots below the
+    // high-water mark, and the live count must add up
+    int alive = 0;
+    for (int i = 0; ok && i < counters[0]; ++i) alive += live[i] ? 1 : 0;
+    ok = ok && alive == counters[1] && freeList.size() == (size_t)(counters[0] - counters[1]);
+    for (size_t k = 0; ok && k < freeList.size(); ++k)
+        ok = freeList[k] >= 0 && freeList[k] < counters[0] && !live[freeList[k]];
+    for (size_t k = 0; ok && k < emitters.size(); ++k)
+        ok = std::isfinite(emitters[k].rate) && emitters[k].rate >= 0.0f && std::isfinite(emitters[k].carry);
+    if (!ok) return false;
+    freeList.reserve(cap);
+    deadSlots.assign(cap, 0);
+    surfaced.reserve(cap);
+    highWater = counters[0]; liveCount = counters[1];
+    spawnScale = params[2]; budgetMs = params[3];
+    return true;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class SnapshotWriter;
+class SnapshotReader;
+
+// ===========================================================
+// Bubble particle system (SoA pool fed by emitters)
+// ===========================================================
+
+// A bubble source: an air stone on the floor or a vent on a decoration.
+struct BubbleEmitter {
+    glm::vec3 pos{0.0f};
+    float radius  = 0.04f;            // horizontal spawn jitter
+    float rate    = 20.0f;            // bubbles per second
+    float riseMin = 0.28f, riseMax = 0.46f;
+    float sizeMin = 3.0f,  sizeMax = 5.5f;   // point size at the floor
+    float drift   = 0.06f;            // sideways wobble amplitude
+    float carry   = 0.0f;             // fractional spawn accumulator
+};
+
+class BubbleSystem {
+public:
+    // Allocates the pool and its scratch up front; update() allocates nothing.
+    void init(int capacity, float floorY, float surfaceY, uint32_t seed);
+    int  addEmitter(const BubbleEmitter& e);
+    void clearEmitters() { emitters.clear(); }
+
+    void update(float dt);
+
+    // Full pool state including emitters and RNG, for deterministic replay
+    void save(SnapshotWriter& w) const;
+    bool load(const SnapshotReader& r);
+
+    // Writes x,y,z,size for slots [0, used()) into out (4 floats each).
+    // Free slots get size 0 so the vertex shader can drop them. `offset` is
+    // added to every position (the owning tank's origin).
+    void pack(float* out, glm::vec3 offset = glm::vec3(0.0f)) const;
+
+    int capacity() const { return (int)px.size(); }
+    int used()     const { return highWater; }
+    int alive()    const { return liveCount; }
+    double lastUpdateMs() const { return updateMs; }
+    float emissionScale() const { return spawnScale; }
+    size_t memoryBytes() const;   // pool, free list and scratch capacity
+
+    float budgetMs = 2.0f;   // update() cost above this throttles emission; 0 disables
+
+    std::vector<BubbleEmitter> emitters;
+    std::vector<glm::vec2> surfaced;   // x,z of bubbles that reached the surface in the last update()
+
+    // SoA state, indexed by slot
+    std::vector<float> px, py, pz;
+    std::vector<float> vx, vy, vz;
+    std::vector<float> size, size0;
+    std::vector<float> age;
+    std::vector<float> wobC, wobS;     // wobble phasor (cos, sin)
+    std::vector<uint8_t> live;
+
+private:
+    void spawn(const BubbleEmitter& e);
+
+    std::vector<int> freeList;   // recycled slots, used as a stack
+    int highWater = 0, liveCount = 0;
+    float floorY = -1.0f, surfaceY = 1.0f;
+    double updateMs = 0.0;
+    float spawnScale = 1.0f;
+    std::mt19937 rng;
+    std::vector<int> deadSlots;   // surfaced slots, each block within its own slot range
+    std::vector<int> blockDead;   // surfaced count per block
+    static const int kGrowthLUT = 256;
+    float growthLUT[kGrowthLUT] = {};
+    float growthStep = 1.0f;
+};
@@ -0,0 +1,105 @@
+#include "poisson_disk.h"
+
+#include <algorithm>
+#include <cmath>
+
+static const int ATTEMPTS = 30;   // tries around an active disc before it retires
+
+PoissonDisk::PoissonDisk(glm::vec2 lo_, glm::vec2 hi_, float maxRadius) : lo(lo_), hi(hi_) {
+    maxR = std::max(maxRadius, 1e-4f);
+    glm::vec2 size = glm::max(hi - lo, glm::vec2(1e-3f));
+    // Cells about two of the largest discs wide, at most 2048 per side
+    cell = std::max(2.0f * maxR, std::max(size.x, size.y) / 2048.0f);
+    invCell = 1.0f / cell;
+    dim = glm::max(glm::ivec2(glm::ceil(size * invCell)), glm::ivec2(1));
+    head.assign((size_t)dim.x * dim.y, -1);
+}
+
+int PoissonDisk::cellOf(glm::vec2 p) const {
+    glm::ivec2 c = glm::clamp(glm::ivec2((p - lo) * invCell), glm::ivec2(0), dim - 1);
+    return c.y * dim.x + c.x;
+}
+
+void PoissonDisk::add(glm::vec2 p, float r, int kind) {
+    int c = cellOf(p);
+    next.push_back(head[c]);
+    head[c] = (int32_t)discs.size();
+    discs.push_back({ p, r, kind });
+}
+
+bool PoissonDisk::fits(glm::vec2 p, float r, int kind, float spacing) const {
+    if (p.x - r < lo.x || p.y - r < lo.y || p.x + r > hi.x || p.y + r > hi.y) return false;
+    const float reach = std::max(spacing, r + maxR);
+    glm::ivec2 c0 = glm::max(glm::ivec2(glm::floor((p - lo - reach) * invCell)), glm::ivec2(0));
+    glm::ivec2 c1 = glm::min(glm::ivec2(glm::floor((p - lo + reach) * invCell)), dim - 1);
+    for (int y = c0.y; y <= c1.y; ++y)
+        for (int x = c0.x; x <= c1.x; ++x)
+            for (int32_t i = head[y * dim.x + x]; i >= 0; i = next[i]) {
+                const Disc& d = discs[i];
+                float need = r + d.r;
+                if (d.kind == kind) need = std::max(need, spacing);
+                float dx = d.p.x - p.x, dz = d.p.y - p.y;
+                if (dx * dx + dz * dz < need * need) return false;
+            }
+    return true;
+}
+
+int PoissonDisk::scatter(const ScatterSpec& spec, std::mt19937& rng, std::vector<glm::vec3>& out) {
+    const int kind = kinds++;
+    if (spec.count <= 0 || spec.regions.empty()) return 0;
+    std::uniform_real_distribution<float> u01(0.0f, 1.0f);
+    auto inRegions = [&](glm::vec2 p) {
+        for (const ScatterRect& q : spec.regions)
+            if (p.x >= q.lo.x && p.y >= q.lo.y && p.x <= q.hi.x && p.y <= q.hi.y) return true;
+        return false;
+    };
+    // Spacing from the density asked for: a little under what a saturated
+    // random packing of `count` discs over the regions reaches, so they all fit
+    // and still cover every region.
+    float area = 0.0f;
+    for (const ScatterRect& q : spec.regions) area += std::max(q.hi.x - q.lo.x, 0.0f) * std::max(q.hi.y - q.lo.y, 0.0f);
+    const float spacing = 0.7f * std::sqrt(area / (float)spec.count);
+
+    int placed = 0;
+    std::vector<int> active;
+    auto place = [&](glm::vec2 p, float r, float s) {
+        active.push_back((int)discs.size());
+        add(p, r, kind);
+        out.emplace_back(p.x, p.y, s);
+        ++placed;
+    };
+    auto drawSize = [&] { return spec.sizeMin + u01(rng) * (spec.sizeMax - spec.sizeMin); };
+
+    // A seed in every region (they may not touch), then grow from the active
+    // discs; when growth stalls (other kinds in the way), throw darts for a
+    // new seed before giving up
+    auto seed = [&](const ScatterRect& q) {
+        float s = drawSize(), r = spec.footprint * s + spec.footprintBase;
+        for (int a = 0; a < ATTEMPTS; ++a) {
+            glm::vec2 p = q.lo + (q.hi - q.lo) * glm::vec2(u01(rng), u01(rng));
+            if (fits(p, r, kind, spacing)) { place(p, r, s); return true; }
+        }
+        return false;
+    };
+    for (const ScatterRect& q : spec.regions)
+        if (placed < spec.count) seed(q);
+    while (placed < spec.count) {
+        if (active.empty()) {
+            size_t q = (size_t)(u01(rng) * (float)spec.regions.size()) % spec.regions.size();
+            if (!seed(spec.regions[q])) break;
+            continue;
+        }
+        size_t slot = (size_t)(u01(rng) * (float)active.size()) % active.size();
+        const Disc a = discs[active[slot]];
+        float s = drawSize(), r = spec.footprint * s + spec.footprintBase;
+        float ring = std::max(spacing, a.r + r);
+        bool found = false;
+        for (int k = 0; k < ATTEMPTS && !found; ++k) {
+            float ang = u01(rng) * 6.28318f, dist = ring * (1.0f + u01(rng));
+            glm::vec2 p = a.p + dist * glm::vec2(std::cos(ang), std::sin(ang));
+            if (inRegions(p) && fits(p, r, kind, spacing)) { place(p, r, s); found = true; }
+        }
+        if (!found) { active[slot] = active.back(); active.pop_back(); }
+    }
+    return placed;
+}
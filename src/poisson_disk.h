@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// ===========================================================
+// Poisson-disk scattering on the tank floor
+// ===========================================================
+//
+// Bridson's algorithm with variable radii: every placement is a disc (its
+// footprint on the sand) and no two discs overlap. New discs are tried in an
+// annulus around a random active one, and a background grid of linked cells
+// means each try only checks the discs nearby, so tens of thousands place in
+// milliseconds. Several kinds share one sampler, placed one after another;
+// discs of the same kind are also kept a `spacing` apart, which spreads a kind
+// evenly over its regions instead of letting it bunch up.
+
+struct ScatterRect { glm::vec2 lo, hi; };   // x, z
+
+struct ScatterSpec {
+    std::vector<ScatterRect> regions;   // where centres may go, not overlapping each other
+    int count = 0;
+    float sizeMin = 1.0f, sizeMax = 1.0f;   // placement scale (Tank::decor's w), uniform
+    float footprint = 0.0f;             // disc radius per unit of size...
+    float footprintBase = 0.0f;         // ...plus this
+};
+
+class PoissonDisk {
+public:
+    // Floor [lo, hi] (x, z); discs stay entirely inside. `maxRadius` is the
+    // largest footprint any spec will produce and sizes the grid cells.
+    PoissonDisk(glm::vec2 lo, glm::vec2 hi, float maxRadius);
+
+    // Up to spec.count discs of a new kind; appends x, z and size for each to
+    // `out` and returns how many fit.
+    int scatter(const ScatterSpec& spec, std::mt19937& rng, std::vector<glm::vec3>& out);
+
+    int size() const { return (int)discs.size(); }
+
+private:
+    struct Disc { glm::vec2 p; float r; int kind; };
+    bool fits(glm::vec2 p, float r, int kind, float spacing) const;
+    void add(glm::vec2 p, float r, int kind);
+    int cellOf(glm::vec2 p) const;
+
+    glm::vec2 lo, hi;
+    float cell, invCell, maxR;
+    glm::ivec2 dim;
+    int kinds = 0;
+    std::vector<Disc> discs;
+    std::vector<int32_t> head;   // first disc per cell, -1 = empty
+    std::vector<int32_t> next;   // next disc in the same cell
+};
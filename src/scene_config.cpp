@@ -0,0 +1,193 @@
+#include "scene_config.h"
+#include "school.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+static const int MAX_FISH_PER_SPECIES = 4000000;
+static const int MAX_DECOR_PER_TYPE = 1000000;
+static const int MAX_BUBBLES = 4000000;
+static const int MAX_FOOD = 4000000;
+
+static const char* const SPECIES_NAMES[SPECIES_COUNT] = {
+    "clownfish", "neon", "danio", "angelfish", "goldfish", "betta", "guppy", "platy"
+};
+
+int SceneConfig::totalFish() const {
+    int n = 0;
+    for (const auto& s : species) n += s.count;
+    return n;
+}
+
+SceneConfig defaultSceneConfig() {
+    SceneConfig c;
+    auto set = [&](int i, int count, glm::vec3 base, glm::vec3 vary, glm::vec3 sMean, glm::vec3 sVar,
+                   float spMin, float spMax, float yMin, float gap, float scMin, float scMax,
+                   float cohesion, float alignment) {
+        SpeciesConfig& s = c.species[i];
+        s.name = SPECIES_NAMES[i]; s.count = count;
+        s.baseColor = base; s.varyColor = vary; s.stretchMean = sMean; s.stretchVar = sVar;
+        s.speedMin = spMin; s.speedMax = spMax; s.yMin = yMin; s.surfaceGap = gap;
+        s.scaleMin = scMin; s.scaleMax = scMax; s.cohesion = cohesion; s.alignment = alignment;
+    };
+    set(0, 6,  {1.0f,0.55f,0.20f}, {0.2f,0.1f,0.1f}, {1.2f,0.9f,1.0f}, {0.25f,0.1f,0.2f},  0.4f,0.8f, -0.8f,0.20f, 1.0f,1.3f, 0.18f,0.45f);
+    set(1, 12, {0.20f,0.85f,1.0f},{0.2f,0.2f,0.2f}, {1.0f,0.7f,0.8f}, {0.2f,0.15f,0.15f}, 0.5f,1.0f, -0.6f,0.15f, 0.8f,1.0f, 0.22f,0.30f);
+    set(2, 8,  {0.9f,0.85f,0.55f},{0.2f,0.2f,0.2f}, {1.3f,0.8f,0.9f}, {0.25f,0.12f,0.2f}, 0.6f,1.2f, -0.7f,0.12f, 0.9f,1.1f, 0.18f,0.40f);
+    set(3, 4,  {0.8f,0.8f,0.9f},  {0.3f,0.3f,0.3f}, {1.5f,1.2f,0.6f}, {0.3f,0.2f,0.1f},   0.3f,0.6f, -0.5f,0.25f, 1.3f,1.6f, 0.15f,0.35f);
+    set(4, 3,  {1.0f,0.7f,0.2f},  {0.2f,0.1f,0.1f}, {1.1f,0.9f,1.0f}, {0.2f,0.15f,0.2f},  0.2f,0.5f, -0.4f,0.30f, 1.4f,1.8f, 0.12f,0.25f);
+    set(5, 2,  {0.8f,0.3f,0.8f},  {0.3f,0.2f,0.3f}, {1.0f,1.4f,0.7f}, {0.2f,0.3f,0.15f},  0.3f,0.7f, -0.3f,0.15f, 1.1f,1.4f, 0.20f,0.45f);
+    set(6, 8,  {0.3f,0.8f,0.9f},  {0.2f,0.3f,0.2f}, {0.8f,0.6f,0.7f}, {0.15f,0.1f,0.15f}, 0.5f,0.9f, -0.6f,0.10f, 0.6f,0.8f, 0.25f,0.35f);
+    set(7, 6,  {0.9f,0.4f,0.6f},  {0.2f,0.2f,0.2f}, {0.9f,0.7f,0.8f}, {0.15f,0.1f,0.15f}, 0.4f,0.8f, -0.5f,0.12f, 0.7f,0.9f, 0.18f,0.30f);
+    return c;
+}
+
+namespace {
+
+struct Parser {
+    std::string path;
+    int line = 0;
+    bool ok = true;
+
+    void error(const std::string& msg) {
+        std::cerr << path << ":" << line << ": " << msg << "\n";
+        ok = false;
+    }
+    bool floats(const std::string& key, const std::string& v, float* out, int n) {
+        std::istringstream in(v);
+        for (int i = 0; i < n; ++i) {
+            if (!(in >> out[i])) { error("'" + key + "' expects " + std::to_string(n) + " number(s)"); return false; }
+        }
+        std::string rest;
+        if (in >> rest) { error("'" + key + "' has trailing value '" + rest + "'"); return false; }
+        return true;
+    }
+    void integer(const std::string& key, const std::string& v, int& out, int lo, int hi) {
+        float f;
+        if (!floats(key, v, &f, 1)) return;
+        if (f != (float)(long long)f || f < (float)lo || f > (float)hi) {
+            error("'" + key + "' must be an integer in [" + std::to_string(lo) + ", " + std::to_string(hi) + "]");
+            return;
+        }
+        out = (int)f;
+    }
+    void number(const std::string& key, const std::string& v, float& out, float lo, float hi) {
+        float f;
+        if (!floats(key, v, &f, 1)) return;
+        if (f < lo || f > hi) { error("'" + key + "' is out of range"); return; }
+        out = f;
+    }
+    void range(const std::string& key, const std::string& v, float& a, float& b, float lo, float hi) {
+        float f[2];
+        if (!floats(key, v, f, 2)) return;
+        if (f[0] > f[1] || f[0] < lo || f[1] > hi) { error("'" + key + "' must be 'min max' with min <= max"); return; }
+        a = f[0]; b = f[1];
+    }
+    void vec3(const std::string& key, const std::string& v, glm::vec3& out, float lo, float hi) {
+        float f[3];
+        if (!floats(key, v, f, 3)) return;
+        for (float x : f) if (x < lo || x > hi) { error("'" + key + "' component out of range"); return; }
+        out = glm::vec3(f[0], f[1], f[2]);
+    }
+};
+
+std::string trim(const std::string& s) {
+    size_t b = s.find_first_not_of(" \t\r"), e = s.find_last_not_of(" \t\r");
+    return b == std::string::npos ? std::string() : s.substr(b, e - b + 1);
+}
+
+} // namespace
+
+bool loadSceneConfig(const std::string& path, SceneConfig& out) {
+    std::ifstream file(path);
+    if (!file.is_open()) { std::cerr << "Scene: cannot open " << path << "\n"; return false; }
+
+    SceneConfig c = defaultSceneConfig();
+    c.name = path;
+    Parser p; p.path = path;
+    std::string section;
+    SpeciesConfig* sp = nullptr;
+
+    std::string raw;
+    while (std::getline(file, raw)) {
+        ++p.line;
+        std::string l = trim(raw.substr(0, raw.find('#')));
+        if (l.empty()) continue;
+
+        if (l.front() == '[') {
+            if (l.back() != ']') { p.error("unterminated section header"); continue; }
+            std::istringstream in(l.substr(1, l.size() - 2));
+            std::string kind, name;
+            in >> kind >> name;
+            section = kind; sp = nullptr;
+            if (kind == "species") {
+                for (auto& s : c.species) if (name == s.name) sp = &s;
+                if (!sp) p.error("unknown species '" + name + "'");
+            } else if (kind != "tank" && kind != "decorations" && kind != "bubbles" && kind != "feeding") {
+                p.error("unknown section '" + kind + "'");
+            }
+            continue;
+        }
+
+        size_t eq = l.find('=');
+        if (eq == std::string::npos) { p.error("expected 'key = value'"); continue; }
+        std::string key = trim(l.substr(0, eq)), val = trim(l.substr(eq + 1));
+
+        if (section == "tank") {
+            if      (key == "water_y")          p.number(key, val, c.waterY, -1.2f, 1.2f);
+            else if (key == "water_resolution") p.integer(key, val, c.waterResolution, 16, 2048);
+            else if (key == "obstacle_cell")    p.number(key, val, c.obstacleCell, 0.0f, 0.5f);
+            else p.error("unknown key '" + key + "' in [tank]");
+        } else if (section == "decorations") {
+            int* dst = key == "plants" ? &c.plants : key == "rocks" ? &c.rocks : key == "corals" ? &c.corals
+                     : key == "shells" ? &c.shells : key == "driftwood" ? &c.driftwood : key == "anemones" ? &c.anemones
+                     : key == "starfish" ? &c.starfish : key == "kelp" ? &c.kelp : key == "chests" ? &c.chests : nullptr;
+            if (dst) p.integer(key, val, *dst, 0, MAX_DECOR_PER_TYPE);
+            else if (key == "stalk_budget") p.integer(key, val, c.stalkBudget, 0, MAX_DECOR_PER_TYPE);
+            else p.error("unknown key '" + key + "' in [decorations]");
+        } else if (section == "bubbles") {
+            if      (key == "capacity")        p.integer(key, val, c.bubbleCapacity, 0, MAX_BUBBLES);
+            else if (key == "gpu_count")       p.integer(key, val, c.gpuBubbles, 0, MAX_BUBBLES);
+            else if (key == "air_stone_rate")  p.number(key, val, c.airStoneRate, 0.0f, 1e7f);
+            else if (key == "decor_vent_rate") p.number(key, val, c.ventRate, 0.0f, 1e7f);
+            else p.error("unknown key '" + key + "' in [bubbles]");
+        } else if (section == "feeding") {
+            if      (key == "capacity") p.integer(key, val, c.foodCapacity, 0, MAX_FOOD);
+            else if (key == "pellets")  p.integer(key, val, c.feedPellets, 0, MAX_FOOD);
+            else if (key == "spread")   p.number(key, val, c.feedSpread, 0.0f, 5.0f);
+            else if (key == "lifetime") p.number(key, val, c.foodLifetime, 0.1f, 3600.0f);
+            else p.error("unknown key '" + key + "' in [feeding]");
+        } else if (section == "species" && sp) {
+            if      (key == "count")        p.integer(key, val, sp->count, 0, MAX_FISH_PER_SPECIES);
+            else if (key == "base_color")   p.vec3(key, val, sp->baseColor, 0.0f, 1.0f);
+            else if (key == "vary_color")   p.vec3(key, val, sp->varyColor, 0.0f, 1.0f);
+            else if (key == "stretch_mean") p.vec3(key, val, sp->stretchMean, 0.1f, 4.0f);
+            else if (key == "stretch_var")  p.vec3(key, val, sp->stretchVar, 0.0f, 2.0f);
+            else if (key == "speed")        p.range(key, val, sp->speedMin, sp->speedMax, 0.0f, 10.0f);
+            else if (key == "scale")        p.range(key, val, sp->scaleMin, sp->scaleMax, 0.05f, 10.0f);
+            else if (key == "y_min")        p.number(key, val, sp->yMin, -1.3f, 1.3f);
+            else if (key == "surface_gap")  p.number(key, val, sp->surfaceGap, 0.0f, 2.0f);
+            else if (key == "cohesion")     p.number(key, val, sp->cohesion, 0.0f, 5.0f);
+            else if (key == "alignment")    p.number(key, val, sp->alignment, 0.0f, 5.0f);
+            else if (key == "neighbors")    p.integer(key, val, sp->neighbors, 0, SCHOOL_MAX_NEIGHBORS);
+            else p.error("unknown key '" + key + "' in [species " + std::string(sp->name) + "]");
+        } else if (section.empty()) {
+            p.error("key '" + key + "' outside of a section");
+        }
+    }
+
+    // Cross-field checks
+    for (const auto& s : c.species) {
+        if (s.yMin > c.waterY - s.surfaceGap) {
+            std::cerr << path << ": species '" << s.name << "' swim band is empty (y_min above water_y - surface_gap)\n";
+            p.ok = false;
+        }
+    }
+    if (c.obstacleCell > 0.0f && c.obstacleCell < 0.02f) {
+        std::cerr << path << ": obstacle_cell must be 0 (off) or at least 0.02\n";
+        p.ok = false;
+    }
+    if (!p.ok) return false;
+    out = c;
+    return true;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <string>
+
+#include <glm/glm.hpp>
+
+// ===========================================================
+// Scene configuration (populations, decorations, bubbles)
+// ===========================================================
+//
+// Scene files are plain text:
+//
+//   # comment
+//   [tank]
+//   water_y = 0.6
+//   [species neon]
+//   count = 12
+//   base_color = 0.2 0.85 1.0
+//
+// Unknown sections or keys, malformed values and out-of-range numbers are
+// reported with their line number and reject the whole file.
+
+static const int SPECIES_COUNT = 8;
+
+struct SpeciesConfig {
+    const char* name = "";
+    int count = 0;
+    glm::vec3 baseColor{1.0f}, varyColor{0.0f};
+    glm::vec3 stretchMean{1.0f}, stretchVar{0.0f};
+    float speedMin = 0.4f, speedMax = 0.8f;     // speedMax is also the schooling speed cap
+    float yMin = -0.8f, surfaceGap = 0.2f;      // swim band: [yMin, waterY - surfaceGap]
+    float scaleMin = 1.0f, scaleMax = 1.0f;
+    float cohesion = 0.18f, alignment = 0.45f;
+    int neighbors = 0;                          // 0 = everyone within reach, k = k nearest (SchoolParams)
+};
+
+struct SceneConfig {
+    std::string name = "built-in default";
+    float waterY = 0.6f;
+    int waterResolution = 256;              // heightfield cells per side
+    float obstacleCell = 0.06f;             // obstacle field voxel size, 0 = fish only avoid the box walls
+
+    int plants = 25, rocks = 15, corals = 12, shells = 18, driftwood = 8;
+    int anemones = 6, starfish = 10, kelp = 15, chests = 8;
+    int stalkBudget = 4096;                 // plant/kelp stalks simulated per step over all tanks (round-robin), 0 = all
+
+    int bubbleCapacity = 8192;
+    int gpuBubbles = 20000;                 // stateless GPU bubbles per tank
+    float airStoneRate = 24.0f, ventRate = 1.5f;
+
+    int foodCapacity = 20000;               // pellets alive at once, per tank
+    int feedPellets = 800;                  // pellets per feeding (F)
+    float feedSpread = 0.3f;                // radius of the patch they land on
+    float foodLifetime = 60.0f;             // seconds until an uneaten pellet dissolves
+
+    SpeciesConfig species[SPECIES_COUNT];   // indexed by Species
+
+    int totalFish() const;
+};
+
+// Built-in scene, identical to scenes/default.scene.
+SceneConfig defaultSceneConfig();
+
+// Parses `path` on top of the defaults. Returns false (and leaves `out`
+// untouched) if the file cannot be read or fails validation.
+bool loadSceneConfig(const std::string& path, SceneConfig& out);
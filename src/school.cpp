@@ -0,0 +1,356 @@
+#include "school.h"
+#include "food.h"
+#include "jobs.h"
+#include "obstacle_field.h"
+
+#include <algorithm>
+#include <cmath>
+
+void updateSchool(std::vector<FishInst>& fish, const SchoolParams& p, float dt, std::mt19937& rng) {
+    updateSchool(fish, p, dt, rng, 0, fish.size());
+}
+
+static const float NEIGHBOR_DIST2 = 0.18f, AVOID_DIST2 = 0.06f;
+
+// ---------- spatial grid ----------
+// Uniform grid over the school's bounding box, rebuilt with a counting sort
+// whenever it is needed: every step for the k-nearest model, at Verlet list
+// rebuilds for the metric one. The grid lives per thread (tanks step on
+// different workers) and keeps its capacity, so steady-state steps do not
+// allocate. Positions are copied in cell order next to the indices: searches
+// then walk contiguous memory instead of jumping around the fish array.
+namespace {
+struct SchoolGrid {
+    glm::vec3 lo{0.0f};
+    float cell = 1.0f, invCell = 1.0f;
+    glm::ivec3 dim{1};
+    struct Item { glm::vec3 pos; uint32_t fish; };
+    std::vector<uint32_t> cellStart;   // dim.x*dim.y*dim.z + 1 offsets into items
+    std::vector<Item> items;           // grouped by cell, positions as of build()
+
+    glm::ivec3 cellOf(glm::vec3 p) const {
+        glm::ivec3 c((p - lo) * invCell);
+        return glm::clamp(c, glm::ivec3(0), dim - 1);
+    }
+    int index(glm::ivec3 c) const { return (c.z * dim.y + c.y) * dim.x + c.x; }
+
+    // k > 0: cells sized from the box and the school size to hold about k/2
+    // fish each, so a compressed school gets smaller cells rather than fuller
+    // ones. Otherwise cells are `minCell` wide.
+    void build(const std::vector<FishInst>& fish, int k, float minCell = 0.0f) {
+        glm::vec3 bmin(1e30f), bmax(-1e30f);
+        for (const auto& f : fish) { bmin = glm::min(bmin, f.pos); bmax = glm::max(bmax, f.pos); }
+        glm::vec3 size = glm::max(bmax - bmin, glm::vec3(1e-3f));
+        cell = k > 0 ? std::cbrt(size.x * size.y * size.z * (float)k / (2.0f * (float)fish.size())) : minCell;
+        cell = std::max(cell, 1e-4f);
+        cell = std::max(cell, std::max(size.x, std::max(size.y, size.z)) / 64.0f);   // at most 64 cells per axis
+        invCell = 1.0f / cell;
+        lo = bmin;
+        dim = glm::clamp(glm::ivec3(glm::ceil(size * invCell)), glm::ivec3(1), glm::ivec3(64));
+        size_t cells = (size_t)dim.x * dim.y * dim.z;
+        cellStart.assign(cells + 1, 0);
+        items.resize(fish.size());
+        for (const auto& f : fish) ++cellStart[index(cellOf(f.pos))];
+        for (size_t c = 1; c <= cells; ++c) cellStart[c] += cellStart[c - 1];   // end of each cell
+        // Fill back to front: cellStart[c] walks down to the start of cell c
+        for (size_t i = fish.size(); i-- > 0;) items[--cellStart[index(cellOf(fish[i].pos))]] = { fish[i].pos, (uint32_t)i };
+    }
+};
+thread_local SchoolGrid schoolGrid;
+
+struct Neighbor {
+    float d2; uint32_t j;
+    bool operator<(const Neighbor& o) const { return d2 < o.d2; }
+};
+
+// The k nearest other fish, into out[0, return value), unordered. Searches
+// shells of cells outwards from the fish's own and stops once nothing beyond
+// the next shell could be closer than the current k-th. Distances use the
+// positions from the start of the step (the fish themselves are still read
+// live by the caller, as in the metric model).
+int nearestNeighbors(const SchoolGrid& g, glm::vec3 pos, size_t self, int k, Neighbor* out) {
+    const glm::ivec3 c = g.cellOf(pos);
+    const int maxR = std::max(g.dim.x, std::max(g.dim.y, g.dim.z));
+    int n = 0;
+    for (int r = 0; r <= maxR; ++r) {
+        for (int dz = -r; dz <= r; ++dz)
+        for (int dy = -r; dy <= r; ++dy)
+        for (int dx = -r; dx <= r; ++dx) {
+            if (std::max(std::abs(dx), std::max(std::abs(dy), std::abs(dz))) != r) continue;   // shell only
+            glm::ivec3 q = c + glm::ivec3(dx, dy, dz);
+            if (q.x < 0 || q.y < 0 || q.z < 0 || q.x >= g.dim.x || q.y >= g.dim.y || q.z >= g.dim.z) continue;
+            int ci = g.index(q);
+            for (uint32_t it = g.cellStart[ci]; it < g.cellStart[ci + 1]; ++it) {
+                const SchoolGrid::Item& o = g.items[it];
+                if (o.fish == self) continue;
+                glm::vec3 d = o.pos - pos;
+                Neighbor cand{glm::dot(d, d), o.fish};
+                if (n < k) { out[n++] = cand; std::push_heap(out, out + n); }
+                else if (cand.d2 < out[0].d2) { std::pop_heap(out, out + n); out[n - 1] = cand; std::push_heap(out, out + n); }
+            }
+        }
+        float reach = (float)r * g.cell;
+        if (n == k && out[0].d2 <= reach * reach) break;
+    }
+    return n;
+}
+} // namespace
+
+// ---------- Verlet neighbour lists ----------
+size_t SchoolNeighborCache::memoryBytes() const {
+    return (start.capacity() + items.capacity())*sizeof(uint32_t) + builtAt.capacity()*sizeof(glm::vec3);
+}
+
+static void rebuildNeighborCache(SchoolNeighborCache& c, const std::vector<FishInst>& fish) {
+    const float reach = std::sqrt(NEIGHBOR_DIST2) + c.skin, reach2 = reach * reach;
+    const SchoolGrid& g = schoolGrid;
+    schoolGrid.build(fish, 0, reach);   // cells at least `reach` wide: neighbours are one cell away at most
+    const size_t n = fish.size();
+    c.start.resize(n + 1);
+    c.builtAt.resize(n);
+    c.items.clear();
+    for (size_t i = 0; i < n; ++i) {
+        const glm::vec3 pos = fish[i].pos;
+        c.start[i] = (uint32_t)c.items.size();
+        c.builtAt[i] = pos;
+        const glm::ivec3 ci = g.cellOf(pos);
+        for (int z = std::max(ci.z - 1, 0); z <= std::min(ci.z + 1, g.dim.z - 1); ++z)
+        for (int y = std::max(ci.y - 1, 0); y <= std::min(ci.y + 1, g.dim.y - 1); ++y)
+        for (int x = std::max(ci.x - 1, 0); x <= std::min(ci.x + 1, g.dim.x - 1); ++x) {
+            int cell = g.index(glm::ivec3(x, y, z));
+            for (uint32_t it = g.cellStart[cell]; it < g.cellStart[cell + 1]; ++it) {
+                const SchoolGrid::Item& o = g.items[it];
+                glm::vec3 d = o.pos - pos;
+                if (o.fish != i && glm::dot(d, d) < reach2) c.items.push_back(o.fish);
+            }
+        }
+        std::sort(c.items.begin() + c.start[i], c.items.end());   // same order as the full search
+    }
+    c.start[n] = (uint32_t)c.items.size();
+    ++c.rebuilds;
+}
+
+// Lists valid for this step, rebuilding them if needed; nullptr when the step
+// must search in full (no cache, k-nearest model, or a skin thinner than one
+// step of motion).
+static const SchoolNeighborCache* neighborCacheForStep(const SchoolParams& p, const std::vector<FishInst>& fish, float dt) {
+    if (!p.cache || p.neighbors > 0 || fish.empty()) return nullptr;
+    SchoolNeighborCache& c = *p.cache;
+    ++c.steps;
+    // A pair can close in by both fish's displacement since the rebuild plus
+    // this step's motion, which must stay within the skin. With obstacles a
+    // step can also push a fish out by up to one more step of motion.
+    const float stepMove = (p.obstacles ? 2.0f : 1.0f) * p.maxSpeed * std::abs(dt);
+    const float limit = 0.5f * c.skin - stepMove;
+    if (limit <= 0.0f) return nullptr;
+    bool valid = c.builtAt.size() == fish.size();
+    for (size_t i = 0; valid && i < fish.size(); ++i) {
+        glm::vec3 d = fish[i].pos - c.builtAt[i];
+        valid = glm::dot(d, d) <= limit * limit;
+    }
+    if (!valid) rebuildNeighborCache(c, fish);
+    return &c;
+}
+
+// Obstacle steering starts this far from a surface
+static const float OBSTACLE_RANGE = 0.3f;
+
+// ---------- feeding ----------
+// Fish sense pellets within FOOD_SENSE and eat one within FOOD_REACH
+static const float FOOD_SENSE = 0.9f, FOOD_REACH = 0.03f, FOOD_PULL = 1.2f;
+thread_local std::vector<int32_t> foodTargets;
+
+// Nearest pellet of every fish (-1 = none in sense range), looked up in one
+// parallel batch before the school moves. Pellets eaten earlier in the step
+// are skipped; ones eaten during it are re-checked when the fish steers.
+static const int32_t* findFoodTargets(const SchoolParams& p, const std::vector<FishInst>& fish) {
+    if (!p.food || p.food->count() == 0) return nullptr;
+    foodTargets.resize(fish.size());
+    int32_t* out = foodTargets.data();   // not foodTargets itself: workers have their own
+    const FoodSystem& food = *p.food;
+    jobs::parallelFor(fish.size(), 512, [&](size_t b, size_t e) {
+        for (size_t i = b; i < e; ++i) out[i] = food.nearest(fish[i].pos, FOOD_SENSE);
+    });
+    return out;
+}
+
+// Keeps a fish in the swim space. Out of an obstacle it moves by at most the
+// depth and at most one step of motion (maxSpeed * dt), which
+// neighborCacheForStep allows for; the box clamps only bring it closer to
+// where it was, inside the box already.
+static glm::vec3 clampToSwimSpace(glm::vec3 pos, const SchoolParams& p, float dt) {
+    if (p.obstacles) {
+        // Inside an obstacle: back out along the gradient by the depth, which
+        // is not defined where the gradient vanishes (ridges, deep inside)
+        glm::vec3 g;
+        float d = p.obstacles->sample(pos, &g);
+        float g2 = glm::dot(g, g);
+        if (d < 0.0f && g2 > 1e-8f) pos -= g * (std::max(d, -p.maxSpeed * std::abs(dt)) / std::sqrt(g2));
+    }
+    pos.x = std::clamp(pos.x, -p.extents.x*0.9f, p.extents.x*0.9f);
+    pos.z = std::clamp(pos.z, -p.extents.z*0.9f, p.extents.z*0.9f);
+    pos.y = std::clamp(pos.y, p.yMin, p.yMax);
+    return pos;
+}
+
+// Full boids update of fish i. `weight` scales the steering impulse: a fish
+// that last steered n steps ago catches up with n steps' worth.
+static void steerFish(std::vector<FishInst>& fish, size_t i, const SchoolParams& p, float dt, float weight,
+                      int k, Neighbor* nearest, const SchoolNeighborCache* cache, int32_t foodTarget, std::mt19937& rng) {
+    std::uniform_real_distribution<float> urand(-1.0f, 1.0f);
+    auto &f = fish[i];
+    glm::vec3 pos=f.pos, vel=f.vel;
+    glm::vec3 align(0), coh(0), sep(0); int count = 0;
+    if (k > 0) {
+        count = nearestNeighbors(schoolGrid, pos, i, k, nearest);
+        for (int n = 0; n < count; ++n) {
+            const auto &o = fish[nearest[n].j];
+            glm::vec3 d = o.pos - pos; float d2 = glm::dot(d,d);
+            align += o.vel; coh += o.pos;
+            if (d2 < AVOID_DIST2) sep -= d * (0.2f / std::max(d2, 1e-4f));
+        }
+    } else if (cache) {
+        for (uint32_t it = cache->start[i]; it < cache->start[i + 1]; ++it) {
+            const auto &o = fish[cache->items[it]];
+            glm::vec3 d = o.pos - pos; float d2 = glm::dot(d,d);
+            if (d2 < NEIGHBOR_DIST2) {
+                align += o.vel; coh += o.pos; ++count;
+                if (d2 < AVOID_DIST2) sep -= d * (0.2f / std::max(d2, 1e-4f));
+            }
+        }
+    } else {
+        for (auto &o : fish) {
+            if (&o==&f) continue;
+            glm::vec3 d = o.pos - pos; float d2 = glm::dot(d,d);
+            if (d2 < NEIGHBOR_DIST2) {
+                align += o.vel; coh += o.pos; ++count;
+                if (d2 < AVOID_DIST2) sep -= d * (0.2f / std::max(d2, 1e-4f));
+            }
+        }
+    }
+    if (count>0) { align = glm::normalize(align/(float)count) * 0.6f; coh = (coh/(float)count) - pos; }
+
+    // Enhanced bounding forces - fish should stay well within tank
+    glm::vec3 steer(0);
+    float boundaryForce = 3.0f;
+    float softBoundary = 0.85f; // Start applying force before reaching the boundary
+    glm::vec3 lim = p.extents * softBoundary;
+
+    if (p.obstacles) {
+        // Away from the nearest wall or decoration, harder the closer it is
+        glm::vec3 g;
+        float d = p.obstacles->sample(pos, &g);
+        if (d < OBSTACLE_RANGE) steer += g * ((OBSTACLE_RANGE - d) * boundaryForce);
+    } else {
+        if (pos.x > lim.x) steer.x -= (pos.x-lim.x)*boundaryForce;
+        if (pos.x < -lim.x) steer.x += (-lim.x-pos.x)*boundaryForce;
+        if (pos.z > lim.z) steer.z -= (pos.z-lim.z)*boundaryForce;
+        if (pos.z < -lim.z) steer.z += (-lim.z-pos.z)*boundaryForce;
+    }
+    if (pos.y > p.yMax) steer.y -= (pos.y-p.yMax)*boundaryForce*2.0f;
+    if (pos.y < p.yMin) steer.y += (p.yMin-pos.y)*boundaryForce*2.0f;
+
+    if (foodTarget >= 0) {
+        // Head for the pellet, or eat it once in reach
+        FoodSystem& food = *p.food;
+        glm::vec3 d = glm::vec3(food.px[foodTarget], food.py[foodTarget], food.pz[foodTarget]) - pos;
+        float d2 = glm::dot(d,d);
+        if (d2 < FOOD_REACH*FOOD_REACH) food.eat(foodTarget);
+        else if (!food.eaten[foodTarget]) steer += d * (FOOD_PULL / std::sqrt(d2));
+    }
+
+    glm::vec3 drift(std::sin(f.phase*0.7f)*0.1f, std::sin(f.phase*1.3f)*0.05f, std::cos(f.phase*0.9f)*0.1f);
+    glm::vec3 jitter(urand(rng)*0.08f, urand(rng)*0.04f, urand(rng)*0.08f);
+    vel += (align*p.alignment + coh*p.cohesion + sep*1.15f + steer + drift*0.3f + jitter*0.25f) * weight;
+    float s=glm::length(vel); if (s>p.maxSpeed) vel*= (p.maxSpeed/s);
+    pos += vel*dt;
+
+    // Hard clamp as safety net
+    f.pos=clampToSwimSpace(pos, p, dt); f.vel=vel; f.phase += dt*3.0f;
+}
+
+void updateSchool(std::vector<FishInst>& fish, const SchoolParams& p, float dt, std::mt19937& rng, size_t first, size_t last) {
+    const int k = std::min(p.neighbors, SCHOOL_MAX_NEIGHBORS);
+    if (k > 0 && !fish.empty()) schoolGrid.build(fish, k);
+    const SchoolNeighborCache* cache = neighborCacheForStep(p, fish, dt);
+    const int32_t* food = findFoodTargets(p, fish);
+    Neighbor nearest[SCHOOL_MAX_NEIGHBORS];
+    for (size_t i = first; i < last; ++i) steerFish(fish, i, p, dt, 1.0f, k, nearest, cache, food ? food[i] : -1, rng);
+}
+
+// ---------- level of detail ----------
+void updateSchool(std::vector<FishInst>& fish, const SchoolParams& p, float dt, std::mt19937& rng, SchoolLod& lod) {
+    const size_t n = fish.size();
+    if (lod.since.size() != n) {
+        // New or resized school: stagger the slices so tiers don't all steer on the same step
+        lod.since.resize(n);
+        for (size_t i = 0; i < n; ++i) lod.since[i] = (uint8_t)(i % SCHOOL_LOD_MAX_PERIOD);
+    }
+    lod.evaluated = lod.coasted = lod.deferred = 0;
+    if (n == 0) return;
+
+    // Pass 1: tier of every fish, and how many of each tier are due
+    uint32_t due[SCHOOL_LOD_TIERS] = {};
+    lod.tier.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        // Distance over body size: a proxy for the fish's size on screen
+        float key = glm::length(fish[i].pos - lod.camera) / std::max(fish[i].scale, 0.1f);
+        int t = 0;
+        while (t < SCHOOL_LOD_TIERS - 1 && key >= lod.tierStart * (float)(1 << t)) ++t;
+        lod.tier[i] = (uint8_t)t;
+        if (lod.since[i] + 1 >= (1 << t)) ++due[t];
+    }
+    // The budget goes to the nearest tiers first
+    uint32_t allowed[SCHOOL_LOD_TIERS];
+    uint32_t left = lod.budget < 0 ? UINT32_MAX : (uint32_t)lod.budget;
+    for (int t = 0; t < SCHOOL_LOD_TIERS; ++t) { allowed[t] = std::min(due[t], left); left -= allowed[t]; }
+
+    // Within a tier the budget cuts, due fish are taken from a starting point
+    // that moves every step, so the deferred ones are not always the same.
+    const uint8_t STEER = 0x80;
+    size_t i = (size_t)(lod.step++ * 2654435761u) % n;
+    for (size_t r = 0; r < n; ++r, i = i + 1 == n ? 0 : i + 1) {
+        int t = lod.tier[i];
+        if (lod.since[i] + 1 < (1 << t)) continue;
+        if (allowed[t] > 0) { --allowed[t]; lod.tier[i] |= STEER; }
+        else ++lod.deferred;
+    }
+
+    // Pass 2, in school order like the full update: steer or coast
+    const int k = std::min(p.neighbors, SCHOOL_MAX_NEIGHBORS);
+    if (k > 0) schoolGrid.build(fish, k);
+    const SchoolNeighborCache* cache = neighborCacheForStep(p, fish, dt);
+    const int32_t* food = findFoodTargets(p, fish);
+    Neighbor nearest[SCHOOL_MAX_NEIGHBORS];
+    for (size_t j = 0; j < n; ++j) {
+        if (lod.tier[j] & STEER) {
+            float weight = (float)std::min(lod.since[j] + 1, 2 * SCHOOL_LOD_MAX_PERIOD);
+            steerFish(fish, j, p, dt, weight, k, nearest, cache, food ? food[j] : -1, rng);
+            lod.since[j] = 0;
+            ++lod.evaluated;
+        } else {
+            FishInst& f = fish[j];
+            f.pos = clampToSwimSpace(f.pos + f.vel*dt, p, dt);   // extrapolate on the current velocity
+            f.phase += dt*3.0f;
+            lod.since[j] = (uint8_t)std::min(lod.since[j] + 1, 255);
+            ++lod.coasted;
+        }
+    }
+}
+
+void packFishInstances(const std::vector<FishInst>& fish, float* out, glm::vec3 offset) {
+    jobs::parallelFor(fish.size(), 4096, [&](size_t b, size_t e) {
+        for (size_t i = b; i < e; ++i) {
+            const auto &f = fish[i];
+            glm::vec3 dir = glm::length(f.vel)>1e-6f ? glm::normalize(f.vel) : glm::vec3(0,0,-1);
+            float* o = out + i*FISH_INSTANCE_FLOATS;
+            glm::vec3 p = f.pos + offset;
+            o[0]=p.x;     o[1]=p.y;     o[2]=p.z;
+            o[3]=dir.x;   o[4]=dir.y;   o[5]=dir.z;
+            o[6]=f.phase; o[7]=f.scale;
+            o[8]=f.stretch.x; o[9]=f.stretch.y; o[10]=f.stretch.z;
+            o[11]=f.color.r;  o[12]=f.color.g;  o[13]=f.color.b;
+            o[14]=f.species;
+        }
+    });
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class FoodSystem;
+class ObstacleField;
+
+// ===========================================================
+// Fish schooling (boids) and instance packing
+// ===========================================================
+
+enum Species : int { CLOWNFISH=0, NEON_TETRA=1, ZEBRA_DANIO=2, ANGELFISH=3, GOLDFISH=4, BETTA=5, GUPPY=6, PLATY=7 };
+
+struct FishInst {
+    glm::vec3 pos, vel;
+    float phase;
+    float scale;
+    glm::vec3 stretch;
+    glm::vec3 color;
+    float species;
+};
+
+// Largest `neighbors` a school may ask for (bounds the per-fish heap)
+static const int SCHOOL_MAX_NEIGHBORS = 32;
+
+// Verlet neighbour lists for the metric model: for every fish, the fish
+// within reach plus a skin, in CSR form. They are kept across steps until a
+// fish could have crossed the skin (moved half of it, counting the step about
+// to be taken), so most steps skip the search. The lists are ascending, so a
+// step finds the same neighbours in the same order as the full search and the
+// results are bit-identical.
+struct SchoolNeighborCache {
+    float skin = 0.15f;
+    std::vector<uint32_t> start;      // n + 1 offsets into items
+    std::vector<uint32_t> items;      // neighbour indices, ascending per fish
+    std::vector<glm::vec3> builtAt;   // positions at the last rebuild
+    uint64_t steps = 0, rebuilds = 0;
+    size_t memoryBytes() const;
+};
+
+struct SchoolParams {
+    float yMin = -0.8f, yMax = 0.4f;   // swim band
+    float maxSpeed = 0.8f;
+    float cohesion = 0.18f, alignment = 0.45f;
+    glm::vec3 extents{1.0f};           // tank half extents
+    // 0: metric model, every fish within reach counts. k > 0: topological
+    // model, only the k nearest fish count, found through a spatial grid, so
+    // the work per fish stays bounded however tightly the school packs.
+    int neighbors = 0;
+    // Metric model only: neighbour lists reused across steps; nullptr searches every step
+    SchoolNeighborCache* cache = nullptr;
+    // Walls and decorations to steer around. Replaces the box walls in x and z
+    // (the swim band still bounds y); nullptr keeps the plain box.
+    const ObstacleField* obstacles = nullptr;
+    // Pellets to chase: each fish seeks the nearest one it can sense and eats
+    // it on reaching it. nullptr (or no pellets) = no feeding.
+    FoodSystem* food = nullptr;
+};
+
+// Alignment, cohesion and separation against the fish's neighbours (see
+// SchoolParams::neighbors), plus soft walls or obstacles, the pull of food
+// and a little drift. Fish are
+// updated in place, in order.
+void updateSchool(std::vector<FishInst>& fish, const SchoolParams& p, float dt, std::mt19937& rng);
+// Same, for fish [first, last) only (still against the whole school); lets the
+// benchmarks sample schools too large for a full O(n^2) metric pass.
+void updateSchool(std::vector<FishInst>& fish, const SchoolParams& p, float dt, std::mt19937& rng, size_t first, size_t last);
+
+// Simulation level of detail. Fish are bucketed by distance to the camera over
+// body size (a proxy for their size on screen); tier t steers every 2^t steps,
+// in staggered round-robin slices, and coasts along its velocity in between.
+// A fish that steers after n steps applies n steps' worth of steering. `budget`
+// caps the steering updates of one call; the nearest tiers are served first and
+// the rest coast one more step.
+static const int SCHOOL_LOD_TIERS = 4;
+static const int SCHOOL_LOD_MAX_PERIOD = 1 << (SCHOOL_LOD_TIERS - 1);
+
+struct SchoolLod {
+    // Inputs
+    glm::vec3 camera{0.0f};         // in the school's (tank-local) space
+    float tierStart = 1.5f;         // distance/scale where tier 1 begins; tier t from tierStart * 2^(t-1)
+    int budget = -1;                // steering updates allowed this call, < 0 = no cap
+    // State, owned by the school between calls
+    uint32_t step = 0;
+    std::vector<uint8_t> since;     // per fish: steps since it last steered
+    std::vector<uint8_t> tier;      // per fish, scratch
+    // Outputs of the last call
+    int evaluated = 0, coasted = 0, deferred = 0;   // deferred: due but over budget
+};
+void updateSchool(std::vector<FishInst>& fish, const SchoolParams& p, float dt, std::mt19937& rng, SchoolLod& lod);
+
+// Per-instance attributes for fish.vert, FISH_INSTANCE_FLOATS per fish:
+// pos(3) dir(3) phase scale stretch(3) color(3) species. `offset` moves the
+// school from tank-local to world space.
+static const int FISH_INSTANCE_FLOATS = 15;
+void packFishInstances(const std::vector<FishInst>& fish, float* out, glm::vec3 offset = glm::vec3(0.0f));
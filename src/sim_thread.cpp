@@ -0,0 +1,80 @@
+#include "sim_thread.h"
+
+#include <algorithm>
+
+using Clock = std::chrono::steady_clock;
+
+void SimThread::start(StepFn fn) {
+    stop();
+    step = std::move(fn);
+    quit = false;
+    // Sequence numbers restart, so the frames from a previous run look stale
+    consumedSeq = 0; lastConsumed = 0;
+    for (int i = 0; i < 3; ++i) frames.all()[i].seq = 0;
+    windowStart = Clock::now();
+    worker = std::thread(&SimThread::run, this);
+}
+
+void SimThread::stop() {
+    if (!worker.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lk(paceMutex);
+        quit = true;
+    }
+    paceCv.notify_one();
+    worker.join();
+}
+
+void SimThread::run() {
+    auto last = Clock::now();
+    uint64_t seq = 0;
+    while (!quit) {
+        auto t0 = Clock::now();
+        float dt = std::min(std::chrono::duration<float>(t0 - last).count(), 0.1f) * timeScale.load(std::memory_order_relaxed);
+        last = t0;
+
+        SimFrame& out = frames.back();
+        step(dt, out);
+        out.seq = ++seq;
+        out.published = Clock::now();
+        frames.publish();
+
+        simBusyNs += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(out.published - t0).count();
+        ++simSteps;
+
+        // Stay one frame ahead: wait until the renderer has picked up this frame
+        std::unique_lock<std::mutex> lk(paceMutex);
+        paceCv.wait(lk, [&] { return quit || consumedSeq.load(std::memory_order_acquire) >= seq; });
+    }
+}
+
+bool SimThread::acquire() {
+    if (!frames.acquire()) return false;
+    const SimFrame& f = frames.front();
+    if (f.seq <= lastConsumed) return false;   // left over from before a restart
+    skipped += f.seq - lastConsumed - 1;
+    lastConsumed = f.seq;
+    latencySumMs += std::chrono::duration<double, std::milli>(Clock::now() - f.published).count();
+    ++latencyCount;
+    {
+        std::lock_guard<std::mutex> lk(paceMutex);
+        consumedSeq.store(f.seq, std::memory_order_release);
+    }
+    paceCv.notify_one();
+    return true;
+}
+
+SimMetrics SimThread::takeMetrics() {
+    SimMetrics m;
+    auto now = Clock::now();
+    double wallMs = std::chrono::duration<double, std::milli>(now - windowStart).count();
+    uint64_t steps = simSteps.exchange(0);
+    double simMs = (double)simBusyNs.exchange(0) * 1e-6;
+    m.simMs = steps ? simMs / steps : 0.0;
+    m.latencyMs = latencyCount ? latencySumMs / latencyCount : 0.0;
+    m.overlap = wallMs > 0.0 ? (simMs + renderBusyMs) / wallMs : 0.0;
+    m.skipped = skipped.exchange(0);
+    latencySumMs = 0.0; latencyCount = 0; renderBusyMs = 0.0;
+    windowStart = now;
+    return m;
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "scene_config.h"
+
+// ===========================================================
+// Pipelined simulation thread
+// ===========================================================
+
+// Lock-free triple buffer: the writer fills back() and publish()es it, the
+// reader acquire()s the newest published slot. Neither side ever waits; a
+// frame published twice before the reader looks is simply skipped.
+template<typename T>
+class TripleBuffer {
+public:
+    T& back() { return slots[backIdx]; }
+    void publish() { backIdx = middle.exchange(backIdx | kFresh, std::memory_order_acq_rel) & kIndexMask; }
+    bool acquire() {
+        if (!(middle.load(std::memory_order_acquire) & kFresh)) return false;
+        frontIdx = middle.exchange(frontIdx, std::memory_order_acq_rel) & kIndexMask;
+        return true;
+    }
+    const T& front() const { return slots[frontIdx]; }
+    T* all() { return slots; }
+
+private:
+    static const int kFresh = 4, kIndexMask = 3;
+    T slots[3];
+    int backIdx = 0, frontIdx = 1;
+    std::atomic<int> middle{2};
+};
+
+// Everything the renderer needs from one simulated frame, already packed.
+struct SimFrame {
+    std::vector<float> fish[SPECIES_COUNT];   // FISH_INSTANCE_FLOATS per fish
+    std::vector<float> bubbles;               // x,y,z,size per used pool slot, tank after tank
+    std::vector<float> food;                  // decoration instances, one per pellet
+    std::vector<float> stalks;                // plant/kelp chain nodes, see packStalks in main.cpp
+    std::vector<float> water;                 // heightfield texels
+    uint64_t waterSeq = 0;                    // bumps when `water` changed
+    float simTime = 0.0f;
+    uint64_t seq = 0;
+    std::chrono::steady_clock::time_point published;
+};
+
+struct SimMetrics {
+    double simMs = 0.0;        // average step cost
+    double latencyMs = 0.0;    // average publish -> acquire
+    double overlap = 0.0;      // (sim busy + render busy) / wall; > 1 means they ran concurrently
+    uint64_t skipped = 0;      // frames published but never rendered
+};
+
+class SimThread {
+public:
+    using StepFn = std::function<void(float dt, SimFrame& out)>;
+
+    ~SimThread() { stop(); }
+    // Runs step() on its own thread, at most one frame ahead of the renderer.
+    void start(StepFn step);
+    void stop();
+    bool running() const { return worker.joinable(); }
+
+    // Render thread: swaps in the newest frame, if any; front() stays valid until the next call.
+    bool acquire();
+    const SimFrame& front() const { return frames.front(); }
+
+    void setTimeScale(float s) { timeScale.store(s, std::memory_order_relaxed); }
+
+    // Render thread reports its own CPU time per frame; metrics cover the
+    // window since the previous call.
+    void addRenderTime(double ms) { renderBusyMs += ms; }
+    SimMetrics takeMetrics();
+
+private:
+    void run();
+
+    StepFn step;
+    std::thread worker;
+    std::atomic<bool> quit{false};
+    std::atomic<float> timeScale{1.0f};
+    TripleBuffer<SimFrame> frames;
+
+    // Pacing: the sim thread sleeps only when it is already a frame ahead
+    std::mutex paceMutex;
+    std::condition_variable paceCv;
+    std::atomic<uint64_t> consumedSeq{0};
+
+    std::atomic<uint64_t> simBusyNs{0}, simSteps{0}, skipped{0};
+    uint64_t lastConsumed = 0;
+    double latencySumMs = 0.0; uint64_t latencyCount = 0;
+    double renderBusyMs = 0.0;
+    std::chrono::steady_clock::time_point windowStart = std::chrono::steady_clock::now();
+};
@@ -0,0 +1,173 @@
+#include "snapshot.h"
+
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t sectionCount;
+    uint32_t reserved;
+};
+struct SectionEntry {
+    char name[32];
+    uint64_t offset;
+    uint64_t bytes;
+};
+const char SNAP_MAGIC[4]   = {'A','Q','S','N'};
+const char REPLAY_MAGIC[4] = {'A','Q','R','P'};
+
+uint64_t align16(uint64_t v) { return (v + 15) & ~uint64_t(15); }
+
+} // namespace
+
+// ---------------- SnapshotWriter ----------------
+void SnapshotWriter::add(const char* name, const void* data, size_t bytes) {
+    Section s; s.name = prefix + name;
+    if (s.name.size() >= sizeof(SectionEntry::name)) std::cerr << "Snapshot: section name " << s.name << " is too long\n";
+    s.bytes.resize(bytes);
+    if (bytes) std::memcpy(s.bytes.data(), data, bytes);
+    sections.push_back(std::move(s));
+}
+
+bool SnapshotWriter::save(const std::string& path) const {
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) { std::cerr << "Snapshot: cannot write " << path << "\n"; return false; }
+
+    FileHeader h; std::memcpy(h.magic, SNAP_MAGIC, 4);
+    h.version = SNAPSHOT_VERSION; h.sectionCount = (uint32_t)sections.size(); h.reserved = 0;
+
+    std::vector<SectionEntry> table(sections.size());
+    uint64_t off = align16(sizeof(FileHeader) + table.size() * sizeof(SectionEntry));
+    for (size_t i = 0; i < sections.size(); ++i) {
+        std::memset(table[i].name, 0, sizeof(table[i].name));
+        std::strncpy(table[i].name, sections[i].name.c_str(), sizeof(table[i].name) - 1);
+        table[i].offset = off;
+        table[i].bytes = sections[i].bytes.size();
+        off = align16(off + table[i].bytes);
+    }
+
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1;
+    if (!table.empty()) ok = ok && fwrite(table.data(), sizeof(SectionEntry), table.size(), f) == table.size();
+    static const uint8_t zeros[16] = {};
+    uint64_t at = sizeof(FileHeader) + table.size() * sizeof(SectionEntry);
+    for (size_t i = 0; i < sections.size() && ok; ++i) {
+        ok = fwrite(zeros, 1, table[i].offset - at, f) == table[i].offset - at;
+        const auto& b = sections[i].bytes;
+        if (!b.empty()) ok = ok && fwrite(b.data(), 1, b.size(), f) == b.size();
+        at = table[i].offset + b.size();
+    }
+    fclose(f);
+    if (!ok) std::cerr << "Snapshot: short write to " << path << "\n";
+    return ok;
+}
+
+// ---------------- SnapshotReader ----------------
+bool SnapshotReader::open(const std::string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) { std::cerr << "Snapshot: cannot open " << path << "\n"; return false; }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(FileHeader)) {
+        std::cerr << "Snapshot: " << path << " is too small\n";
+        ::close(fd); return false;
+    }
+    void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) { std::cerr << "Snapshot: mmap failed for " << path << "\n"; return false; }
+    base = static_cast<const uint8_t*>(p);
+    size = (size_t)st.st_size;
+
+    const FileHeader* h = reinterpret_cast<const FileHeader*>(base);
+    if (std::memcmp(h->magic, SNAP_MAGIC, 4) != 0) {
+        std::cerr << "Snapshot: " << path << " is not a snapshot file\n";
+        close(); return false;
+    }
+    if (h->version != SNAPSHOT_VERSION) {
+        std::cerr << "Snapshot: " << path << " has version " << h->version
+                  << ", expected " << SNAPSHOT_VERSION << "\n";
+        close(); return false;
+    }
+    count = h->sectionCount;
+    if (sizeof(FileHeader) + (size_t)count * sizeof(SectionEntry) > size) {
+        std::cerr << "Snapshot: " << path << " has a truncated section table\n";
+        close(); return false;
+    }
+    return true;
+}
+
+void SnapshotReader::close() {
+    if (base) munmap(const_cast<uint8_t*>(base), size);
+    base = nullptr; size = 0; count = 0;
+}
+
+bool SnapshotReader::find(const char* name, const void*& data, size_t& bytes) const {
+    if (!base) return false;
+    const std::string full = prefix + name;
+    const SectionEntry* table = reinterpret_cast<const SectionEntry*>(base + sizeof(FileHeader));
+    for (uint32_t i = 0; i < count; ++i) {
+        if (std::strncmp(table[i].name, full.c_str(), sizeof(table[i].name)) != 0) continue;
+        if (table[i].offset + table[i].bytes > size) return false;
+        data = base + table[i].offset;
+        bytes = (size_t)table[i].bytes;
+        return true;
+    }
+    return false;
+}
+
+// ---------------- Replay ----------------
+bool ReplayRecorder::open(const std::string& path) {
+    close();
+    file = fopen(path.c_str(), "wb");
+    if (!file) { std::cerr << "Replay: cannot write " << path << "\n"; return false; }
+    FileHeader h; std::memcpy(h.magic, REPLAY_MAGIC, 4);
+    h.version = REPLAY_VERSION; h.sectionCount = 0; h.reserved = (uint32_t)sizeof(ReplayFrame);
+    fwrite(&h, sizeof(h), 1, file);
+    count = 0;
+    return true;
+}
+
+void ReplayRecorder::write(const ReplayFrame& f) {
+    if (!file) return;
+    fwrite(&f, sizeof(f), 1, file);
+    ++count;
+}
+
+void ReplayRecorder::close() {
+    if (!file) return;
+    // Patch the frame count into the header
+    fseek(file, offsetof(FileHeader, sectionCount), SEEK_SET);
+    fwrite(&count, sizeof(count), 1, file);
+    fclose(file);
+    file = nullptr;
+}
+
+bool ReplayPlayer::open(const std::string& path) {
+    frames.clear(); pos = 0;
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) { std::cerr << "Replay: cannot open " << path << "\n"; return false; }
+    FileHeader h;
+    bool ok = fread(&h, sizeof(h), 1, f) == 1 && std::memcmp(h.magic, REPLAY_MAGIC, 4) == 0;
+    if (!ok || h.version != REPLAY_VERSION || h.reserved != sizeof(ReplayFrame)) {
+        std::cerr << "Replay: " << path << " is not a compatible recording\n";
+        fclose(f); return false;
+    }
+    frames.resize(h.sectionCount);
+    size_t got = frames.empty() ? 0 : fread(frames.data(), sizeof(ReplayFrame), frames.size(), f);
+    fclose(f);
+    frames.resize(got);
+    return true;
+}
+
+bool ReplayPlayer::next(ReplayFrame& f) {
+    if (pos >= frames.size()) return false;
+    f = frames[pos++];
+    return true;
+}
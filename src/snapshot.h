@@ -0,0 +1,128 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// ===========================================================
+// Versioned binary snapshots and input/dt recordings
+// ===========================================================
+//
+// Snapshot file: header, section table, then 16-byte aligned section blobs.
+// Sections are raw little-endian POD arrays keyed by a short name, so new
+// state can be added without breaking older readers.
+
+static const uint32_t SNAPSHOT_VERSION = 1;
+static const uint32_t REPLAY_VERSION = 1;
+
+class SnapshotWriter {
+public:
+    void add(const char* name, const void* data, size_t bytes);
+    template<typename T> void addVector(const char* name, const std::vector<T>& v) {
+        add(name, v.data(), v.size() * sizeof(T));
+    }
+    template<typename T> void addValue(const char* name, const T& v) { add(name, &v, sizeof(T)); }
+    // Standard engines only define a textual state format, stored verbatim
+    template<typename Rng> void addRng(const char* name, const Rng& r) {
+        std::ostringstream o; o << r;
+        std::string s = o.str(); add(name, s.data(), s.size());
+    }
+    bool save(const std::string& path) const;
+    // Put in front of every section name added from here on, e.g. "tank1."
+    void setPrefix(const std::string& p) { prefix = p; }
+
+private:
+    struct Section { std::string name; std::vector<uint8_t> bytes; };
+    std::vector<Section> sections;
+    std::string prefix;
+};
+
+// Maps the file read-only; section pointers stay valid while the reader lives.
+class SnapshotReader {
+public:
+    SnapshotReader() = default;
+    SnapshotReader(const SnapshotReader&) = delete;
+    SnapshotReader& operator=(const SnapshotReader&) = delete;
+    ~SnapshotReader() { close(); }
+
+    bool open(const std::string& path);
+    void close();
+
+    // Looked up in front of every section name from here on, see SnapshotWriter
+    void setPrefix(const std::string& p) { prefix = p; }
+    bool find(const char* name, const void*& data, size_t& bytes) const;
+    template<typename T> bool readVector(const char* name, std::vector<T>& v) const {
+        const void* d; size_t n;
+        if (!find(name, d, n) || n % sizeof(T) != 0) return false;
+        const T* p = static_cast<const T*>(d);
+        v.assign(p, p + n / sizeof(T));
+        return true;
+    }
+    template<typename T> bool readValue(const char* name, T& v) const {
+        const void* d; size_t n;
+        if (!find(name, d, n) || n != sizeof(T)) return false;
+        std::memcpy(&v, d, sizeof(T));
+        return true;
+    }
+    template<typename Rng> bool readRng(const char* name, Rng& r) const {
+        const void* d; size_t n;
+        if (!find(name, d, n)) return false;
+        std::istringstream in(std::string(static_cast<const char*>(d), n));
+        in >> r;
+        return !in.fail();
+    }
+
+private:
+    const uint8_t* base = nullptr;
+    size_t size = 0;
+    uint32_t count = 0;
+    std::string prefix;
+};
+
+// One simulated frame as seen by the simulation: everything needed to feed
+// it again bit-exactly, plus a hash of the resulting state for diffing.
+struct ReplayFrame {
+    float dt = 0.0f, rawDt = 0.0f;
+    uint32_t input = 0;          // REPLAY_INPUT_* bits pressed this frame
+    float camYaw = 0.0f, camPitch = 0.0f;
+    glm::vec3 camPos{0.0f};
+    uint64_t stateHash = 0;
+};
+enum : uint32_t { REPLAY_INPUT_TOGGLE_GPU_BUBBLES = 1u << 0, REPLAY_INPUT_FEED = 1u << 1 };
+
+class ReplayRecorder {
+public:
+    ~ReplayRecorder() { close(); }
+    bool open(const std::string& path);
+    void write(const ReplayFrame& f);
+    void close();
+    bool active() const { return file != nullptr; }
+    uint32_t frames() const { return count; }
+private:
+    FILE* file = nullptr;
+    uint32_t count = 0;
+};
+
+class ReplayPlayer {
+public:
+    bool open(const std::string& path);
+    bool next(ReplayFrame& f);
+    bool active() const { return pos < frames.size(); }
+    size_t frameCount() const { return frames.size(); }
+    size_t position() const { return pos; }
+private:
+    std::vector<ReplayFrame> frames;
+    size_t pos = 0;
+};
+
+// FNV-1a, used to fingerprint simulation state per frame
+inline uint64_t hashBytes(const void* data, size_t bytes, uint64_t h = 1469598103934665603ull) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < bytes; ++i) { h ^= p[i]; h *= 1099511628211ull; }
+    return h;
+}
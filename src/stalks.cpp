@@ -0,0 +1,210 @@
+#include "stalks.h"
+#include "jobs.h"
+#include "snapshot.h"
+
+#include <algorithm>
+#include <cmath>
+
+static const float MAX_STEP = 1.0f / 15.0f;   // a stalk that waited longer drops the excess
+static const float CURRENT = 0.8f;            // peak sideways push of the water at a tip
+
+void StalkSystem::init(const std::vector<StalkSpec>& specs) {
+    n = (int)specs.size();
+    cursor = 0; lastUpdated = 0; time = 0.0f;
+    for (auto* v : { &baseX, &baseY, &baseZ, &segLen, &phase, &stiffness, &buoyancy }) v->resize(n);
+    pending.assign(n, 0.0f);
+    lastDt.assign(n, 1.0f / 60.0f);
+    for (auto* v : { &x, &y, &z }) v->resize((size_t)n * STALK_NODES);
+    for (int s = 0; s < n; ++s) {
+        const StalkSpec& sp = specs[s];
+        baseX[s] = sp.base.x; baseY[s] = sp.base.y; baseZ[s] = sp.base.z;
+        segLen[s] = sp.height / (float)(STALK_NODES - 1);
+        phase[s] = sp.phase; stiffness[s] = sp.stiffness; buoyancy[s] = sp.buoyancy;
+        for (int k = 0; k < STALK_NODES; ++k) {
+            size_t i = (size_t)k * n + s;
+            x[i] = sp.base.x; y[i] = sp.base.y + segLen[s] * (float)k; z[i] = sp.base.z;
+        }
+    }
+    px = x; py = y; pz = z;
+}
+
+void StalkSystem::step(float dt, const std::vector<glm::vec4>& colliders, int budget) {
+    lastUpdated = 0;
+    if (n == 0 || dt <= 0.0f) return;   // paused: keep the velocities for later
+    time += dt;
+    for (int s = 0; s < n; ++s) pending[s] += dt;
+    buildGrid(colliders);
+
+    // Budgeted window [cursor, cursor + m), wrapping around
+    const int m = budget < 0 ? n : std::min(budget, n);
+    auto run = [this](int b, int e) {
+        jobs::parallelFor((size_t)(e - b), 64, [this, b](size_t rb, size_t re) { simulate(b + (int)rb, b + (int)re); });
+    };
+    if (m == n) {
+        run(0, n);
+        cursor = 0;
+    } else {
+        int end = cursor + m;
+        run(cursor, std::min(end, n));
+        if (end > n) run(0, end - n);
+        cursor = end % n;
+    }
+    lastUpdated = m;
+}
+
+void StalkSystem::simulate(int b, int e) {
+    const size_t N = (size_t)n;
+    const int K = STALK_NODES;
+    // Per stalk, once: the current (a slow swirl, out of phase between stalks)
+    thread_local std::vector<float> curX, curZ;
+    curX.resize(e - b); curZ.resize(e - b);
+    for (int s = b; s < e; ++s) {
+        curX[s - b] = CURRENT * std::sin(time * 0.8f + phase[s]);
+        curZ[s - b] = 0.5f * CURRENT * std::cos(time * 0.55f + phase[s] * 1.3f);
+    }
+    const float* cx = curX.data() - b;
+    const float* cz = curZ.data() - b;
+    const float* h0 = pending.data();
+    const float* last = lastDt.data();
+
+    // Verlet: damped velocity (rescaled for a different step); the current and
+    // buoyancy grow towards the tip, the spring back to upright towards the root
+    for (int k = 1; k < K; ++k) {
+        const float frac = (float)k / (float)(K - 1), hold = 1.0f - 0.5f * frac;
+        float* X = &x[k * N]; float* Y = &y[k * N]; float* Z = &z[k * N];
+        float* PX = &px[k * N]; float* PY = &py[k * N]; float* PZ = &pz[k * N];
+        for (int s = b; s < e; ++s) {
+            float h = std::min(h0[s], MAX_STEP);
+            float damp = std::max(0.0f, 1.0f - 1.5f * h) * (h / last[s]);
+            float vx = (X[s] - PX[s]) * damp, vy = (Y[s] - PY[s]) * damp, vz = (Z[s] - PZ[s]) * damp;
+            PX[s] = X[s]; PY[s] = Y[s]; PZ[s] = Z[s];
+            float spring = stiffness[s] * hold;
+            float ax = cx[s] * frac + (baseX[s] - X[s]) * spring;
+            float ay = buoyancy[s] * frac + (baseY[s] + segLen[s] * (float)k - Y[s]) * spring;
+            float az = cz[s] * frac + (baseZ[s] - Z[s]) * spring;
+            X[s] += vx + ax * h * h; Y[s] += vy + ay * h * h; Z[s] += vz + az * h * h;
+        }
+    }
+
+    collide(b, e);
+
+    // Segment lengths, root to tip; the root is pinned, so the first segment moves only its tip
+    for (int it = 0; it < iterations; ++it)
+        for (int k = 1; k < K; ++k) {
+            float* X0 = &x[(k - 1) * N]; float* Y0 = &y[(k - 1) * N]; float* Z0 = &z[(k - 1) * N];
+            float* X1 = &x[k * N]; float* Y1 = &y[k * N]; float* Z1 = &z[k * N];
+            const float w0 = k == 1 ? 0.0f : 0.5f, w1 = k == 1 ? 1.0f : 0.5f;
+            for (int s = b; s < e; ++s) {
+                float dx = X1[s] - X0[s], dy = Y1[s] - Y0[s], dz = Z1[s] - Z0[s];
+                float d = std::sqrt(dx * dx + dy * dy + dz * dz) + 1e-9f;
+                float diff = (d - segLen[s]) / d;
+                X0[s] += dx * diff * w0; Y0[s] += dy * diff * w0; Z0[s] += dz * diff * w0;
+                X1[s] -= dx * diff * w1; Y1[s] -= dy * diff * w1; Z1[s] -= dz * diff * w1;
+            }
+        }
+    // Never below the sand
+    for (int k = 1; k < K; ++k) {
+        float* Y = &y[k * N];
+        for (int s = b; s < e; ++s) Y[s] = std::max(Y[s], baseY[s]);
+    }
+
+    for (int s = b; s < e; ++s) { lastDt[s] = std::min(pending[s], MAX_STEP); pending[s] = 0.0f; }
+}
+
+void StalkSystem::buildGrid(const std::vector<glm::vec4>& colliders) {
+    binned.resize(colliders.size());
+    if (colliders.empty()) { dim = glm::ivec3(0); return; }
+    glm::vec3 lo(1e30f), hi(-1e30f);
+    maxRadius = 0.0f;
+    for (const glm::vec4& c : colliders) {
+        lo = glm::min(lo, glm::vec3(c)); hi = glm::max(hi, glm::vec3(c));
+        maxRadius = std::max(maxRadius, c.w);
+    }
+    // Cells at least as wide as the largest collider, so a node only checks the 27 around it
+    glm::vec3 size = glm::max(hi - lo, glm::vec3(1e-3f));
+    cell = std::max(std::max(maxRadius, 1e-3f), std::max(size.x, std::max(size.y, size.z)) / 64.0f);
+    invCell = 1.0f / cell;
+    gridLo = lo; gridHi = hi;
+    dim = glm::clamp(glm::ivec3(glm::ceil(size * invCell)), glm::ivec3(1), glm::ivec3(64));
+    auto index = [&](glm::vec3 p) {
+        glm::ivec3 c = glm::clamp(glm::ivec3((p - lo) * invCell), glm::ivec3(0), dim - 1);
+        return (c.z * dim.y + c.y) * dim.x + c.x;
+    };
+    size_t cells = (size_t)dim.x * dim.y * dim.z;
+    cellStart.assign(cells + 1, 0);
+    for (const glm::vec4& c : colliders) ++cellStart[index(glm::vec3(c))];
+    for (size_t c = 1; c <= cells; ++c) cellStart[c] += cellStart[c - 1];
+    for (size_t i = colliders.size(); i-- > 0;) binned[--cellStart[index(glm::vec3(colliders[i]))]] = colliders[i];
+}
+
+void StalkSystem::collide(int b, int e) {
+    if (dim.x == 0) return;
+    const size_t N = (size_t)n;
+    const glm::vec3 reachLo = gridLo - glm::vec3(maxRadius), reachHi = gridHi + glm::vec3(maxRadius);
+    for (int k = 1; k < STALK_NODES; ++k) {
+        float* X = &x[k * N]; float* Y = &y[k * N]; float* Z = &z[k * N];
+        for (int s = b; s < e; ++s) {
+            glm::vec3 p(X[s], Y[s], Z[s]);
+            if (p.x < reachLo.x || p.y < reachLo.y || p.z < reachLo.z
+                || p.x > reachHi.x || p.y > reachHi.y || p.z > reachHi.z) continue;
+            glm::ivec3 c = glm::ivec3(glm::floor((p - gridLo) * invCell));
+            glm::ivec3 c0 = glm::max(c - 1, glm::ivec3(0)), c1 = glm::min(c + 1, dim - 1);
+            for (int cz = c0.z; cz <= c1.z; ++cz)
+                for (int cy = c0.y; cy <= c1.y; ++cy) {
+                    int row = (cz * dim.y + cy) * dim.x;
+                    for (uint32_t it = cellStart[row + c0.x]; it < cellStart[row + c1.x + 1]; ++it) {
+                        const glm::vec4& f = binned[it];
+                        glm::vec3 d = p - glm::vec3(f);
+                        float d2 = glm::dot(d, d);
+                        if (d2 >= f.w * f.w || d2 < 1e-12f) continue;
+                        p = glm::vec3(f) + d * (f.w / std::sqrt(d2));   // out to the fish's surface
+                    }
+                }
+            X[s] = p.x; Y[s] = p.y; Z[s] = p.z;
+        }
+    }
+}
+
+void StalkSystem::pack(float* out, int first, int count, glm::vec3 offset) const {
+    const size_t N = (size_t)n;
+    for (int s = first; s < first + count; ++s)
+        for (int k = 0; k < STALK_NODES; ++k) {
+            size_t i = k * N + s;
+            *out++ = x[i] + offset.x; *out++ = y[i] + offset.y; *out++ = z[i] + offset.z;
+        }
+}
+
+size_t StalkSystem::memoryBytes() const {
+    size_t f = 0;
+    for (auto* v : { &baseX, &baseY, &baseZ, &segLen, &phase, &stiffness, &buoyancy, &pending, &lastDt,
+                     &x, &y, &z, &px, &py, &pz }) f += v->capacity();
+    return f * sizeof(float) + cellStart.capacity() * sizeof(uint32_t) + binned.capacity() * sizeof(glm::vec4);
+}
+
+void StalkSystem::save(SnapshotWriter& w) const {
+    int32_t counters[2] = { n, cursor };
+    w.addValue("stalks.counters", counters);
+    w.addValue("stalks.time", time);
+    w.addVector("stalks.x", x); w.addVector("stalks.y", y); w.addVector("stalks.z", z);
+    w.addVector("stalks.px", px); w.addVector("stalks.py", py); w.addVector("stalks.pz", pz);
+    w.addVector("stalks.pending", pending);
+    w.addVector("stalks.last_dt", lastDt);
+}
+
+bool StalkSystem::load(const SnapshotReader& r) {
+    int32_t counters[2]; float t;
+    if (!r.readValue("stalks.counters", counters) || !r.readValue("stalks.time", t) || counters[0] != n) return false;
+    std::vector<float> v[8];
+    const char* const keys[8] = { "stalks.x", "stalks.y", "stalks.z", "stalks.px", "stalks.py", "stalks.pz",
+                                  "stalks.pending", "stalks.last_dt" };
+    for (int i = 0; i < 8; ++i) {
+        size_t want = i < 6 ? (size_t)n * STALK_NODES : (size_t)n;
+        if (!r.readVector(keys[i], v[i]) || v[i].size() != want) return false;
+    }
+    x.swap(v[0]); y.swap(v[1]); z.swap(v[2]);
+    px.swap(v[3]); py.swap(v[4]); pz.swap(v[5]);
+    pending.swap(v[6]); lastDt.swap(v[7]);
+    cursor = std::clamp(counters[1], 0, std::max(n - 1, 0));
+    time = t;
+    return true;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class SnapshotWriter;
+class SnapshotReader;
+
+// ===========================================================
+// Plant and kelp stalks: Verlet particle chains
+// ===========================================================
+//
+// Every stalk is a chain of STALK_NODES particles rooted in the sand. Each
+// step integrates them with Verlet (buoyancy, a slow current, a pull back
+// towards standing upright), pushes them out of any fish they touch and then
+// relaxes the segment lengths. Node state is SoA and node-major (all stalks'
+// node k, then node k+1), so every pass is a flat loop over stalks that the
+// compiler vectorizes. A budget caps the stalks updated per step; the rest
+// wait their turn, round-robin, and catch up on the time they missed.
+
+static const int STALK_NODES = 8;   // including the root
+
+struct StalkSpec {
+    glm::vec3 base{0.0f};     // root, on the sand
+    float height = 0.5f;      // rest length of the chain
+    float phase = 0.0f;       // offsets the current so neighbours don't move in lockstep
+    float stiffness = 4.0f;   // spring back to upright, acceleration per unit of displacement
+    float buoyancy = 0.0f;    // upward acceleration at the tip
+};
+
+class StalkSystem {
+public:
+    // Replaces every stalk, standing straight up
+    void init(const std::vector<StalkSpec>& specs);
+
+    // One step. `colliders` are spheres (xyz = centre, w = radius) the nodes
+    // are pushed out of, in the same space as the stalks. `budget` caps the
+    // stalks updated, < 0 = all of them.
+    void step(float dt, const std::vector<glm::vec4>& colliders, int budget = -1);
+
+    // Stalks [first, first + count): STALK_NODES nodes of xyz each, stalk
+    // after stalk, moved by `offset`
+    void pack(float* out, int first, int count, glm::vec3 offset = glm::vec3(0.0f)) const;
+
+    void save(SnapshotWriter& w) const;
+    bool load(const SnapshotReader& r);   // false (and unchanged) if missing or for other stalks
+
+    int count() const { return n; }
+    int updated() const { return lastUpdated; }   // stalks the last step touched
+    glm::vec3 node(int stalk, int k) const { size_t i = (size_t)k * n + stalk; return glm::vec3(x[i], y[i], z[i]); }
+    size_t memoryBytes() const;
+
+    int iterations = 3;   // constraint relaxation passes per update
+
+    // SoA node state, node-major: [k * count() + stalk]
+    std::vector<float> x, y, z, px, py, pz;
+
+private:
+    void simulate(int b, int e);   // stalks [b, e)
+    void buildGrid(const std::vector<glm::vec4>& colliders);
+    void collide(int b, int e);
+
+    int n = 0;
+    int cursor = 0;        // first stalk of the next budgeted window
+    int lastUpdated = 0;
+    float time = 0.0f;
+
+    // Per stalk
+    std::vector<float> baseX, baseY, baseZ, segLen, phase, stiffness, buoyancy;
+    std::vector<float> pending;   // time since the stalk was last updated
+    std::vector<float> lastDt;    // step it was last updated with
+
+    // Colliders binned in a uniform grid (counting sort) for the current step
+    glm::vec3 gridLo{0.0f}, gridHi{0.0f};
+    float cell = 1.0f, invCell = 1.0f, maxRadius = 0.0f;
+    glm::ivec3 dim{0};
+    std::vector<uint32_t> cellStart;
+    std::vector<glm::vec4> binned;
+};
@@ -0,0 +1,290 @@
+#include "tank.h"
+#include "poisson_disk.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// A distribution per draw rather than shared file statics: tanks populate in
+// parallel on the job pool, and operator() on one shared object is a data race
+static float urand(std::mt19937& rng)   { return std::uniform_real_distribution<float>(-1.0f, 1.0f)(rng); }
+static float urand01(std::mt19937& rng) { return std::uniform_real_distribution<float>(0.0f, 1.0f)(rng); }
+
+static const float FISH_STALK_RADIUS = 0.06f;   // at scale 1, how far a fish pushes stalks aside
+
+static void initSpeciesVec(Tank& t, Species s, const SpeciesConfig& sc) {
+    std::vector<FishInst>& v = t.fish[s];
+    std::mt19937& rng = t.rng;
+    const glm::vec3& ext = t.extents;
+    float yMin = sc.yMin, yMax = t.waterY - sc.surfaceGap;
+    v.resize(sc.count);
+    for (int i=0;i<sc.count;++i) {
+        // Keep fish well within tank bounds
+        glm::vec3 p(urand(rng)*ext.x*0.7f,
+                    yMin + urand01(rng)*(yMax-yMin),
+                    urand(rng)*ext.z*0.7f);
+        glm::vec3 dir = glm::normalize(glm::vec3(urand(rng), urand(rng)*0.2f, urand(rng)));
+        float sp = sc.speedMin + urand01(rng)*(sc.speedMax-sc.speedMin);
+        glm::vec3 col = glm::clamp(sc.baseColor + sc.varyColor * urand(rng)*0.5f, glm::vec3(0.0f), glm::vec3(1.0f));
+        glm::vec3 stretch = glm::max(sc.stretchMean + sc.stretchVar * urand(rng), glm::vec3(0.25f));
+        float scale = sc.scaleMin + urand01(rng)*(sc.scaleMax-sc.scaleMin);
+        v[i] = { p, dir*sp, urand01(rng)*6.28318f, scale, stretch, col, (float)s };
+    }
+}
+
+// How one decoration kind is scattered: its size range and its footprint on
+// the sand at scale w. Regions are fractions of the floor's half extents.
+struct DecorScatter {
+    DecorKind kind;
+    float sizeMin, sizeMax;
+    float footprint, footprintBase;   // disc radius = footprint * w + footprintBase
+    float lift;                       // above the sand
+    const char* name;
+};
+
+static std::vector<ScatterRect> scatterBox(glm::vec2 ext, float fx, float fz) {
+    return { { -glm::vec2(fx, fz) * ext, glm::vec2(fx, fz) * ext } };
+}
+// Mirrored pair of strips, |x| in [x0, x1]
+static std::vector<ScatterRect> scatterSides(glm::vec2 ext, float x0, float x1, float z0, float z1) {
+    return { { glm::vec2(-x1, z0) * ext, glm::vec2(-x0, z1) * ext }, { glm::vec2(x0, z0) * ext, glm::vec2(x1, z1) * ext } };
+}
+
+static void initPlantsAndRocks(Tank& t, const SceneConfig& c) {
+    std::mt19937& rng = t.rng;
+    const glm::vec3& ext = t.extents;
+    const glm::vec2 floor2(ext.x, ext.z);
+    const float floorY = -ext.y;
+
+    // Largest footprints first, so the small pieces fill in around them
+    const DecorScatter kinds[] = {
+        {ROCKS,     0.25f, 0.60f, 0.22f,  0.0f,  0.0f,  "rocks"},       // dome
+        {CORALS,    0.30f, 0.70f, 0.15f,  0.0f,  0.0f,  "corals"},
+        {CHESTS,    0.10f, 0.20f, 0.125f, 0.0f,  0.02f, "chests"},
+        {DRIFTWOOD, 0.15f, 0.40f, 0.30f,  0.0f,  0.05f, "driftwood"},   // the log runs out from its base
+        {ANEMONES,  0.15f, 0.35f, 0.10f,  0.0f,  0.0f,  "anemones"},
+        {KELP,      0.60f, 1.00f, 0.0f,   0.04f, 0.0f,  "kelp"},        // w is the height
+        {STARFISH,  0.06f, 0.14f, 0.12f,  0.0f,  0.01f, "starfish"},
+        {SHELLS,    0.05f, 0.13f, 0.12f,  0.0f,  0.0f,  "shells"},
+    };
+    const int counts[DECOR_KINDS] = { c.rocks, c.corals, c.shells, c.driftwood, c.anemones, c.starfish, c.kelp, c.chests };
+    std::vector<ScatterRect> regions[DECOR_KINDS];
+    // Two rock clusters around x = +-0.6
+    regions[ROCKS]     = { { glm::vec2(-1.0f, -0.6f * ext.z), glm::vec2(-0.2f, 0.6f * ext.z) },
+                           { glm::vec2( 0.2f, -0.6f * ext.z), glm::vec2( 1.0f, 0.6f * ext.z) } };
+    regions[CORALS]    = scatterBox(floor2, 0.7f, 0.7f);
+    regions[SHELLS]    = scatterBox(floor2, 0.8f, 0.8f);
+    regions[DRIFTWOOD] = scatterBox(floor2, 0.6f, 0.6f);
+    regions[ANEMONES]  = scatterBox(floor2, 0.5f, 0.5f);
+    regions[STARFISH]  = scatterBox(floor2, 0.9f, 0.9f);
+    regions[CHESTS]    = scatterBox(floor2, 0.4f, 0.4f);
+    // Kelp forest in the back and front corners
+    regions[KELP] = scatterSides(floor2, 0.7f, 0.9f, -0.8f, -0.5f);
+    for (const ScatterRect& q : scatterSides(floor2, 0.7f, 0.9f, 0.5f, 0.8f)) regions[KELP].push_back(q);
+
+    const float plantFootprint = 0.03f;
+    float maxRadius = plantFootprint;
+    for (const DecorScatter& k : kinds) maxRadius = std::max(maxRadius, k.footprint * k.sizeMax + k.footprintBase);
+    PoissonDisk sampler(-floor2, floor2, maxRadius);
+
+    std::vector<glm::vec3> placed;
+    for (const DecorScatter& k : kinds) {
+        ScatterSpec spec;
+        spec.regions = regions[k.kind]; spec.count = counts[k.kind];
+        spec.sizeMin = k.sizeMin; spec.sizeMax = k.sizeMax;
+        spec.footprint = k.footprint; spec.footprintBase = k.footprintBase;
+        placed.clear();
+        int n = sampler.scatter(spec, rng, placed);
+        if (n < spec.count) std::cerr << "Tank: room for only " << n << " of " << spec.count << " " << k.name << "\n";
+        auto& v = t.decor[k.kind];
+        v.resize(n);
+        for (int i=0;i<n;++i) v[i] = glm::vec4(placed[i].x, floorY + k.lift, placed[i].y, placed[i].z);
+    }
+
+    // Plants along the sides, between everything else
+    ScatterSpec spec;
+    spec.regions = scatterSides(floor2, 0.3f, 0.8f, -0.8f, 0.8f);
+    spec.count = c.plants; spec.footprintBase = plantFootprint;
+    placed.clear();
+    int n = sampler.scatter(spec, rng, placed);
+    if (n < spec.count) std::cerr << "Tank: room for only " << n << " of " << spec.count << " plants\n";
+    t.plantPos.resize(n);
+    t.plantHP.resize(n);
+    t.plantColor.resize(n);
+    for (int i=0;i<n;++i) {
+        float h = 0.35f + urand01(rng)*0.55f;
+        float phase = urand01(rng)*6.28318f;
+        glm::vec3 col = glm::vec3(0.18f + urand01(rng)*0.1f, 0.55f + urand01(rng)*0.35f, 0.18f);
+        t.plantPos[i]   = glm::vec3(placed[i].x, floorY, placed[i].y);
+        t.plantHP[i]    = glm::vec2(h, phase);
+        t.plantColor[i] = col;
+    }
+}
+
+float decorYaw(DecorKind k, int i) {
+    static const float step[DECOR_KINDS] = { 0.0f, 0.0f, 0.7f, 0.5f, 0.0f, 1.2f, 0.0f, 0.8f };
+    return (float)i * step[k];
+}
+
+void bakeTankObstacles(Tank& t, float cell) {
+    if (cell <= 0.0f) { t.obstacles.clear(); return; }
+    // Rough solids around each mesh at its placement scale (see meshes.h for
+    // the unit sizes). Shells and starfish lie flat on the sand, below any swim band.
+    std::vector<ObstacleShape> shapes;
+    for (const glm::vec4& d : t.decor[ROCKS]) {   // dome centred on the sand
+        ObstacleShape s; s.kind = ObstacleShape::SPHERE; s.a = glm::vec3(d); s.radius = 0.22f * d.w;
+        shapes.push_back(s);
+    }
+    for (const glm::vec4& d : t.decor[CORALS]) {   // upright column
+        ObstacleShape s; s.kind = ObstacleShape::CAPSULE; s.a = glm::vec3(d); s.b = s.a + glm::vec3(0.0f, 0.6f * d.w, 0.0f);
+        s.radius = 0.17f * d.w;
+        shapes.push_back(s);
+    }
+    for (const glm::vec4& d : t.decor[ANEMONES]) {   // stalk and tentacle crown
+        ObstacleShape s; s.kind = ObstacleShape::CAPSULE; s.a = glm::vec3(d); s.b = s.a + glm::vec3(0.0f, 0.2f * d.w, 0.0f);
+        s.radius = 0.08f * d.w;
+        shapes.push_back(s);
+    }
+    const auto& wood = t.decor[DRIFTWOOD];
+    for (size_t i=0;i<wood.size();++i) {   // log along its rotated +x
+        float yaw = decorYaw(DRIFTWOOD, (int)i), w = wood[i].w;
+        ObstacleShape s; s.kind = ObstacleShape::CAPSULE; s.a = glm::vec3(wood[i]);
+        s.b = s.a + glm::vec3(std::cos(yaw), 0.0f, -std::sin(yaw)) * (0.3f * w);
+        s.radius = 0.04f * w;
+        shapes.push_back(s);
+    }
+    const auto& chests = t.decor[CHESTS];
+    for (size_t i=0;i<chests.size();++i) {   // body plus the open lid
+        float w = chests[i].w;
+        ObstacleShape s; s.kind = ObstacleShape::BOX; s.a = glm::vec3(chests[i]) + glm::vec3(0.0f, 0.0075f * w, 0.0f);
+        s.b = glm::vec3(0.1f, 0.0825f, 0.075f) * w; s.radius = 0.01f * w; s.yaw = decorYaw(CHESTS, (int)i);
+        shapes.push_back(s);
+    }
+
+    // Box tank: the glass sides and the sand. The surface is left to the swim bands.
+    const glm::vec3 ext = t.extents;
+    auto walls = [ext](glm::vec3 p) {
+        return std::min(std::min(ext.x - std::abs(p.x), ext.z - std::abs(p.z)), p.y + ext.y);
+    };
+    t.obstacles.bake(-ext, glm::vec3(ext.x, t.waterY, ext.z), cell, walls, shapes);
+}
+
+void populateTank(Tank& t, const SceneConfig& c) {
+    for (int i=0;i<SPECIES_COUNT;++i) initSpeciesVec(t, (Species)i, c.species[i]);
+    // Shares rng with the species, so it stays after them to keep scenes reproducible
+    initPlantsAndRocks(t, c);
+    initTankStalks(t);
+    t.stalkBudget = c.stalkBudget > 0 ? c.stalkBudget : -1;   // all of it, until split with other tanks
+    bakeTankObstacles(t, c.obstacleCell);
+}
+
+void initTankStalks(Tank& t) {
+    std::vector<StalkSpec> specs;
+    specs.reserve(t.plantPos.size() + t.decor[KELP].size());
+    for (size_t i=0;i<t.plantPos.size();++i) {   // short and springy
+        StalkSpec s; s.base = t.plantPos[i]; s.height = t.plantHP[i].x; s.phase = t.plantHP[i].y;
+        s.stiffness = 5.0f; s.buoyancy = 0.5f;
+        specs.push_back(s);
+    }
+    const auto& kelp = t.decor[KELP];
+    for (size_t i=0;i<kelp.size();++i) {   // tall and limp, held up by their floats
+        StalkSpec s; s.base = glm::vec3(kelp[i]); s.height = kelp[i].w; s.phase = (float)i * 2.39996f;
+        s.stiffness = 1.0f; s.buoyancy = 2.0f;
+        specs.push_back(s);
+    }
+    t.stalks.init(specs);
+}
+
+void initTankBubbles(Tank& t, const SceneConfig& c, uint32_t seed) {
+    const glm::vec3& ext = t.extents;
+    t.bubbles.init(c.bubbleCapacity, -ext.y, t.waterY, seed);
+    t.bubbles.clearEmitters();
+    const glm::vec3 stones[] = { {-0.55f*ext.x, -ext.y, -0.45f*ext.z},
+                                 { 0.50f*ext.x, -ext.y, -0.40f*ext.z} };
+    for (const auto& p : stones) {
+        BubbleEmitter e; e.pos = p; e.rate = c.airStoneRate;
+        t.bubbles.addEmitter(e);
+    }
+    for (const auto& d : t.decor[CHESTS]) {
+        BubbleEmitter e; e.pos = glm::vec3(d.x, d.y + d.w * 0.1f, d.z);
+        e.rate = c.ventRate; e.radius = 0.01f; e.sizeMin = 2.0f; e.sizeMax = 3.5f;
+        t.bubbles.addEmitter(e);
+    }
+}
+
+void initTankFood(Tank& t, const SceneConfig& c, uint32_t seed) {
+    t.food.init(c.foodCapacity, -t.extents.y, t.waterY, seed);
+    t.food.lifetime = c.foodLifetime;
+}
+
+int feedTank(Tank& t, const SceneConfig& c) {
+    return t.food.drop(c.feedPellets, c.feedSpread, glm::vec2(t.extents.x, t.extents.z) * 0.7f);
+}
+
+void splitSimBudget(std::vector<Tank>& ts, int budget) {
+    int64_t total = 0;
+    for (const Tank& t : ts) for (const auto& v : t.fish) total += (int64_t)v.size();
+    // School k gets floor(budget * fish up to and including k / total) minus
+    // the same for the schools before it: never more than its fair share
+    // rounded up, and the remainders add up instead of each rounding up
+    int64_t before = 0;
+    for (Tank& t : ts)
+        for (int i=0;i<SPECIES_COUNT;++i) {
+            int64_t after = before + (int64_t)t.fish[i].size();
+            t.lod[i].budget = budget < 0 || total == 0 ? -1
+                            : (int)(budget * after / total - budget * before / total);
+            before = after;
+        }
+}
+
+void splitStalkBudget(std::vector<Tank>& ts, int budget) {
+    int64_t total = 0, withStalks = 0;
+    for (const Tank& t : ts) { total += t.stalks.count(); withStalks += t.stalks.count() > 0; }
+    // One each, then the rest in proportion, rounded as in splitSimBudget
+    const int64_t rest = std::max<int64_t>((int64_t)budget - withStalks, 0);
+    int64_t before = 0;
+    for (Tank& t : ts) {
+        int64_t after = before + t.stalks.count();
+        if (budget <= 0) t.stalkBudget = -1;
+        else if (!t.stalks.count()) t.stalkBudget = 0;
+        else t.stalkBudget = (int)(1 + rest * after / total - rest * before / total);
+        before = after;
+    }
+}
+
+void stepTank(Tank& t, const SceneConfig& c, float dt, bool cpuBubbles, const SimLodSettings* lod) {
+    t.food.update(dt);
+    for (int i=0;i<SPECIES_COUNT;++i) {
+        const SpeciesConfig& sc = c.species[i];
+        SchoolParams p;
+        p.yMin = sc.yMin; p.yMax = t.waterY - sc.surfaceGap; p.maxSpeed = sc.speedMax;
+        p.cohesion = sc.cohesion; p.alignment = sc.alignment; p.extents = t.extents;
+        p.neighbors = sc.neighbors;
+        p.cache = &t.neighborCache[i];
+        p.obstacles = t.obstacles.empty() ? nullptr : &t.obstacles;
+        p.food = t.food.count() ? &t.food : nullptr;
+        if (!lod) { updateSchool(t.fish[i], p, dt, t.rng); continue; }
+        SchoolLod& l = t.lod[i];
+        l.camera = lod->camera - t.origin;
+        l.tierStart = lod->tierStart;
+        updateSchool(t.fish[i], p, dt, t.rng, l);
+    }
+    if (t.stalks.count()) {
+        // Every fish is a sphere the stalks get pushed out of
+        thread_local std::vector<glm::vec4> colliders;
+        colliders.clear();
+        for (const auto& v : t.fish)
+            for (const FishInst& f : v) colliders.emplace_back(f.pos, FISH_STALK_RADIUS * f.scale);
+        t.stalks.step(dt, colliders, t.stalkBudget);
+    }
+    if (cpuBubbles) t.bubbles.update(dt);
+}
+
+uint32_t tankSeed(int i)       { return 2025u + 7919u * (uint32_t)i; }
+uint32_t tankBubbleSeed(int i) { return 7u + 104729u * (uint32_t)i; }
+uint32_t tankFoodSeed(int i)   { return 31u + 15485863u * (uint32_t)i; }
+
+glm::vec3 tankGridOrigin(int i, int n, glm::vec2 spacing) {
+    int cols = std::max(1, (int)std::ceil(std::sqrt((float)n)));
+    return glm::vec3((float)(i % cols) * spacing.x, 0.0f, -(float)(i / cols) * spacing.y);
+}
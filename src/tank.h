@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "food.h"
+#include "obstacle_field.h"
+#include "particles.h"
+#include "scene_config.h"
+#include "school.h"
+#include "stalks.h"
+
+// ===========================================================
+// Tanks: independent aquariums simulated as shards
+// ===========================================================
+//
+// A Tank owns everything one aquarium simulates or places: its schools,
+// plants, decorations, bubbles, bounds and random stream. Tanks share no
+// mutable state, so each one can step on its own worker. Everything inside is
+// in tank-local coordinates; `origin` is only applied when instances are
+// packed for rendering.
+
+// Interior half extents of the tank box (5.0 x 2.8 x 3.0 outside)
+const float TANK_WIDTH = 2.4f;
+const float TANK_HEIGHT = 1.3f;
+const float TANK_DEPTH = 1.4f;
+static const glm::vec3 TANK_EXTENTS = {TANK_WIDTH, TANK_HEIGHT, TANK_DEPTH};
+
+enum DecorKind : int { ROCKS=0, CORALS, SHELLS, DRIFTWOOD, ANEMONES, STARFISH, KELP, CHESTS, DECOR_KINDS };
+
+struct Tank {
+    glm::vec3 origin{0.0f};             // world position of the tank centre
+    glm::vec3 extents = TANK_EXTENTS;
+    float waterY = 0.6f;                // local water level
+
+    std::vector<FishInst> fish[SPECIES_COUNT];   // indexed by Species
+    std::vector<glm::vec3> plantPos, plantColor;
+    std::vector<glm::vec2> plantHP;              // height, sway phase
+    std::vector<glm::vec4> decor[DECOR_KINDS];   // x,y,z = base position, w = scale
+    BubbleSystem bubbles;
+    std::mt19937 rng{2025};
+    SchoolLod lod[SPECIES_COUNT];                // per-school LOD state, used with SimLodSettings
+    SchoolNeighborCache neighborCache[SPECIES_COUNT];   // Verlet lists of the metric-model schools
+    ObstacleField obstacles;                     // walls and solid decorations, see bakeTankObstacles
+    FoodSystem food;
+    StalkSystem stalks;                          // plants, then kelp (see initTankStalks)
+    int stalkBudget = -1;                        // stalks updated per step, < 0 = all (see splitStalkBudget)
+};
+
+// Simulation LOD for one step of every tank (see SchoolLod)
+struct SimLodSettings {
+    glm::vec3 camera{0.0f};        // world space
+    float tierStart = 1.5f;
+};
+
+// Splits `budget` steering updates (< 0 = no cap) over every school of `ts` in
+// proportion to its fish, into each SchoolLod::budget. Shares are rounded so
+// that they add up to exactly `budget`. Call before stepping them with a lod.
+void splitSimBudget(std::vector<Tank>& ts, int budget);
+// Splits the scene's stalk_budget (<= 0 = no cap) over the tanks in proportion
+// to their stalks, into each Tank::stalkBudget, so the stalk cost of a step
+// stays the same however many tanks there are. A tank with stalks gets at
+// least one, so a budget below the number of such tanks is raised to it.
+void splitStalkBudget(std::vector<Tank>& ts, int budget);
+
+// Fish, plants and decorations from the scene, all drawn from t.rng in a
+// fixed order so a seed always gives the same tank.
+void populateTank(Tank& t, const SceneConfig& c);
+// Signed distance field of the walls and the solid decorations (plants and
+// kelp are left out: fish swim through them), which schools steer around.
+// populateTank bakes it; call again whenever the decorations change. A cell of
+// 0 clears it and fish only keep to the box.
+void bakeTankObstacles(Tank& t, float cell);
+// Rotation about +y of decoration i of a kind, as rendered
+float decorYaw(DecorKind k, int i);
+// Verlet chains for the plants, then the kelp, standing upright.
+// populateTank calls it; call again whenever the plants or kelp change.
+void initTankStalks(Tank& t);
+// Bubble pool plus two air stones on the floor and a vent on each chest
+void initTankBubbles(Tank& t, const SceneConfig& c, uint32_t seed);
+// Empty pellet pool sized by the scene's [feeding] section
+void initTankFood(Tank& t, const SceneConfig& c, uint32_t seed);
+// Feeding event: the scene's pellets per feeding, dropped at a random spot
+int feedTank(Tank& t, const SceneConfig& c);
+// Food, then schools in species order, then the stalks (pushed aside by the
+// fish), then the bubbles unless they run on the GPU.
+// With `lod`, distant fish steer at reduced rates and each school keeps to
+// the budget splitSimBudget gave it.
+void stepTank(Tank& t, const SceneConfig& c, float dt, bool cpuBubbles, const SimLodSettings* lod = nullptr);
+
+// Seeds for tank i; tank 0 keeps the single-tank seeds
+uint32_t tankSeed(int i);
+uint32_t tankBubbleSeed(int i);
+uint32_t tankFoodSeed(int i);
+// Origin of tank i of n, laid out in a near-square grid that starts at the
+// world origin and extends along +x and -z
+glm::vec3 tankGridOrigin(int i, int n, glm::vec2 spacing);
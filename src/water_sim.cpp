@@ -0,0 +1,155 @@
+#include "water_sim.h"
+#include "jobs.h"
+#include "snapshot.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+// Explicit scheme is stable for Courant numbers below 1/sqrt(2); keep a margin.
+static const float kMaxCourant = 0.65f;
+static const int kMaxStepsPerFrame = 4;
+static const size_t kCellGrain = 16384;
+
+void WaterSim::init(int r, float x0, float z0, float sx, float sz) {
+    res = std::max(r, 4); stride = res + 2;
+    minX = x0; minZ = z0; sizeX = sx; sizeZ = sz;
+    h.assign((size_t)stride * stride, 0.0f);
+    prev.assign((size_t)stride * stride, 0.0f);
+    tex.assign((size_t)res * res * 4, 0.0f);
+    pending.clear(); pending.reserve(maxSplashes);
+    accum = 0.0f;
+
+    float dx = sizeX / res, dz = sizeZ / res;
+    float courant = waveSpeed / stepHz * std::sqrt(1.0f / (dx * dx) + 1.0f / (dz * dz));
+    subs = std::max(1, (int)std::ceil(courant / kMaxCourant));
+}
+
+void WaterSim::splash(float x, float z, float radius, float strength) {
+    if ((int)pending.size() < maxSplashes) pending.push_back(glm::vec4(x, z, radius, strength));
+}
+
+void WaterSim::applySplashes() {
+    const float cellX = sizeX / res, cellZ = sizeZ / res;
+    for (const auto& s : pending) {
+        float rad = std::max(s.z, 1.5f * std::max(cellX, cellZ));
+        float fx = (s.x - minX) / cellX, fz = (s.y - minZ) / cellZ;
+        int x0 = std::max(0, (int)std::floor(fx - rad / cellX)), x1 = std::min(res - 1, (int)std::ceil(fx + rad / cellX));
+        int z0 = std::max(0, (int)std::floor(fz - rad / cellZ)), z1 = std::min(res - 1, (int)std::ceil(fz + rad / cellZ));
+        for (int z = z0; z <= z1; ++z) {
+            float dz = ((float)z + 0.5f - fz) * cellZ;
+            float* row = h.data() + (size_t)(z + 1) * stride + 1;
+            for (int x = x0; x <= x1; ++x) {
+                float dx = ((float)x + 0.5f - fx) * cellX;
+                float d = std::sqrt(dx * dx + dz * dz) / rad;
+                if (d < 1.0f) row[x] -= s.w * (0.5f + 0.5f * std::cos(3.14159265f * d));
+            }
+        }
+    }
+    pending.clear();
+}
+
+void WaterSim::mirrorBorder(float* f) {
+    for (int z = 1; z <= res; ++z) {
+        float* row = f + (size_t)z * stride;
+        row[0] = row[1]; row[res + 1] = row[res];
+    }
+    std::copy(f + stride, f + 2 * stride, f);
+    std::copy(f + (size_t)res * stride, f + (size_t)(res + 1) * stride, f + (size_t)(res + 1) * stride);
+}
+
+void WaterSim::step() {
+    applySplashes();
+    const float dts = 1.0f / (stepHz * subs);
+    const float dx = sizeX / res, dz = sizeZ / res;
+    const float kx = (waveSpeed * dts / dx) * (waveSpeed * dts / dx);
+    const float kz = (waveSpeed * dts / dz) * (waveSpeed * dts / dz);
+    const float damp = std::exp(-damping * dts);
+    const size_t rowGrain = std::max<size_t>(1, kCellGrain / (size_t)res);
+
+    for (int s = 0; s < subs; ++s) {
+        mirrorBorder(h.data());
+        // prev <- next; every cell of prev is only read by its own update
+        jobs::parallelFor((size_t)res, rowGrain, [&](size_t r0, size_t r1) {
+            for (size_t z = r0 + 1; z <= r1; ++z) {
+                const float* __restrict c  = h.data() + z * stride;
+                const float* __restrict up = c - stride;
+                const float* __restrict dn = c + stride;
+                float* __restrict p = prev.data() + z * stride;
+                for (int x = 1; x <= res; ++x) {
+                    float hc = c[x];
+                    float lap = kx * (c[x - 1] + c[x + 1] - 2.0f * hc) + kz * (up[x] + dn[x] - 2.0f * hc);
+                    p[x] = (2.0f * hc - p[x] + lap) * damp;
+                }
+            }
+        });
+        h.swap(prev);
+    }
+    mirrorBorder(h.data());
+}
+
+void WaterSim::buildTexels() {
+    const float dts = 1.0f / (stepHz * subs);
+    const float ix = 0.5f * res / sizeX, iz = 0.5f * res / sizeZ, it = 1.0f / dts;
+    jobs::parallelFor((size_t)res, std::max<size_t>(1, kCellGrain / (size_t)res), [&](size_t r0, size_t r1) {
+        for (size_t z = r0; z < r1; ++z) {
+            const float* __restrict c = h.data() + (z + 1) * stride;
+            const float* __restrict p = prev.data() + (z + 1) * stride;
+            float* __restrict o = tex.data() + z * res * 4;
+            for (int x = 1; x <= res; ++x, o += 4) {
+                o[0] = c[x];
+                o[1] = (c[x + 1] - c[x - 1]) * ix;
+                o[2] = (c[x + stride] - c[x - stride]) * iz;
+                o[3] = (c[x] - p[x]) * it;
+            }
+        }
+    });
+}
+
+bool WaterSim::update(float dt) {
+    auto t0 = std::chrono::steady_clock::now();
+    accum += dt;
+    int n = 0;
+    while (accum >= 1.0f / stepHz && n < kMaxStepsPerFrame) { step(); accum -= 1.0f / stepHz; ++n; }
+    if (accum >= 1.0f / stepHz) accum = 0.0f;   // fell behind; drop time rather than spiral
+    if (n) buildTexels();
+    updateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    return n > 0;
+}
+
+size_t WaterSim::memoryBytes() const {
+    return (h.capacity() + prev.capacity() + tex.capacity()) * sizeof(float) + pending.capacity() * sizeof(glm::vec4);
+}
+
+void WaterSim::save(SnapshotWriter& w) const {
+    int32_t r = res;
+    w.addValue("water.res", r);
+    w.addValue("water.accum", accum);
+    w.addVector("water.h", h);
+    w.addVector("water.prev", prev);
+}
+
+bool WaterSim::load(const SnapshotReader& r) {
+    int32_t rr;
+    float acc;
+    std::vector<float> nh, np;
+    if (!r.readValue("water.res", rr) || rr != res || !r.readValue("water.accum", acc)
+        || !r.readVector("water.h", nh) || !r.readVector("water.prev", np)
+        || nh.size() != h.size() || np.size() != prev.size()) return false;
+    h.swap(nh); prev.swap(np);
+    accum = acc;
+    pending.clear();
+    buildTexels();
+    return true;
+}
+
+double WaterSim::benchmark(int r, int steps) {
+    WaterSim w;
+    w.init(r, -2.25f, -1.35f, 4.5f, 2.7f);
+    // Keep the surface busy so the timing is not of a flat grid
+    for (int i = 0; i < 64; ++i) w.splash(-2.0f + 0.06f * i, -1.2f + 0.035f * i, 0.05f, 0.01f);
+    w.step();
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < steps; ++i) w.step();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() / std::max(steps, 1);
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class SnapshotWriter;
+class SnapshotReader;
+
+// ===========================================================
+// Heightfield water (damped 2D wave equation on a grid)
+// ===========================================================
+//
+// The grid covers an axis-aligned rectangle of the water surface. Heights are
+// stored with a one-cell border that mirrors the edge (reflective walls), so
+// the row kernel has no branches and vectorizes.
+
+class WaterSim {
+public:
+    // res x res cells over [minX, minX+sizeX] x [minZ, minZ+sizeZ]
+    void init(int res, float minX, float minZ, float sizeX, float sizeZ);
+
+    // Pushes the surface down by `strength` (world units) with a smooth
+    // falloff over `radius`; applied at the start of the next step.
+    void splash(float x, float z, float radius, float strength);
+
+    // Advances in fixed steps; returns true if the texels changed.
+    bool update(float dt);
+    void step();
+
+    void save(SnapshotWriter& w) const;
+    bool load(const SnapshotReader& r);
+
+    // res*res RGBA texels: height, dh/dx, dh/dz, dh/dt
+    const float* texels() const { return tex.data(); }
+    int resolution() const { return res; }
+    glm::vec4 rect() const { return glm::vec4(minX, minZ, 1.0f / sizeX, 1.0f / sizeZ); }
+    double lastUpdateMs() const { return updateMs; }
+    int substeps() const { return subs; }
+    size_t memoryBytes() const;
+
+    float waveSpeed = 0.55f;     // m/s
+    float damping   = 1.2f;      // amplitude decay per second
+    float stepHz    = 60.0f;
+    int maxSplashes = 2048;      // per step; extra disturbances are dropped
+
+    // Average ms per step() for a res x res grid, for sizing the simulation
+    static double benchmark(int res, int steps);
+
+private:
+    void applySplashes();
+    void mirrorBorder(float* f);
+    void buildTexels();
+
+    int res = 0, stride = 0, subs = 1;
+    float minX = 0.0f, minZ = 0.0f, sizeX = 1.0f, sizeZ = 1.0f;
+    float accum = 0.0f;
+    double updateMs = 0.0;
+    std::vector<float> h, prev;  // (res+2)^2, padded
+    std::vector<float> tex;
+    std::vector<glm::vec4> pending;  // x, z, radius, strength
+};
@@ -0,0 +1,71 @@
+// Reads the fish the app publishes with --shm-export, straight out of shared
+// memory, and prints one line per second:
+//   ./shm_reader [/name] [--frames n]
+// Frames are visited in place (no copy); a torn frame is simply read again.
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "fish_shm.h"
+
+int main(int argc, char** argv) {
+    std::string name = "/aquarium";
+    long maxFrames = 0;   // 0 = until the app exits
+    for (int i=1;i<argc;++i) {
+        std::string a = argv[i];
+        if (a == "--frames" && i+1 < argc) maxFrames = std::atol(argv[++i]);
+        else if (!a.empty() && a[0] == '/') name = a;
+        else { std::cerr << "Usage: shm_reader [/name] [--frames n]\n"; return -1; }
+    }
+
+    FishShmReader reader;
+    std::cout << "Waiting for " << name << "..." << std::endl;
+    while (!reader.open(name)) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    using clock = std::chrono::steady_clock;
+    auto lastReport = clock::now();
+    uint64_t lastFrame = 0, reportFrames = 0, torn = 0;
+    long total = 0;
+    while (maxFrames == 0 || total < maxFrames) {
+        float sum[3] = {0.0f, 0.0f, 0.0f}, speed = 0.0f;
+        FishShmFrame info;
+        FishShmReader::Status st = reader.read([&](const FishShmRecord* r, const FishShmFrame& f) {
+            info = f;
+            if (f.frame == lastFrame) return;
+            for (uint32_t i=0;i<f.count;++i) {
+                for (int k=0;k<3;++k) sum[k] += r[i].pos[k];
+                speed += std::sqrt(r[i].vel[0]*r[i].vel[0] + r[i].vel[1]*r[i].vel[1] + r[i].vel[2]*r[i].vel[2]);
+            }
+        });
+        if (st == FishShmReader::Closed) {
+            // The app exited or grew the segment: wait for it to come back
+            reader.close();
+            std::cout << "Segment closed, reopening..." << std::endl;
+            while (!reader.open(name)) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            continue;
+        }
+        if (st == FishShmReader::Torn) { ++torn; continue; }
+        if (st == FishShmReader::NoData || info.frame == lastFrame) {
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+            continue;
+        }
+        lastFrame = info.frame;
+        ++reportFrames; ++total;
+
+        double since = std::chrono::duration<double>(clock::now() - lastReport).count();
+        if (since >= 1.0 || total == maxFrames) {
+            float inv = info.count ? 1.0f / (float)info.count : 0.0f;
+            std::cout << "frame " << info.frame << "  t=" << info.simTime << "s  " << info.count << " fish in "
+                      << info.tanks << " tanks  mean pos (" << sum[0]*inv << ", " << sum[1]*inv << ", " << sum[2]*inv
+                      << ")  mean speed " << speed*inv << "  " << reportFrames / since << " frames/s, "
+                      << torn << " torn reads" << std::endl;
+            lastReport = clock::now();
+            reportFrames = 0;
+        }
+    }
+    std::cout << "Read " << total << " frames" << std::endl;
+    return 0;
+}